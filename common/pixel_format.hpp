@@ -0,0 +1,362 @@
+#pragma once
+
+// Pixel format conversion shared by the plugins.
+//
+// Cairo draws BGRA (ARGB32 in memory on little endian), gdk-pixbuf hands
+// out RGB or RGBA rows, and textures are uploaded as RGBA
+// (DRM_FORMAT_ABGR8888). The conversions here work on whole rows with the
+// widest instruction set the CPU supports, picked once at load time, and
+// write wherever the caller points them: back into the source buffer, or
+// straight into the buffer that gets uploaded.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXEL_FORMAT_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXEL_FORMAT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace PixelFormat {
+
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+// Row kernels over `count` pixels of 4 bytes each (3 for RGB sources)
+struct Kernels {
+    // BGRA <-> RGBA. `src` and `dst` may be the same buffer.
+    void (*swapRedBlue)(const uint8_t* src, uint8_t* dst, size_t count);
+    // RGB -> RGBA with opaque alpha. `src` and `dst` must not overlap.
+    void (*expandRgb)(const uint8_t* src, uint8_t* dst, size_t count);
+    // Multiply the color channels by alpha, in place. Alpha is last.
+    void (*premultiply)(uint8_t* pixels, size_t count);
+};
+
+// round(x * a / 255) without a division, exact for all 8-bit inputs
+inline uint8_t mulDiv255(uint32_t x, uint32_t a) {
+    const uint32_t t = x * a + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+inline void swapRedBlueScalar(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t pixel;
+        std::memcpy(&pixel, src + i * 4, 4);
+        pixel = (pixel & 0xFF00FF00u) | ((pixel >> 16) & 0xFFu) | ((pixel & 0xFFu) << 16);
+        std::memcpy(dst + i * 4, &pixel, 4);
+    }
+}
+
+inline void expandRgbScalar(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i * 4 + 0] = src[i * 3 + 0];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = 255;
+    }
+}
+
+inline void premultiplyScalar(uint8_t* pixels, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* p = pixels + i * 4;
+        const uint32_t alpha = p[3];
+        if (alpha == 255)
+            continue;
+        p[0] = mulDiv255(p[0], alpha);
+        p[1] = mulDiv255(p[1], alpha);
+        p[2] = mulDiv255(p[2], alpha);
+    }
+}
+
+#ifdef PIXEL_FORMAT_X86
+
+// Byte 0 and byte 2 of every 32-bit pixel trade places; plain SSE2 has no
+// byte shuffle, so it's done with masks and shifts
+__attribute__((target("sse2")))
+inline void swapRedBlueSSE2(const uint8_t* src, uint8_t* dst, size_t count) {
+    const __m128i greenAlpha = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m128i redBlue = _mm_set1_epi32(0x00FF00FF);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        const __m128i rb = _mm_and_si128(v, redBlue);
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                         _mm_or_si128(_mm_and_si128(v, greenAlpha), swapped));
+    }
+    swapRedBlueScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+// Two pixels widened to 16 bits per channel, each channel times its
+// pixel's alpha. Alpha itself is multiplied by 255, which keeps it.
+__attribute__((target("sse2")))
+inline __m128i premultiplyWideSSE2(__m128i wide) {
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(wide, 0xFF), 0xFF);
+    alpha = _mm_or_si128(alpha, _mm_set1_epi64x(0x00FF000000000000LL));
+    const __m128i t = _mm_add_epi16(_mm_mullo_epi16(wide, alpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("sse2")))
+inline void premultiplySSE2(uint8_t* pixels, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* p = reinterpret_cast<__m128i*>(pixels + i * 4);
+        const __m128i v = _mm_loadu_si128(p);
+        const __m128i lo = premultiplyWideSSE2(_mm_unpacklo_epi8(v, zero));
+        const __m128i hi = premultiplyWideSSE2(_mm_unpackhi_epi8(v, zero));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    premultiplyScalar(pixels + i * 4, count - i);
+}
+
+__attribute__((target("avx2")))
+inline void swapRedBlueAVX2(const uint8_t* src, uint8_t* dst, size_t count) {
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(v, shuffle));
+    }
+    swapRedBlueScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+// 8 pixels per step: the 24 source bytes are spread over both lanes, 12
+// each, then every RGB triple is widened in place
+__attribute__((target("avx2")))
+inline void expandRgbAVX2(const uint8_t* src, uint8_t* dst, size_t count) {
+    const __m256i spread = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+    const __m256i widen = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                           0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+    size_t i = 0;
+    // The load reads 32 bytes, 8 past the 8 pixels used
+    for (; i + 11 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 3));
+        const __m256i rgb = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(v, spread), widen);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_or_si256(rgb, alpha));
+    }
+    expandRgbScalar(src + i * 3, dst + i * 4, count - i);
+}
+
+__attribute__((target("avx2")))
+inline __m256i premultiplyWideAVX2(__m256i wide) {
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(wide, 0xFF), 0xFF);
+    alpha = _mm256_or_si256(alpha, _mm256_set1_epi64x(0x00FF000000000000LL));
+    const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(wide, alpha), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+inline void premultiplyAVX2(uint8_t* pixels, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto* p = reinterpret_cast<__m256i*>(pixels + i * 4);
+        const __m256i v = _mm256_loadu_si256(p);
+        // Unpacking and packing both work per lane, so the order survives
+        const __m256i lo = premultiplyWideAVX2(_mm256_unpacklo_epi8(v, zero));
+        const __m256i hi = premultiplyWideAVX2(_mm256_unpackhi_epi8(v, zero));
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+    premultiplyScalar(pixels + i * 4, count - i);
+}
+
+#endif // PIXEL_FORMAT_X86
+
+#ifdef PIXEL_FORMAT_NEON
+
+inline void swapRedBlueNEON(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i * 4);
+        const uint8x16_t red = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = red;
+        vst4q_u8(dst + i * 4, v);
+    }
+    swapRedBlueScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+inline void expandRgbNEON(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+        const uint8x16x4_t rgba = {{rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(255)}};
+        vst4q_u8(dst + i * 4, rgba);
+    }
+    expandRgbScalar(src + i * 3, dst + i * 4, count - i);
+}
+
+// (p + ((p + 128) >> 8) + 128) >> 8, the same rounding as mulDiv255
+inline uint8x8_t mulDiv255NEON(uint8x8_t x, uint8x8_t a) {
+    const uint16x8_t p = vmull_u8(x, a);
+    return vraddhn_u16(p, vrshrq_n_u16(p, 8));
+}
+
+inline void premultiplyNEON(uint8_t* pixels, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t v = vld4_u8(pixels + i * 4);
+        v.val[0] = mulDiv255NEON(v.val[0], v.val[3]);
+        v.val[1] = mulDiv255NEON(v.val[1], v.val[3]);
+        v.val[2] = mulDiv255NEON(v.val[2], v.val[3]);
+        vst4_u8(pixels + i * 4, v);
+    }
+    premultiplyScalar(pixels + i * 4, count - i);
+}
+
+#endif // PIXEL_FORMAT_NEON
+
+inline bool isSupported(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#ifdef PIXEL_FORMAT_X86
+        case Isa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef PIXEL_FORMAT_NEON
+        case Isa::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+// SSE2 has no cheap byte shuffle for the RGB expansion, so it keeps the
+// scalar loop for that one
+inline Kernels kernelsFor(Isa isa) {
+#ifdef PIXEL_FORMAT_X86
+    if (isa == Isa::AVX2)
+        return {swapRedBlueAVX2, expandRgbAVX2, premultiplyAVX2};
+    if (isa == Isa::SSE2)
+        return {swapRedBlueSSE2, expandRgbScalar, premultiplySSE2};
+#endif
+#ifdef PIXEL_FORMAT_NEON
+    if (isa == Isa::NEON)
+        return {swapRedBlueNEON, expandRgbNEON, premultiplyNEON};
+#endif
+    return {swapRedBlueScalar, expandRgbScalar, premultiplyScalar};
+}
+
+inline Isa detectIsa() {
+    if (isSupported(Isa::AVX2))
+        return Isa::AVX2;
+    if (isSupported(Isa::SSE2))
+        return Isa::SSE2;
+    if (isSupported(Isa::NEON))
+        return Isa::NEON;
+    return Isa::Scalar;
+}
+
+// Kernels selected at load time; tests and benchmarks may switch them
+inline Isa g_activeIsa = detectIsa();
+inline Kernels g_kernels = kernelsFor(g_activeIsa);
+
+// Switch to a specific instruction set, returns false if unsupported
+inline bool useIsa(Isa isa) {
+    if (!isSupported(isa))
+        return false;
+    g_activeIsa = isa;
+    g_kernels = kernelsFor(isa);
+    return true;
+}
+
+inline Isa activeIsa() {
+    return g_activeIsa;
+}
+
+inline const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+        case Isa::NEON: return "neon";
+        default: return "scalar";
+    }
+}
+
+// Whole images. Strides are in bytes; rows that are contiguous in both
+// buffers are converted in one run.
+
+// BGRA <-> RGBA, e.g. a Cairo ARGB32 surface for a DRM_FORMAT_ABGR8888
+// texture. `src` may be `dst` with the same stride.
+inline void swapRedBlue(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride,
+                        int width, int height) {
+    if (width <= 0 || height <= 0)
+        return;
+
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    if (srcStride == rowBytes && dstStride == rowBytes) {
+        g_kernels.swapRedBlue(src, dst, static_cast<size_t>(width) * height);
+        return;
+    }
+    for (int y = 0; y < height; y++)
+        g_kernels.swapRedBlue(src + y * srcStride, dst + y * dstStride, width);
+}
+
+inline void swapRedBlueInPlace(uint8_t* pixels, size_t stride, int width, int height) {
+    swapRedBlue(pixels, stride, pixels, stride, width, height);
+}
+
+// RGB or RGBA rows (3 or 4 channels, like gdk-pixbuf) to RGBA. Returns
+// false for other channel counts. `src` and `dst` must not overlap.
+inline bool toRGBA(const uint8_t* src, size_t srcStride, int channels, uint8_t* dst,
+                   size_t dstStride, int width, int height) {
+    if (channels != 3 && channels != 4)
+        return false;
+    if (width <= 0 || height <= 0)
+        return true;
+
+    const size_t srcRow = static_cast<size_t>(width) * channels;
+    const size_t dstRow = static_cast<size_t>(width) * 4;
+    if (channels == 4) {
+        if (srcStride == dstRow && dstStride == dstRow) {
+            std::memcpy(dst, src, dstRow * height);
+            return true;
+        }
+        for (int y = 0; y < height; y++)
+            std::memcpy(dst + y * dstStride, src + y * srcStride, dstRow);
+        return true;
+    }
+
+    if (srcStride == srcRow && dstStride == dstRow) {
+        g_kernels.expandRgb(src, dst, static_cast<size_t>(width) * height);
+        return true;
+    }
+    for (int y = 0; y < height; y++)
+        g_kernels.expandRgb(src + y * srcStride, dst + y * dstStride, width);
+    return true;
+}
+
+// Premultiply straight RGBA (or BGRA) alpha in place
+inline void premultiply(uint8_t* pixels, size_t stride, int width, int height) {
+    if (width <= 0 || height <= 0)
+        return;
+
+    if (stride == static_cast<size_t>(width) * 4) {
+        g_kernels.premultiply(pixels, static_cast<size_t>(width) * height);
+        return;
+    }
+    for (int y = 0; y < height; y++)
+        g_kernels.premultiply(pixels + y * stride, width);
+}
+
+} // namespace PixelFormat
@@ -17,6 +17,7 @@
 #include <cairo/cairo.h>
 #include <pango/pangocairo.h>
 #include <hyprland/src/plugins/PluginAPI.hpp>
+#include "../common/pixel_format.hpp"
 
 using Render::GL::g_pHyprOpenGL;
 
@@ -39,23 +40,6 @@ bool g_pluginShuttingDown = false;
 // Forward declarations
 class CCopyIndicatorPassElement;
 
-// Helper: Convert BGRA to RGBA pixel data
-std::vector<uint8_t> convertBGRAtoRGBA(unsigned char* data, int stride,
-                                       int width, int height) {
-    std::vector<uint8_t> pixelData(width * height * 4);
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            const auto SRC = data + y * stride + x * 4;
-            auto dst = pixelData.data() + (y * width + x) * 4;
-            dst[0] = SRC[2]; // R
-            dst[1] = SRC[1]; // G
-            dst[2] = SRC[0]; // B
-            dst[3] = SRC[3]; // A
-        }
-    }
-    return pixelData;
-}
-
 // Helper: Render text to cairo surface
 void renderTextToCairo(cairo_t* cr, const std::string& text,
                        int width, int height) {
@@ -102,12 +86,12 @@ SP<Render::ITexture> createEmojiTexture() {
         unsigned char* data = cairo_image_surface_get_data(surface);
         int stride = cairo_image_surface_get_stride(surface);
 
-        auto pixelData = convertBGRAtoRGBA(data, stride, ICON_SIZE, ICON_HEIGHT);
+        // Cairo draws BGRA; convert to RGBA in place and upload from there
+        PixelFormat::swapRedBlueInPlace(data, stride, ICON_SIZE, ICON_HEIGHT);
 
         const uint32_t drmFormat = DRM_FORMAT_ABGR8888;
-        const uint32_t textureStride = ICON_SIZE * 4;
-        auto tex = makeShared<Render::GL::CGLTexture>(drmFormat, pixelData.data(),
-            textureStride, Vector2D{(double)ICON_SIZE, (double)ICON_HEIGHT}, true);
+        auto tex = makeShared<Render::GL::CGLTexture>(drmFormat, data,
+            stride, Vector2D{(double)ICON_SIZE, (double)ICON_HEIGHT}, true);
 
         cairo_destroy(cr);
         cairo_surface_destroy(surface);
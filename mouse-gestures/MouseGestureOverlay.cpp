@@ -1,5 +1,11 @@
 #include "MouseGestureOverlay.hpp"
 #include "stroke.hpp"
+#include "trail_buffer.hpp"
+#include "trail_damage.hpp"
+#include "record_hover.hpp"
+#include "record_list.hpp"
+#include "lru_cache.hpp"
+#include "TrailBatchRenderer.hpp"
 #include <hyprland/src/render/OpenGL.hpp>
 #include <hyprland/src/render/Renderer.hpp>
 #include <hyprland/src/render/gl/GLTexture.hpp>
@@ -28,26 +34,34 @@ struct MouseGestureState {
     Vector2D mouseDownPos;
     bool dragDetected;
     std::vector<Vector2D> path;
-    std::vector<PathPoint> timestampedPath;
+    TrailBuffer<PathPoint> timestampedPath;
     std::chrono::steady_clock::time_point pressTime;
     uint32_t pressButton;
     uint32_t pressTimeMs;
 };
 
 extern MouseGestureState g_gestureState;
+extern TrailDamage g_trailDamage;
 extern bool g_recordMode;
 extern bool g_pluginShuttingDown;
 extern Vector2D g_lastMousePos;
+extern int g_livePredictionIndex;
 
 // Forward declaration from main.cpp
 struct GestureAction {
     Stroke pattern;
     std::string command;
     std::string name;
+    std::string strokeData;
+    int resampleCount;
+    std::string dispatcher;
+    std::string dispatchArg;
 };
 
 extern std::vector<GestureAction> g_gestureActions;
+extern uint64_t g_gestureActionsGeneration;
 extern std::unordered_map<PHLMONITOR, float> g_scrollOffsets;
+extern std::unordered_map<PHLMONITOR, RecordHoverMap> g_recordHover;
 extern std::unordered_map<PHLMONITOR, float> g_maxScrollOffsets;
 extern std::string g_configFilePath;
 
@@ -61,8 +75,50 @@ extern std::unordered_map<size_t, PHLANIMVAR<float>> g_gestureScaleAnims;
 extern std::unordered_map<size_t, PHLANIMVAR<float>> g_gestureAlphaAnims;
 extern std::unordered_set<size_t> g_gesturesPendingRemoval;
 
-// Background texture
-extern SP<Render::ITexture> g_pBackgroundTexture;
+// Background texture cropped and scaled for a monitor, nullptr until ready
+SP<Render::ITexture> backgroundTextureFor(PHLMONITOR monitor);
+
+// Batched circle drawing for trails and thumbnails, with scratch storage
+// for the instances of one batch
+CTrailBatchRenderer g_trailBatchRenderer;
+static std::vector<CircleInstance> g_circleInstances;
+
+// Rasterized gesture previews for the record mode list, keyed by stroke,
+// pixel size and monitor scale. Dropped whenever g_gestureActions or the
+// trail look changes.
+struct SGestureThumbnailCache {
+    std::unordered_map<std::string, SP<Render::ITexture>> textures;
+    uint64_t generation = 0;
+    float circleRadius = 0.0f;
+    CHyprColor startColor;
+    CHyprColor endColor;
+};
+static SGestureThumbnailCache g_gestureThumbnails;
+
+// Rasterized text and measured text widths, so static labels are drawn
+// from a texture instead of going through Pango every frame
+constexpr size_t TEXT_CACHE_SIZE = 64;
+static LruCache<std::string, SP<Render::ITexture>> g_textTextures{TEXT_CACHE_SIZE};
+static LruCache<std::string, float> g_textWidths{TEXT_CACHE_SIZE};
+
+static BatchColor toBatchColor(const CHyprColor& color) {
+    return {static_cast<float>(color.r), static_cast<float>(color.g),
+            static_cast<float>(color.b), static_cast<float>(color.a)};
+}
+
+// Submit a batch of circles, one rounded rect each if batching is unavailable
+static void renderCircles(PHLMONITOR monitor, const std::vector<CircleInstance>& circles,
+                          const CRegion* damage) {
+    if (g_trailBatchRenderer.draw(monitor, circles, damage))
+        return;
+
+    for (const auto& circle : circles) {
+        CBox circleBox = CBox{{circle.x - circle.radius, circle.y - circle.radius},
+                              {circle.radius * 2, circle.radius * 2}};
+        g_pHyprOpenGL->renderRect(circleBox, CHyprColor{circle.r, circle.g, circle.b, circle.a},
+                                  {.damage = damage, .round = static_cast<int>(circle.radius)});
+    }
+}
 
 CMouseGestureOverlay::CMouseGestureOverlay(PHLMONITOR monitor) : pMonitor(monitor) {
     // Store the monitor this overlay is for
@@ -98,6 +154,11 @@ std::vector<UP<IPassElement>> CMouseGestureOverlay::draw() {
         // Render gesture trail
         renderGestureTrail(monitor, monitorSize);
 
+        // Render the gesture that would fire on release
+        if (!g_recordMode) {
+            renderLivePrediction(monitor);
+        }
+
     } catch (const std::bad_alloc&) {
         // Handle memory allocation failures
     } catch (...) {
@@ -131,8 +192,26 @@ std::optional<CBox> CMouseGestureOverlay::boundingBox() {
             return CBox{{0, 0}, {0, 0}};
         }
 
-        // Return the full monitor size as the bounding box
-        return CBox{{0, 0}, monitor->m_size};
+        // The record mode UI covers the whole monitor
+        if (g_recordMode) {
+            return CBox{{0, 0}, monitor->m_size};
+        }
+
+        // Otherwise only the trail and the live prediction are drawn
+        const DamageRect& bounds = g_trailDamage.currentBounds();
+        if (!bounds.valid) {
+            return CBox{{0, 0}, {0, 0}};
+        }
+
+        const double x1 = std::max(bounds.x1 - monitor->m_position.x, 0.0);
+        const double y1 = std::max(bounds.y1 - monitor->m_position.y, 0.0);
+        const double x2 = std::min(bounds.x2 - monitor->m_position.x, monitor->m_size.x);
+        const double y2 = std::min(bounds.y2 - monitor->m_position.y, monitor->m_size.y);
+        if (x2 <= x1 || y2 <= y1) {
+            return CBox{{0, 0}, {0, 0}};
+        }
+
+        return CBox{x1, y1, x2 - x1, y2 - y1};
 
     } catch (const std::exception& e) {
         // Return a valid empty box on error
@@ -143,49 +222,36 @@ std::optional<CBox> CMouseGestureOverlay::boundingBox() {
     }
 }
 
+CRegion CMouseGestureOverlay::opaqueRegion() {
+    try {
+        // Only the record mode background is opaque, the trail blends
+        auto monitor = pMonitor.lock();
+        if (!monitor || !g_recordMode) {
+            return CRegion{};
+        }
+
+        return CBox{{0, 0}, monitor->m_size};
+    } catch (...) {
+        return CRegion{};
+    }
+}
+
 void CMouseGestureOverlay::renderBackground(PHLMONITOR monitor, float monScale) {
     // Clear to single background color (like workspace-overview)
     CBox clearBox = {{0, 0}, monitor->m_size};
     g_pHyprOpenGL->renderRect(clearBox, CHyprColor{0, 0, 0, 1.0}, {});
 
-    // Render background image if loaded
-    if (!g_pBackgroundTexture || g_pBackgroundTexture->m_texID == 0)
+    // Render background image if loaded. It is already cropped to cover
+    // the monitor, so it's drawn 1:1 over the whole monitor.
+    const auto backgroundTexture = backgroundTextureFor(monitor);
+    if (!backgroundTexture || backgroundTexture->m_texID == 0)
         return;
 
-    const Vector2D monitorSize = monitor->m_size;
-    const Vector2D texSize = g_pBackgroundTexture->m_size;
-    CBox bgBox = {{0, 0}, monitorSize};
-
-    const float monitorAspect = monitorSize.x / monitorSize.y;
-    const float textureAspect = texSize.x / texSize.y;
-
-    if (textureAspect > monitorAspect) {
-        const float scale = monitorSize.y / texSize.y;
-        const float scaledWidth = texSize.x * scale;
-        bgBox.x = -(scaledWidth - monitorSize.x) / 2.0f;
-        bgBox.w = scaledWidth;
-    } else {
-        const float scale = monitorSize.x / texSize.x;
-        const float scaledHeight = texSize.y * scale;
-        bgBox.y = -(scaledHeight - monitorSize.y) / 2.0f;
-        bgBox.h = scaledHeight;
-    }
-
+    CBox bgBox = {{0, 0}, monitor->m_size};
     bgBox.scale(monScale);
     bgBox.round();
 
-    g_pHyprOpenGL->renderTexture(g_pBackgroundTexture, bgBox, {});
-}
-
-CHyprColor CMouseGestureOverlay::interpolateColor(const CHyprColor& start,
-                                                  const CHyprColor& end,
-                                                  float t) {
-    CHyprColor result;
-    result.r = start.r + (end.r - start.r) * t;
-    result.g = start.g + (end.g - start.g) * t;
-    result.b = start.b + (end.b - start.b) * t;
-    result.a = start.a + (end.a - start.a) * t;
-    return result;
+    g_pHyprOpenGL->renderTexture(backgroundTexture, bgBox, {});
 }
 
 void CMouseGestureOverlay::renderBoxBorders(float x, float y, float size,
@@ -210,31 +276,91 @@ void CMouseGestureOverlay::renderGesturePattern(float x, float y, float size,
                                                 const TrailConfig& config,
                                                 const CRegion& damage) {
     constexpr float INNER_PADDING = 10.0f;
-    const float drawWidth = size - 2 * INNER_PADDING;
-    const float drawHeight = size - 2 * INNER_PADDING;
-    const size_t numPoints = points.size();
-    const float pointRadius = config.circleRadius;
-
-    for (size_t i = 0; i < numPoints; ++i) {
-        const auto& point = points[i];
-        float px = x + INNER_PADDING + point.x * drawWidth;
-        float py = y + INNER_PADDING + point.y * drawHeight;
-
-        float pathPosition = (numPoints > 1) ?
-            static_cast<float>(i) / static_cast<float>(numPoints - 1) : 0.0f;
-
-        CHyprColor gestureColor = interpolateColor(config.startColor,
-                                                   config.endColor,
-                                                   pathPosition);
-        gestureColor.a = 1.0f;
-
-        CBox pointBox = CBox{{px - pointRadius, py - pointRadius},
-                            {pointRadius * 2, pointRadius * 2}};
-
-        g_pHyprOpenGL->renderRect(pointBox, gestureColor,
-                                 {.damage = &damage,
-                                  .round = static_cast<int>(pointRadius)});
+
+    g_circleInstances.clear();
+    buildPatternInstances(g_circleInstances, points, x, y, size, INNER_PADDING,
+                          config.circleRadius, toBatchColor(config.startColor),
+                          toBatchColor(config.endColor));
+
+    renderCircles(pMonitor.lock(), g_circleInstances, &damage);
+}
+
+SP<Render::ITexture> CMouseGestureOverlay::getGestureThumbnail(const GestureAction& gesture,
+                                                                float size, float monScale) {
+    const auto config = getTrailConfig();
+
+    if (g_gestureThumbnails.generation != g_gestureActionsGeneration ||
+        g_gestureThumbnails.circleRadius != config.circleRadius ||
+        g_gestureThumbnails.startColor != config.startColor ||
+        g_gestureThumbnails.endColor != config.endColor) {
+        g_gestureThumbnails.textures.clear();
+        g_gestureThumbnails.generation = g_gestureActionsGeneration;
+        g_gestureThumbnails.circleRadius = config.circleRadius;
+        g_gestureThumbnails.startColor = config.startColor;
+        g_gestureThumbnails.endColor = config.endColor;
     }
+
+    const int pixelSize = static_cast<int>(std::ceil(size * monScale));
+    if (pixelSize <= 0 || pixelSize > 8192)
+        return nullptr;
+
+    std::string key = gesture.strokeData;
+    key += '\n' + std::to_string(gesture.resampleCount) + '@' + std::to_string(pixelSize) +
+           'x' + std::to_string(monScale);
+
+    auto it = g_gestureThumbnails.textures.find(key);
+    if (it != g_gestureThumbnails.textures.end())
+        return it->second;
+
+    // Same layout as renderGesturePattern, in pixels
+    constexpr float INNER_PADDING = 10.0f;
+    std::vector<CircleInstance> circles;
+    buildPatternInstances(circles, gesture.pattern.getPoints(), 0.0f, 0.0f,
+                          static_cast<float>(pixelSize), INNER_PADDING * monScale,
+                          config.circleRadius * monScale, toBatchColor(config.startColor),
+                          toBatchColor(config.endColor));
+
+    const auto CAIROSURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, pixelSize, pixelSize);
+    const auto CAIRO = cairo_create(CAIROSURFACE);
+
+    cairo_save(CAIRO);
+    cairo_set_operator(CAIRO, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(CAIRO);
+    cairo_restore(CAIRO);
+
+    for (const auto& circle : circles) {
+        cairo_set_source_rgba(CAIRO, circle.r, circle.g, circle.b, circle.a);
+        cairo_arc(CAIRO, circle.x, circle.y, circle.radius, 0.0, 2.0 * M_PI);
+        cairo_fill(CAIRO);
+    }
+    cairo_surface_flush(CAIROSURFACE);
+
+    SP<Render::ITexture> texture = makeShared<Render::GL::CGLTexture>();
+    const auto DATA = cairo_image_surface_get_data(CAIROSURFACE);
+    texture->allocate({static_cast<double>(pixelSize), static_cast<double>(pixelSize)}, DRM_FORMAT_ARGB8888);
+    glBindTexture(GL_TEXTURE_2D, texture->m_texID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+#ifndef GLES2
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+#endif
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pixelSize, pixelSize, 0,
+                GL_RGBA, GL_UNSIGNED_BYTE, DATA);
+
+    cairo_destroy(CAIRO);
+    cairo_surface_destroy(CAIROSURFACE);
+
+    g_gestureThumbnails.textures.emplace(std::move(key), texture);
+    return texture;
+}
+
+void clearOverlayCaches() {
+    g_gestureThumbnails.textures.clear();
+    g_textTextures.clear();
+    g_textWidths.clear();
 }
 
 void CMouseGestureOverlay::renderRecordSquare(const Vector2D& pos,
@@ -273,8 +399,9 @@ void CMouseGestureOverlay::renderDeleteButton(float x, float y, float size,
     }
 
     // Create a larger circular button with red-ish color and X marker
-    const float circleSize = 36.0f; // Larger button for better visibility
-    const float margin = 4.0f; // Margin from top and right edges
+    // Same box as the hit test in main.cpp
+    const float circleSize = RecordListLayout::DELETE_BUTTON_SIZE;
+    const float margin = RecordListLayout::DELETE_BUTTON_MARGIN;
 
     CBox bgBox;
     bgBox.x = x + size - circleSize - margin; // Top-right corner with margin
@@ -401,14 +528,12 @@ void CMouseGestureOverlay::renderGestureSquare(float x, float y, float size,
         if (!gesture.pattern.isFinished())
             return;
 
-        auto config = getTrailConfig();
-
-        // Apply alpha to trail colors
-        config.startColor.a *= alpha;
-        config.endColor.a *= alpha;
-
-        renderGesturePattern(scaledX, scaledY, scaledSize,
-                             gesture.pattern.getPoints(), config, damage);
+        // The preview is rasterized once at the unanimated size; scale
+        // and fade animations only transform the cached quad
+        auto thumbnail = getGestureThumbnail(gesture, size, monitor ? monitor->m_scale : 1.0f);
+        if (thumbnail && thumbnail->m_texID != 0) {
+            g_pHyprOpenGL->renderTexture(thumbnail, gestureBox, {.damage = &damage, .a = alpha});
+        }
 
         // Render delete button on top-right corner (only in record mode)
         if (g_recordMode) {
@@ -417,6 +542,9 @@ void CMouseGestureOverlay::renderGestureSquare(float x, float y, float size,
 
         // Render text on hover
         if (g_recordMode && monitor) {
+            auto& hover = g_recordHover[monitor];
+            hover.add(static_cast<int>(gestureIndex), scaledX, scaledY, scaledSize, scaledSize);
+
             // Convert mouse position to monitor-relative coordinates
             const Vector2D monitorPos = monitor->m_position;
             const Vector2D relativeMousePos = {
@@ -431,6 +559,7 @@ void CMouseGestureOverlay::renderGestureSquare(float x, float y, float size,
                             relativeMousePos.y <= scaledY + scaledSize;
 
             if (isHovered) {
+                hover.setHovered(static_cast<int>(gestureIndex));
 
                 std::string commandText;
                 if (gesture.command.empty()) {
@@ -450,23 +579,7 @@ void CMouseGestureOverlay::renderGestureSquare(float x, float y, float size,
                 // Use 2.5x line height to ensure descenders (g, p, y, q) are not clipped
                 const float lineHeight = FONT_SIZE * 2.5f;
 
-                // Measure actual text width using Pango
-                const auto CAIROSURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-                const auto CAIRO = cairo_create(CAIROSURFACE);
-                PangoLayout* layout = pango_cairo_create_layout(CAIRO);
-                PangoFontDescription* fontDesc = pango_font_description_from_string("Sans");
-                pango_font_description_set_size(fontDesc, FONT_SIZE * PANGO_SCALE);
-                pango_layout_set_font_description(layout, fontDesc);
-                pango_layout_set_text(layout, commandText.c_str(), -1);
-
-                int textW, textH;
-                pango_layout_get_size(layout, &textW, &textH);
-                const float measuredTextWidth = static_cast<float>(textW) / PANGO_SCALE;
-
-                g_object_unref(layout);
-                pango_font_description_free(fontDesc);
-                cairo_destroy(CAIRO);
-                cairo_surface_destroy(CAIROSURFACE);
+                const float measuredTextWidth = measureTextWidth(commandText, FONT_SIZE);
 
                 // Tooltip dimensions
                 const float tooltipWidth = measuredTextWidth + TOOLTIP_PADDING * 2.0f;
@@ -504,7 +617,6 @@ void CMouseGestureOverlay::renderGestureSquare(float x, float y, float size,
                 g_pHyprOpenGL->renderRect(rightBorder, borderColor, {.damage = &damage});
 
                 // Render text
-                SP<Render::ITexture> commandTexture = makeShared<Render::GL::CGLTexture>();
                 Vector2D lineBufferSize = {measuredTextWidth, lineHeight};
 
                 CHyprColor textColor{0.9, 0.9, 0.9, 1.0};
@@ -512,8 +624,8 @@ void CMouseGestureOverlay::renderGestureSquare(float x, float y, float size,
                     textColor = CHyprColor{0.6, 0.6, 0.6, 1.0};
                 }
 
-                renderText(commandTexture, commandText, textColor, lineBufferSize,
-                          monitor->m_scale, FONT_SIZE);
+                auto commandTexture = getTextTexture(commandText, textColor, lineBufferSize,
+                                                     monitor->m_scale, FONT_SIZE);
 
                 if (commandTexture && commandTexture->m_texID != 0) {
                     CBox textBox = {{tooltipX + TOOLTIP_PADDING, tooltipY + TOOLTIP_PADDING},
@@ -530,16 +642,13 @@ void CMouseGestureOverlay::renderGestureSquare(float x, float y, float size,
 }
 
 void CMouseGestureOverlay::renderRecordModeUI(PHLMONITOR monitor) {
-    constexpr float PADDING = 20.0f;
-    constexpr float GAP_WIDTH = 10.0f;
-    constexpr int VISIBLE_GESTURES = 3;
-    constexpr float TEXT_HEIGHT = 80.0f;
-    constexpr float TEXT_GAP = 20.0f;
-    constexpr float BOTTOM_MARGIN = 20.0f;
-
     const Vector2D monitorSize = monitor->m_size;
+    const auto listLayout = RecordListLayout::forMonitor(monitorSize.x, monitorSize.y);
     CRegion fullDamage{0, 0, INT16_MAX, INT16_MAX};
 
+    // Hover targets are collected while drawing the gesture list
+    g_recordHover[monitor].beginFrame();
+
     // Check if we have animation for this monitor
     Vector2D currentSize = monitorSize;
     Vector2D currentPos = {0, 0};
@@ -555,31 +664,10 @@ void CMouseGestureOverlay::renderRecordModeUI(PHLMONITOR monitor) {
         }
     }
 
-    // Calculate layout dimensions
-    const float verticalSpace = monitorSize.y - (2.0f * PADDING);
-    const float totalGaps = (VISIBLE_GESTURES - 1) * GAP_WIDTH;
-    const float baseHeight = (verticalSpace - totalGaps) / VISIBLE_GESTURES;
-    const float gestureRectHeight = baseHeight * 0.9f;
-    const float gestureRectWidth = gestureRectHeight;
-
-    // Rectangle extends from below the text to the bottom margin
-    const float maxVerticalSize = monitorSize.y - (PADDING + TEXT_HEIGHT +
-                                                    TEXT_GAP) - BOTTOM_MARGIN;
-    const float recordSquareSize = std::min(maxVerticalSize, maxVerticalSize);
-
-    // Calculate equal spacing for all three gaps:
-    // monitorSize.x = leftGap + gestureRectWidth + middleGap + recordSquareSize + rightGap
-    // where leftGap = middleGap = rightGap
-    // So: monitorSize.x = 3 * gap + gestureRectWidth + recordSquareSize
-    const float horizontalMargin = (monitorSize.x - gestureRectWidth - recordSquareSize) / 3.0f;
-
-    // Apply animation transform to record square
-    // Position record square with equal spacing on all sides
-    Vector2D recordPos = {
-        horizontalMargin + gestureRectWidth + horizontalMargin,
-        PADDING + TEXT_HEIGHT + TEXT_GAP
-    };
-    Vector2D recordSize = {recordSquareSize, recordSquareSize};
+    // Apply animation transform to record square. The layout is shared
+    // with the hit tests in main.cpp.
+    Vector2D recordPos = {listLayout.recordSquareX(), listLayout.recordSquareY()};
+    Vector2D recordSize = {listLayout.recordSquareSize, listLayout.recordSquareSize};
 
     // Transform the position and size based on animation
     Vector2D transformedRecordPos = {
@@ -593,16 +681,13 @@ void CMouseGestureOverlay::renderRecordModeUI(PHLMONITOR monitor) {
 
     // Render text above the record square
     const float textX = recordPos.x;
-    const float textY = PADDING;
-    const float textWidth = recordSquareSize;
-
-    SP<Render::ITexture> headerLine1 = makeShared<Render::GL::CGLTexture>();
-    SP<Render::ITexture> headerLine2 = makeShared<Render::GL::CGLTexture>();
+    const float textY = RecordListLayout::PADDING;
+    const float textWidth = listLayout.recordSquareSize;
 
     const std::string line1Text = "Register a new gesture.";
-    Vector2D line1BufferSize = {textWidth, TEXT_HEIGHT / 2.0f};
-    renderText(headerLine1, line1Text, CHyprColor{1.0, 1.0, 1.0, 1.0},
-              line1BufferSize, monitor->m_scale, 18);
+    Vector2D line1BufferSize = {textWidth, RecordListLayout::TEXT_HEIGHT / 2.0f};
+    auto headerLine1 = getTextTexture(line1Text, CHyprColor{1.0, 1.0, 1.0, 1.0},
+                                      line1BufferSize, monitor->m_scale, 18);
 
     std::string line2Text = "Config file: ";
     if (!g_configFilePath.empty()) {
@@ -610,17 +695,18 @@ void CMouseGestureOverlay::renderRecordModeUI(PHLMONITOR monitor) {
     } else {
         line2Text += "not set";
     }
-    Vector2D line2BufferSize = {textWidth, TEXT_HEIGHT / 2.0f};
-    renderText(headerLine2, line2Text, CHyprColor{0.8, 0.8, 0.8, 1.0},
-              line2BufferSize, monitor->m_scale, 14);
+    Vector2D line2BufferSize = {textWidth, RecordListLayout::TEXT_HEIGHT / 2.0f};
+    auto headerLine2 = getTextTexture(line2Text, CHyprColor{0.8, 0.8, 0.8, 1.0},
+                                      line2BufferSize, monitor->m_scale, 14);
 
     // Render the text textures
     if (headerLine1 && headerLine1->m_texID != 0) {
-        CBox line1Box = {{textX, textY}, {textWidth, TEXT_HEIGHT / 2.0f}};
+        CBox line1Box = {{textX, textY}, {textWidth, RecordListLayout::TEXT_HEIGHT / 2.0f}};
         g_pHyprOpenGL->renderTexture(headerLine1, line1Box, {});
     }
     if (headerLine2 && headerLine2->m_texID != 0) {
-        CBox line2Box = {{textX, textY + TEXT_HEIGHT / 2.0f}, {textWidth, TEXT_HEIGHT / 2.0f}};
+        CBox line2Box = {{textX, textY + RecordListLayout::TEXT_HEIGHT / 2.0f},
+                         {textWidth, RecordListLayout::TEXT_HEIGHT / 2.0f}};
         g_pHyprOpenGL->renderTexture(headerLine2, line2Box, {});
     }
 
@@ -631,27 +717,18 @@ void CMouseGestureOverlay::renderRecordModeUI(PHLMONITOR monitor) {
     float& maxScrollOffset = g_maxScrollOffsets[monitor];
     float& scrollOffset = g_scrollOffsets[monitor];
 
-    if (totalGestures > VISIBLE_GESTURES) {
-        const float totalHeight = totalGestures * (gestureRectHeight + GAP_WIDTH);
-        maxScrollOffset = totalHeight - verticalSpace;
-    } else {
-        maxScrollOffset = 0.0f;
-    }
-
+    maxScrollOffset = listLayout.maxScrollOffset(totalGestures);
     scrollOffset = std::clamp(scrollOffset, 0.0f, maxScrollOffset);
 
-    // Render gesture squares with animation transform
-    for (size_t i = 0; i < totalGestures; ++i) {
-        const float yPos = PADDING + i * (gestureRectHeight + GAP_WIDTH) -
-                          scrollOffset;
-
-        if (yPos + gestureRectHeight < 0 || yPos > monitorSize.y)
-            continue;
+    // Render only the gesture squares on screen, with animation transform
+    const auto visible = listLayout.visibleRange(totalGestures, scrollOffset);
+    for (size_t i = visible.begin; i < visible.end; ++i) {
+        const float yPos = listLayout.rowY(i, scrollOffset);
 
         // Transform the position and size
-        float transformedX = horizontalMargin * zoomScale + currentPos.x;
+        float transformedX = listLayout.horizontalMargin * zoomScale + currentPos.x;
         float transformedY = yPos * zoomScale + currentPos.y;
-        float transformedSize = gestureRectWidth * zoomScale;
+        float transformedSize = listLayout.gestureRectSize * zoomScale;
 
         renderGestureSquare(transformedX, transformedY, transformedSize, i,
                            fullDamage, transformedRecordPos.x, monitor);
@@ -666,41 +743,65 @@ void CMouseGestureOverlay::renderGestureTrail(PHLMONITOR monitor,
         return;
 
     auto config = getTrailConfig();
-    auto now = std::chrono::steady_clock::now();
-    const size_t numPoints = g_gestureState.timestampedPath.size();
-
-    for (size_t i = 0; i < numPoints; ++i) {
-        const auto& point = g_gestureState.timestampedPath[i];
-        auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - point.timestamp
-        ).count();
-
-        if (age > config.fadeDurationMs)
-            continue;
-
-        // Calculate position along the path (0.0 at start, 1.0 at end)
-        float pathPosition = (numPoints > 1) ?
-            static_cast<float>(i) / static_cast<float>(numPoints - 1) : 0.0f;
-
-        // Interpolate between start and end colors
-        CHyprColor color = interpolateColor(config.startColor,
-                                           config.endColor,
-                                           pathPosition);
-
-        // Apply alpha fade based on time
-        float alpha = 1.0f - (static_cast<float>(age) / config.fadeDurationMs);
-        color.a = alpha;
-
-        Vector2D localPos = point.position - monitor->m_position;
-        CBox circleBox = CBox{
-            {localPos.x - config.circleRadius, localPos.y - config.circleRadius},
-            {config.circleRadius * 2, config.circleRadius * 2}
-        };
-
-        g_pHyprOpenGL->renderRect(circleBox, color, {
-            .round = static_cast<int>(config.circleRadius)
-        });
-    }
+    const auto& trail = g_gestureState.timestampedPath;
+    const Vector2D monitorPos = monitor->m_position;
+
+    // Gradient positions count the points that already expired, so the
+    // colors stay put while the tail fades
+    g_circleInstances.clear();
+    buildTrailInstances(g_circleInstances, trail, trail.firstIndex(), trail.totalPushed(),
+                        std::chrono::steady_clock::now(), config.fadeDurationMs,
+                        config.circleRadius, toBatchColor(config.startColor),
+                        toBatchColor(config.endColor),
+                        [&monitorPos](const PathPoint& point) {
+                            return point.position - monitorPos;
+                        });
+
+    renderCircles(monitor, g_circleInstances, nullptr);
+}
+
+void CMouseGestureOverlay::renderLivePrediction(PHLMONITOR monitor) {
+    static auto* const PLIVEPREDICTION = (Hyprlang::INT* const*)
+        HyprlandAPI::getConfigValue(
+            PHANDLE, "plugin:mouse_gestures:live_prediction"
+        )->getDataStaticPtr();
+
+    if (!PLIVEPREDICTION || !*PLIVEPREDICTION || !**PLIVEPREDICTION)
+        return;
+
+    if (!g_gestureState.rightButtonPressed || !g_gestureState.dragDetected ||
+        g_gestureState.path.empty())
+        return;
+
+    if (g_livePredictionIndex < 0 ||
+        static_cast<size_t>(g_livePredictionIndex) >= g_gestureActions.size())
+        return;
+
+    const auto& gesture = g_gestureActions[g_livePredictionIndex];
+    if (!gesture.pattern.isFinished())
+        return;
+
+    constexpr float PREVIEW_SIZE = LIVE_PREVIEW_SIZE;
+    constexpr float CURSOR_OFFSET = LIVE_PREVIEW_CURSOR_OFFSET;
+    constexpr float MAX_POINT_RADIUS = 3.0f;
+
+    // Place the preview below right of the cursor, flipped at the edges
+    const Vector2D localPos = g_gestureState.path.back() - monitor->m_position;
+    float x = localPos.x + CURSOR_OFFSET;
+    float y = localPos.y + CURSOR_OFFSET;
+    if (x + PREVIEW_SIZE > monitor->m_size.x)
+        x = localPos.x - CURSOR_OFFSET - PREVIEW_SIZE;
+    if (y + PREVIEW_SIZE > monitor->m_size.y)
+        y = localPos.y - CURSOR_OFFSET - PREVIEW_SIZE;
+
+    CRegion damage{0, 0, INT16_MAX, INT16_MAX};
+    CBox previewBox = {x, y, PREVIEW_SIZE, PREVIEW_SIZE};
+    g_pHyprOpenGL->renderRect(previewBox, CHyprColor{0.1, 0.1, 0.1, 0.8},
+                             {.damage = &damage, .round = 8});
+
+    auto config = getTrailConfig();
+    config.circleRadius = std::min(config.circleRadius, MAX_POINT_RADIUS);
+    renderGesturePattern(x, y, PREVIEW_SIZE, gesture.pattern.getPoints(), config, damage);
 }
 
 void CMouseGestureOverlay::renderText(SP<Render::ITexture> out,
@@ -761,6 +862,59 @@ void CMouseGestureOverlay::renderText(SP<Render::ITexture> out,
     cairo_surface_destroy(CAIROSURFACE);
 }
 
+SP<Render::ITexture> CMouseGestureOverlay::getTextTexture(const std::string& text,
+                                                           const CHyprColor& color,
+                                                           const Vector2D& bufferSize,
+                                                           float scale,
+                                                           int fontSize) {
+    // Buffer sizes follow the layout, which can be fractional; renderText
+    // allocates whole pixels anyway
+    const int bufferW = static_cast<int>(bufferSize.x);
+    const int bufferH = static_cast<int>(bufferSize.y);
+    if (bufferW <= 0 || bufferH <= 0)
+        return nullptr;
+
+    std::string key = text;
+    key += '\n' + std::to_string(fontSize) + ',' + std::to_string(bufferW) + 'x' +
+           std::to_string(bufferH) + '@' + std::to_string(scale) + ',' +
+           std::to_string(color.r) + ',' + std::to_string(color.g) + ',' +
+           std::to_string(color.b) + ',' + std::to_string(color.a);
+
+    if (auto* cached = g_textTextures.find(key))
+        return *cached;
+
+    SP<Render::ITexture> texture = makeShared<Render::GL::CGLTexture>();
+    renderText(texture, text, color, {static_cast<double>(bufferW), static_cast<double>(bufferH)},
+               scale, fontSize);
+    return g_textTextures.insert(key, texture);
+}
+
+float CMouseGestureOverlay::measureTextWidth(const std::string& text, int fontSize) {
+    const std::string key = text + '\n' + std::to_string(fontSize);
+    if (auto* cached = g_textWidths.find(key))
+        return *cached;
+
+    // Measure actual text width using Pango
+    const auto CAIROSURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+    const auto CAIRO = cairo_create(CAIROSURFACE);
+    PangoLayout* layout = pango_cairo_create_layout(CAIRO);
+    PangoFontDescription* fontDesc = pango_font_description_from_string("Sans");
+    pango_font_description_set_size(fontDesc, fontSize * PANGO_SCALE);
+    pango_layout_set_font_description(layout, fontDesc);
+    pango_layout_set_text(layout, text.c_str(), -1);
+
+    int textW, textH;
+    pango_layout_get_size(layout, &textW, &textH);
+    const float width = static_cast<float>(textW) / PANGO_SCALE;
+
+    g_object_unref(layout);
+    pango_font_description_free(fontDesc);
+    cairo_destroy(CAIRO);
+    cairo_surface_destroy(CAIROSURFACE);
+
+    return g_textWidths.insert(key, width);
+}
+
 CMouseGestureOverlay::TrailConfig CMouseGestureOverlay::getTrailConfig() {
     static auto* const PCIRCLERADIUS = (Hyprlang::FLOAT* const*)
         HyprlandAPI::getConfigValue(
@@ -5,6 +5,9 @@
 #include <hyprland/src/render/gl/GLTexture.hpp>
 #include "stroke.hpp"
 
+// Free cached overlay textures, needs the EGL context current
+void clearOverlayCaches();
+
 class CMouseGestureOverlay : public IPassElement {
   public:
     CMouseGestureOverlay(PHLMONITOR monitor);
@@ -15,11 +18,16 @@ class CMouseGestureOverlay : public IPassElement {
     virtual bool                          needsPrecomputeBlur() override;
     virtual ePassElementType              type() override { return EK_CUSTOM; }
     virtual std::optional<CBox>           boundingBox() override;
+    virtual CRegion                       opaqueRegion() override;
 
     virtual const char* passName() override {
         return "CMouseGestureOverlay";
     }
 
+    // Live prediction preview, placed diagonally off the cursor
+    static constexpr float LIVE_PREVIEW_SIZE = 120.0f;
+    static constexpr float LIVE_PREVIEW_CURSOR_OFFSET = 24.0f;
+
   private:
     WP<CMonitor> pMonitor;
 
@@ -34,11 +42,16 @@ class CMouseGestureOverlay : public IPassElement {
     void renderDeleteButton(float x, float y, float size, const CRegion& damage,
                            float alpha = 1.0f);
     void renderGestureTrail(PHLMONITOR monitor, const Vector2D& monitorSize);
+    void renderLivePrediction(PHLMONITOR monitor);
     void renderBoxBorders(float x, float y, float size, const CHyprColor& color,
                          float borderSize, const CRegion& damage);
     void renderText(SP<Render::ITexture> out, const std::string& text,
                    const CHyprColor& color, const Vector2D& bufferSize,
                    float scale, int fontSize);
+    SP<Render::ITexture> getTextTexture(const std::string& text, const CHyprColor& color,
+                                        const Vector2D& bufferSize, float scale,
+                                        int fontSize);
+    float measureTextWidth(const std::string& text, int fontSize);
 
     struct TrailConfig {
         float circleRadius;
@@ -47,10 +60,10 @@ class CMouseGestureOverlay : public IPassElement {
         CHyprColor endColor;
     };
 
+    SP<Render::ITexture> getGestureThumbnail(const struct GestureAction& gesture,
+                                             float size, float monScale);
     void renderGesturePattern(float x, float y, float size,
                              const std::vector<Point>& points,
                              const TrailConfig& config, const CRegion& damage);
     TrailConfig getTrailConfig();
-    CHyprColor interpolateColor(const CHyprColor& start, const CHyprColor& end,
-                               float t);
 };
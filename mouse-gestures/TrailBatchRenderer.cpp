@@ -0,0 +1,233 @@
+#include "TrailBatchRenderer.hpp"
+#include <hyprland/src/render/Renderer.hpp>
+
+using Render::GL::g_pHyprOpenGL;
+#include <cstddef>
+
+namespace {
+
+// Each instance expands a unit quad around its center. Positions are in
+// renderRect box coordinates and normalized to the monitor, so the same
+// projection as a full-monitor renderRect applies.
+constexpr const char* VERTEX_SHADER = R"(#version 300 es
+precision highp float;
+
+uniform mat3 proj;
+uniform vec2 viewport;
+
+layout(location = 0) in vec2 corner;
+layout(location = 1) in vec3 circle;
+layout(location = 2) in vec4 color;
+
+out vec2 v_offset;
+out float v_radius;
+out vec4 v_color;
+
+void main() {
+    // One extra pixel for the antialiased edge
+    float extent = circle.z + 1.0;
+    vec2 position = circle.xy + corner * extent;
+
+    v_offset = corner * extent;
+    v_radius = circle.z;
+    v_color = color;
+    gl_Position = vec4(proj * vec3(position / viewport, 1.0), 1.0);
+}
+)";
+
+constexpr const char* FRAGMENT_SHADER = R"(#version 300 es
+precision highp float;
+
+in vec2 v_offset;
+in float v_radius;
+in vec4 v_color;
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    float coverage = clamp(v_radius + 0.5 - length(v_offset), 0.0, 1.0);
+    float alpha = v_color.a * coverage;
+    if (alpha <= 0.0)
+        discard;
+
+    // Premultiplied, like the compositor's own shaders
+    fragColor = vec4(v_color.rgb * alpha, alpha);
+}
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    if (!shader)
+        return 0;
+
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (ok != GL_TRUE) {
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint linkProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
+    if (!vertex)
+        return 0;
+
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!fragment) {
+        glDeleteShader(vertex);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    if (program) {
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+    }
+
+    // Flagged for deletion, freed together with the program
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    if (!program)
+        return 0;
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (ok != GL_TRUE) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+} // namespace
+
+CTrailBatchRenderer::~CTrailBatchRenderer() {
+    // GL objects must be freed with the context current, see destroy()
+}
+
+bool CTrailBatchRenderer::ensureInitialized() {
+    if (initialized)
+        return true;
+    if (failed)
+        return false;
+
+    program = linkProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+    if (!program) {
+        failed = true;
+        return false;
+    }
+
+    projLocation = glGetUniformLocation(program, "proj");
+    viewportLocation = glGetUniformLocation(program, "viewport");
+
+    static constexpr GLfloat QUAD[] = {
+        -1.0f, -1.0f,
+         1.0f, -1.0f,
+        -1.0f,  1.0f,
+         1.0f,  1.0f,
+    };
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &quadBuffer);
+    glGenBuffers(1, &instanceBuffer);
+
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD), QUAD, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(CircleInstance),
+                          reinterpret_cast<const void*>(offsetof(CircleInstance, x)));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(CircleInstance),
+                          reinterpret_cast<const void*>(offsetof(CircleInstance, r)));
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    initialized = true;
+    return true;
+}
+
+bool CTrailBatchRenderer::draw(PHLMONITOR monitor, const std::vector<CircleInstance>& instances,
+                               const CRegion* damage) {
+    if (instances.empty())
+        return true;
+
+    if (!monitor || !g_pHyprOpenGL || !g_pHyprRenderer)
+        return false;
+
+    if (!ensureInitialized())
+        return false;
+
+    auto& renderData = g_pHyprRenderer->m_renderData;
+    const CRegion& clip = damage ? *damage : renderData.damage;
+    if (clip.empty())
+        return true;
+
+    // Map the whole monitor like renderRect maps a box, instance
+    // positions are normalized to it in the vertex shader
+    const Vector2D viewport = monitor->m_pixelSize;
+    CBox monitorBox = {{0, 0}, viewport};
+    renderData.renderModif.applyToBox(monitorBox);
+    Mat3x3 matrix = renderData.monitorProjection.projectBox(monitorBox, HYPRUTILS_TRANSFORM_NORMAL, 0);
+    Mat3x3 glMatrix = renderData.projection.copy().multiply(matrix);
+
+    g_pHyprOpenGL->blend(true);
+    g_pHyprOpenGL->useProgram(program);
+    glUniformMatrix3fv(projLocation, 1, GL_TRUE, glMatrix.getMatrix().data());
+    glUniform2f(viewportLocation, viewport.x, viewport.y);
+
+    // Orphan and refill the instance buffer each frame
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    const size_t bytes = instances.size() * sizeof(CircleInstance);
+    if (instances.size() > instanceCapacity) {
+        instanceCapacity = instances.size();
+    }
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(CircleInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+
+    glBindVertexArray(vao);
+    const GLsizei count = static_cast<GLsizei>(instances.size());
+    clip.forEachRect([count](const auto& RECT) {
+        g_pHyprOpenGL->scissor(&RECT);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+    });
+    g_pHyprOpenGL->scissor(nullptr);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void CTrailBatchRenderer::destroy() {
+    if (instanceBuffer)
+        glDeleteBuffers(1, &instanceBuffer);
+    if (quadBuffer)
+        glDeleteBuffers(1, &quadBuffer);
+    if (vao)
+        glDeleteVertexArrays(1, &vao);
+    if (program)
+        glDeleteProgram(program);
+
+    instanceBuffer = 0;
+    quadBuffer = 0;
+    vao = 0;
+    program = 0;
+    instanceCapacity = 0;
+    initialized = false;
+    failed = false;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <hyprland/src/render/OpenGL.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <vector>
+#include "trail_batch.hpp"
+
+// Draws a batch of antialiased circles with one instanced draw call per
+// damage rectangle, instead of one rounded renderRect per point.
+//
+// GL objects are created lazily on first use from the render thread.
+// If the shader can't be built (e.g. a GLES2 context), draw() returns
+// false and callers fall back to renderRect.
+class CTrailBatchRenderer {
+  public:
+    CTrailBatchRenderer() = default;
+    ~CTrailBatchRenderer();
+
+    CTrailBatchRenderer(const CTrailBatchRenderer&) = delete;
+    CTrailBatchRenderer& operator=(const CTrailBatchRenderer&) = delete;
+
+    // Draw `instances`, positioned in the same coordinates as boxes passed
+    // to renderRect, clipped to `damage` (the current render damage if
+    // null). Returns false if nothing could be drawn.
+    bool draw(PHLMONITOR monitor, const std::vector<CircleInstance>& instances,
+              const CRegion* damage = nullptr);
+
+    // Free the GL objects, needs the EGL context current
+    void destroy();
+
+  private:
+    bool ensureInitialized();
+
+    bool   initialized = false;
+    bool   failed = false;
+
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint quadBuffer = 0;
+    GLuint instanceBuffer = 0;
+    size_t instanceCapacity = 0;
+
+    GLint  projLocation = -1;
+    GLint  viewportLocation = -1;
+};
@@ -0,0 +1,342 @@
+#pragma once
+
+// Background image for the record mode overlay, decoded and scaled off the
+// compositor thread.
+//
+// BackgroundLoader decodes the image on a worker thread and produces one
+// variant per output size, already cropped and scaled the way the overlay
+// covers the output with it. The event loop only uploads the finished
+// variants, and the overlay draws each one 1:1 instead of sampling the
+// full-resolution image on every frame. The decoded image is not kept
+// around; a new output size decodes it again.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// Tightly packed RGBA pixels
+struct BackgroundImage {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgba;
+};
+
+struct BackgroundSize {
+    int width = 0;
+    int height = 0;
+
+    bool operator==(const BackgroundSize&) const = default;
+
+    uint64_t key() const {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(width)) << 32) |
+               static_cast<uint32_t>(height);
+    }
+};
+
+// Part of an image to show on an output, centered and cropped so it
+// covers the output without distortion
+struct BackgroundCrop {
+    double x = 0.0;
+    double y = 0.0;
+    double width = 0.0;
+    double height = 0.0;
+};
+
+inline BackgroundCrop backgroundCoverCrop(int imageWidth, int imageHeight, BackgroundSize output) {
+    BackgroundCrop crop{0.0, 0.0, static_cast<double>(imageWidth), static_cast<double>(imageHeight)};
+    if (imageWidth <= 0 || imageHeight <= 0 || output.width <= 0 || output.height <= 0) {
+        return crop;
+    }
+
+    const double imageAspect = static_cast<double>(imageWidth) / imageHeight;
+    const double outputAspect = static_cast<double>(output.width) / output.height;
+    if (imageAspect > outputAspect) {
+        crop.width = imageHeight * outputAspect;
+        crop.x = (imageWidth - crop.width) / 2.0;
+    } else {
+        crop.height = imageWidth / outputAspect;
+        crop.y = (imageHeight - crop.height) / 2.0;
+    }
+    return crop;
+}
+
+// Size of the variant for `output`: the output size, or the crop itself
+// if the image is smaller than that. Upscaling is left to the GPU.
+inline BackgroundSize backgroundVariantSize(int imageWidth, int imageHeight, BackgroundSize output) {
+    const BackgroundCrop crop = backgroundCoverCrop(imageWidth, imageHeight, output);
+    if (crop.width >= output.width) {
+        return output;
+    }
+    return {std::max(1, static_cast<int>(crop.width + 0.5)),
+            std::max(1, static_cast<int>(crop.height + 0.5))};
+}
+
+// The variant of `image` for `output`. Downscales with a box filter, every
+// destination pixel averaging the source pixels it covers.
+inline BackgroundImage scaleBackgroundToCover(const BackgroundImage& image, BackgroundSize output) {
+    BackgroundImage result;
+    if (image.width <= 0 || image.height <= 0 || output.width <= 0 || output.height <= 0) {
+        return result;
+    }
+
+    const BackgroundCrop crop = backgroundCoverCrop(image.width, image.height, output);
+    const BackgroundSize size = backgroundVariantSize(image.width, image.height, output);
+    result.width = size.width;
+    result.height = size.height;
+    result.rgba.resize(static_cast<size_t>(size.width) * size.height * 4);
+
+    const double stepX = crop.width / size.width;
+    const double stepY = crop.height / size.height;
+
+    // Source columns of each destination column, shared by all rows
+    std::vector<int> columnBegin(size.width);
+    std::vector<int> columnEnd(size.width);
+    for (int x = 0; x < size.width; x++) {
+        columnBegin[x] = std::clamp(static_cast<int>(crop.x + x * stepX), 0, image.width - 1);
+        columnEnd[x] = std::clamp(static_cast<int>(crop.x + (x + 1) * stepX), columnBegin[x] + 1,
+                                  image.width);
+    }
+
+    for (int y = 0; y < size.height; y++) {
+        const int rowBegin = std::clamp(static_cast<int>(crop.y + y * stepY), 0, image.height - 1);
+        const int rowEnd = std::clamp(static_cast<int>(crop.y + (y + 1) * stepY), rowBegin + 1,
+                                      image.height);
+        uint8_t* dst = result.rgba.data() + static_cast<size_t>(y) * size.width * 4;
+
+        for (int x = 0; x < size.width; x++) {
+            uint32_t sum[4] = {0, 0, 0, 0};
+            for (int sy = rowBegin; sy < rowEnd; sy++) {
+                const uint8_t* src = image.rgba.data() +
+                                     (static_cast<size_t>(sy) * image.width + columnBegin[x]) * 4;
+                for (int sx = columnBegin[x]; sx < columnEnd[x]; sx++, src += 4) {
+                    sum[0] += src[0];
+                    sum[1] += src[1];
+                    sum[2] += src[2];
+                    sum[3] += src[3];
+                }
+            }
+
+            const uint32_t count = static_cast<uint32_t>((rowEnd - rowBegin) * (columnEnd[x] - columnBegin[x]));
+            for (int c = 0; c < 4; c++) {
+                dst[x * 4 + c] = static_cast<uint8_t>((sum[c] + count / 2) / count);
+            }
+        }
+    }
+    return result;
+}
+
+class BackgroundLoader {
+  public:
+    // Decodes the image at `path`, called on the worker thread
+    using DecodeFn = std::function<std::optional<BackgroundImage>(const std::string& path)>;
+
+    struct Result {
+        uint64_t generation = 0;
+        bool failed = false;     // The image couldn't be decoded
+        BackgroundSize output;   // Output size the variant was made for
+        BackgroundImage image;
+    };
+
+    explicit BackgroundLoader(DecodeFn decode) : decode(std::move(decode)) {
+        eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    ~BackgroundLoader() {
+        shutdown();
+        if (eventFd >= 0) {
+            close(eventFd);
+        }
+    }
+
+    BackgroundLoader(const BackgroundLoader&) = delete;
+    BackgroundLoader& operator=(const BackgroundLoader&) = delete;
+
+    // Readable when results are ready, -1 if it couldn't be created
+    int pollFd() const {
+        return eventFd;
+    }
+
+    // Start loading `path` for `outputs`. Work and results of earlier
+    // loads are dropped. Returns the new generation.
+    uint64_t load(std::string path, std::vector<BackgroundSize> outputs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+        currentPath = std::move(path);
+        requested.clear();
+        jobs.clear();
+        results.clear();
+
+        if (!currentPath.empty()) {
+            enqueue(std::move(outputs));
+        }
+        return generation;
+    }
+
+    // Also produce a variant for `output` of the current image, unless it
+    // was already requested
+    void request(BackgroundSize output) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!currentPath.empty()) {
+            enqueue({output});
+        }
+    }
+
+    // Results of the current generation, in the order they finished
+    std::vector<Result> takeResults() {
+        if (eventFd >= 0) {
+            uint64_t posted = 0;
+            if (read(eventFd, &posted, sizeof(posted)) != sizeof(posted)) {
+                // Nothing posted since the last call
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Result> taken(std::make_move_iterator(results.begin()),
+                                  std::make_move_iterator(results.end()));
+        results.clear();
+        return taken;
+    }
+
+    uint64_t currentGeneration() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return generation;
+    }
+
+    // Whether work is queued or running
+    bool busy() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !jobs.empty() || working;
+    }
+
+    // Drop queued work and join the worker
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            jobs.clear();
+        }
+        wake.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+  private:
+    struct Job {
+        uint64_t generation;
+        std::string path;
+        std::vector<BackgroundSize> outputs;
+    };
+
+    DecodeFn decode;
+    int eventFd = -1;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    std::deque<Job> jobs;
+    std::deque<Result> results;
+    std::vector<BackgroundSize> requested;  // Outputs of the current generation
+    std::string currentPath;
+    uint64_t generation = 0;
+    bool working = false;
+    bool stopping = false;
+
+    // Called with the mutex held
+    void enqueue(std::vector<BackgroundSize> outputs) {
+        std::vector<BackgroundSize> fresh;
+        for (const auto& output : outputs) {
+            if (output.width <= 0 || output.height <= 0 ||
+                std::find(requested.begin(), requested.end(), output) != requested.end()) {
+                continue;
+            }
+            requested.push_back(output);
+            fresh.push_back(output);
+        }
+        if (fresh.empty() || stopping) {
+            return;
+        }
+
+        // Sizes requested before the worker got to the image share its decode
+        if (!jobs.empty() && jobs.back().generation == generation) {
+            jobs.back().outputs.insert(jobs.back().outputs.end(), fresh.begin(), fresh.end());
+        } else {
+            jobs.push_back({generation, currentPath, std::move(fresh)});
+        }
+
+        if (!worker.joinable()) {
+            worker = std::thread([this]() { workerLoop(); });
+        }
+        wake.notify_all();
+    }
+
+    void post(Result result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (result.generation != generation) {
+                return;
+            }
+            results.push_back(std::move(result));
+        }
+        if (eventFd >= 0) {
+            const uint64_t one = 1;
+            if (write(eventFd, &one, sizeof(one)) != sizeof(one)) {
+                // Counter overflow only, the event loop is already woken
+            }
+        }
+    }
+
+    bool isCurrent(uint64_t jobGeneration) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return jobGeneration == generation && !stopping;
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            working = true;
+            lock.unlock();
+
+            std::optional<BackgroundImage> image;
+            try {
+                image = decode(job.path);
+            } catch (...) {
+                image.reset();
+            }
+
+            if (!image || image->width <= 0 || image->height <= 0 ||
+                image->rgba.size() < static_cast<size_t>(image->width) * image->height * 4) {
+                post({.generation = job.generation, .failed = true});
+            } else {
+                for (const auto& output : job.outputs) {
+                    // A newer image replaced this one
+                    if (!isCurrent(job.generation)) {
+                        break;
+                    }
+                    post({.generation = job.generation, .output = output,
+                          .image = scaleBackgroundToCover(*image, output)});
+                }
+            }
+
+            lock.lock();
+            working = false;
+        }
+    }
+};
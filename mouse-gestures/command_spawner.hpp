@@ -0,0 +1,298 @@
+#pragma once
+
+// Starts gesture commands with posix_spawn instead of a detached thread
+// calling system() per gesture.
+//
+// posix_spawn creates the child with vfork semantics, so the cost does not
+// grow with the compositor's address space the way a fork does. Each
+// command runs through a short-lived launcher shell that puts it in the
+// background and exits, like Hyprland's own exec. Only a bounded number
+// of launchers run at once; further commands wait in a bounded queue and
+// are dropped beyond that, so a burst of gestures can't pile up
+// processes. Exited launchers are reaped through pidfds collected in one
+// epoll fd, which the caller watches on its event loop.
+//
+// Owned by the event loop thread.
+
+#include "gesture_stats.hpp"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <deque>
+#include <spawn.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+extern char** environ;
+
+class CommandSpawner {
+  public:
+    static constexpr size_t DEFAULT_MAX_RUNNING = 8;
+    static constexpr size_t DEFAULT_MAX_QUEUED = 32;
+
+    struct Options {
+        size_t maxRunning = DEFAULT_MAX_RUNNING;
+        size_t maxQueued = DEFAULT_MAX_QUEUED;
+        // Put the command in the background so the slot is freed as soon
+        // as it is launched. Otherwise the slot is held until it exits.
+        bool detach = true;
+    };
+
+    struct Stats {
+        // Latencies in microseconds
+        StatsHistogram queueWait;  // Submit until the spawn starts
+        StatsHistogram spawn;      // The posix_spawn call itself
+        StatsHistogram launch;     // Spawn until the launcher is reaped
+
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> spawned{0};
+        std::atomic<uint64_t> queued{0};   // Had to wait for a free slot
+        std::atomic<uint64_t> dropped{0};  // Queue was full
+        std::atomic<uint64_t> failed{0};   // posix_spawn failed
+
+        void reset() {
+            queueWait.reset();
+            spawn.reset();
+            launch.reset();
+            submitted.store(0, std::memory_order_relaxed);
+            spawned.store(0, std::memory_order_relaxed);
+            queued.store(0, std::memory_order_relaxed);
+            dropped.store(0, std::memory_order_relaxed);
+            failed.store(0, std::memory_order_relaxed);
+        }
+
+        std::string toJson() const {
+            std::string out = "{";
+            char buffer[256];
+            std::snprintf(buffer, sizeof(buffer),
+                          "\"submitted\":%llu,\"spawned\":%llu,\"queued\":%llu,"
+                          "\"dropped\":%llu,\"failed\":%llu,",
+                          static_cast<unsigned long long>(submitted.load(std::memory_order_relaxed)),
+                          static_cast<unsigned long long>(spawned.load(std::memory_order_relaxed)),
+                          static_cast<unsigned long long>(queued.load(std::memory_order_relaxed)),
+                          static_cast<unsigned long long>(dropped.load(std::memory_order_relaxed)),
+                          static_cast<unsigned long long>(failed.load(std::memory_order_relaxed)));
+            out += buffer;
+
+            out += "\"latency_us\":{\"queue_wait\":";
+            GestureStats::appendHistogramJson(out, queueWait.snapshot());
+            out += ",\"spawn\":";
+            GestureStats::appendHistogramJson(out, spawn.snapshot());
+            out += ",\"launch\":";
+            GestureStats::appendHistogramJson(out, launch.snapshot());
+            out += "}}";
+            return out;
+        }
+    };
+
+    CommandSpawner() : CommandSpawner(Options{}) {}
+
+    explicit CommandSpawner(Options options) : options(options) {
+        if (this->options.maxRunning == 0) {
+            this->options.maxRunning = 1;
+        }
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+    }
+
+    ~CommandSpawner() {
+        // Queued commands never ran and must not start now. Launchers exit
+        // right away; whatever is still running is left to be reaped by
+        // the compositor.
+        pending.clear();
+        reap();
+        for (const auto& child : children) {
+            if (child.pidfd >= 0) {
+                close(child.pidfd);
+            }
+        }
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+    }
+
+    CommandSpawner(const CommandSpawner&) = delete;
+    CommandSpawner& operator=(const CommandSpawner&) = delete;
+
+    // Readable when a child has exited, -1 if epoll is unavailable. In that
+    // case exited children are only reaped by reap() and submit().
+    int pollFd() const {
+        return epollFd;
+    }
+
+    // Run `command` now, or once a slot frees up. Returns false if it was
+    // dropped because the queue is full or the spawn failed.
+    bool submit(const std::string& command) {
+        if (command.empty()) {
+            return false;
+        }
+
+        stats.submitted.fetch_add(1, std::memory_order_relaxed);
+
+        // Free slots of launchers that exited without a pidfd event yet
+        if (children.size() >= options.maxRunning) {
+            reap();
+        }
+
+        if (children.size() < options.maxRunning) {
+            return start(command, std::chrono::steady_clock::now());
+        }
+
+        if (pending.size() >= options.maxQueued) {
+            stats.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        stats.queued.fetch_add(1, std::memory_order_relaxed);
+        pending.push_back({command, std::chrono::steady_clock::now()});
+        return true;
+    }
+
+    // Reap exited children and start queued commands in the freed slots.
+    // Returns the number of children reaped.
+    size_t reap() {
+        size_t reaped = 0;
+        for (size_t i = 0; i < children.size();) {
+            if (!hasExited(children[i].pid)) {
+                i++;
+                continue;
+            }
+
+            stats.launch.record(GestureStats::microsSince(children[i].spawnTime));
+            if (children[i].pidfd >= 0) {
+                close(children[i].pidfd);  // Also drops it from the epoll set
+            }
+            children[i] = std::move(children.back());
+            children.pop_back();
+            reaped++;
+        }
+
+        while (!pending.empty() && children.size() < options.maxRunning) {
+            auto next = std::move(pending.front());
+            pending.pop_front();
+            start(next.command, next.submitTime);
+        }
+
+        return reaped;
+    }
+
+    size_t running() const {
+        return children.size();
+    }
+
+    size_t queuedCount() const {
+        return pending.size();
+    }
+
+    Stats& getStats() {
+        return stats;
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+  private:
+    struct Child {
+        pid_t pid;
+        int pidfd;
+        std::chrono::steady_clock::time_point spawnTime;
+    };
+
+    struct Pending {
+        std::string command;
+        std::chrono::steady_clock::time_point submitTime;
+    };
+
+    Options options;
+    int epollFd = -1;
+    std::vector<Child> children;
+    std::deque<Pending> pending;
+    Stats stats;
+
+    bool start(const std::string& command, std::chrono::steady_clock::time_point submitTime) {
+        stats.queueWait.record(GestureStats::microsSince(submitTime));
+
+        // The command is passed as $1 rather than pasted into the script
+        const char* script = options.detach ? "eval \"$1\" &" : "eval \"$1\"";
+        const char* argv[] = {"/bin/sh", "-c", script, "mouse-gestures",
+                              command.c_str(), nullptr};
+
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+
+        // Don't leak the compositor's signal mask and handlers
+        sigset_t signals;
+        sigemptyset(&signals);
+        posix_spawnattr_setsigmask(&attr, &signals);
+        sigfillset(&signals);
+        sigdelset(&signals, SIGKILL);
+        sigdelset(&signals, SIGSTOP);
+        posix_spawnattr_setsigdefault(&attr, &signals);
+
+        short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_SETSID
+        flags |= POSIX_SPAWN_SETSID;
+#endif
+        posix_spawnattr_setflags(&attr, flags);
+
+        const auto spawnStart = std::chrono::steady_clock::now();
+        pid_t pid = -1;
+        const int error = posix_spawn(&pid, "/bin/sh", nullptr, &attr,
+                                      const_cast<char* const*>(argv), environ);
+        posix_spawnattr_destroy(&attr);
+        stats.spawn.record(GestureStats::microsSince(spawnStart));
+
+        if (error != 0) {
+            stats.failed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        stats.spawned.fetch_add(1, std::memory_order_relaxed);
+        children.push_back({pid, watch(pid), spawnStart});
+        return true;
+    }
+
+    // pidfd of `pid` registered with the epoll fd, -1 if that's not
+    // possible (old kernel, or the child is already gone)
+    int watch(pid_t pid) {
+#ifdef SYS_pidfd_open
+        if (epollFd < 0) {
+            return -1;
+        }
+
+        const int pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+        if (pidfd < 0) {
+            return -1;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = pidfd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, pidfd, &event) != 0) {
+            close(pidfd);
+            return -1;
+        }
+        return pidfd;
+#else
+        (void)pid;
+        return -1;
+#endif
+    }
+
+    // If SIGCHLD is ignored the kernel reaps the child itself, waitpid
+    // then fails with ECHILD once it is gone
+    static bool hasExited(pid_t pid) {
+        int status = 0;
+        const pid_t result = waitpid(pid, &status, WNOHANG);
+        if (result == pid) {
+            return true;
+        }
+        return result < 0 && errno == ECHILD;
+    }
+};
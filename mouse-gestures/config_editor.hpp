@@ -0,0 +1,401 @@
+#pragma once
+
+// Edits of the gesture_action lines in the Hyprland config.
+//
+// Gestures recorded or deleted in record mode are collected into one
+// GestureEditBatch. ConfigWriteQueue applies batches on a single writer
+// thread; batches submitted while a write is running are merged, so any
+// number of gestures costs one read and one atomic rewrite per file.
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// Normalize stroke data by replacing -0.000000 with 0.000000
+inline std::string normalizeStrokeData(const std::string& stroke) {
+    std::string normalized = stroke;
+    size_t pos = 0;
+    while ((pos = normalized.find("-0.000000", pos)) != std::string::npos) {
+        normalized.replace(pos, 9, "0.000000");
+        pos += 8;
+    }
+    return normalized;
+}
+
+namespace config_editor_detail {
+
+inline std::string trim(const std::string& line, const char* whitespace = " \t") {
+    const size_t start = line.find_first_not_of(whitespace);
+    if (start == std::string::npos) {
+        return "";
+    }
+    const size_t end = line.find_last_not_of(whitespace);
+    return line.substr(start, end - start + 1);
+}
+
+} // namespace config_editor_detail
+
+// Stroke data of a `gesture_action = command|stroke` line, nullopt for
+// any other line
+inline std::optional<std::string> gestureLineStroke(const std::string& line) {
+    const std::string trimmed = config_editor_detail::trim(line);
+    if (trimmed.find("gesture_action") != 0) {
+        return std::nullopt;
+    }
+
+    const size_t equalPos = trimmed.find('=');
+    if (equalPos == std::string::npos) {
+        return std::nullopt;
+    }
+
+    const std::string value = trimmed.substr(equalPos + 1);
+    const size_t pipePos = value.rfind('|');
+    if (pipePos == std::string::npos) {
+        return std::nullopt;
+    }
+
+    return config_editor_detail::trim(value.substr(pipePos + 1), " \t\n\r");
+}
+
+// A recorded gesture to write to the config
+struct GestureConfigEntry {
+    std::string strokeData;
+    // Unset: a placeholder pointing at the file the gesture ends up in
+    std::optional<std::string> command;
+    std::vector<std::string> comments;  // Comment lines above it, e.g. ASCII art
+};
+
+// Additions and deletions to apply together
+struct GestureEditBatch {
+    std::vector<GestureConfigEntry> additions;
+    std::vector<std::string> deletions;  // Stroke data
+
+    bool empty() const {
+        return additions.empty() && deletions.empty();
+    }
+
+    // Append `other`. A gesture added and then deleted again cancels out,
+    // as long as the addition hasn't been written yet.
+    void merge(GestureEditBatch other) {
+        for (auto& addition : other.additions) {
+            additions.push_back(std::move(addition));
+        }
+        for (auto& deletion : other.deletions) {
+            deletions.push_back(std::move(deletion));
+        }
+        cancelAddedThenDeleted();
+    }
+
+    void cancelAddedThenDeleted() {
+        for (auto addition = additions.begin(); addition != additions.end();) {
+            const std::string normalized = normalizeStrokeData(addition->strokeData);
+            auto deletion = std::find_if(deletions.begin(), deletions.end(),
+                                         [&normalized](const std::string& stroke) {
+                                             return normalizeStrokeData(stroke) == normalized;
+                                         });
+            if (deletion != deletions.end()) {
+                deletions.erase(deletion);
+                addition = additions.erase(addition);
+            } else {
+                ++addition;
+            }
+        }
+    }
+};
+
+// Remove the gesture_action lines of `strokes`, together with the comment
+// lines right above them. Returns the number of gestures removed.
+inline size_t deleteGestureLines(std::vector<std::string>& lines,
+                                 const std::vector<std::string>& strokes) {
+    if (strokes.empty()) {
+        return 0;
+    }
+
+    std::vector<std::string> normalizedStrokes;
+    normalizedStrokes.reserve(strokes.size());
+    for (const auto& stroke : strokes) {
+        normalizedStrokes.push_back(normalizeStrokeData(stroke));
+    }
+
+    std::vector<bool> remove(lines.size(), false);
+    size_t removed = 0;
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        const auto stroke = gestureLineStroke(lines[i]);
+        if (!stroke) {
+            continue;
+        }
+
+        const std::string normalized = normalizeStrokeData(*stroke);
+        if (std::find(normalizedStrokes.begin(), normalizedStrokes.end(), normalized) ==
+            normalizedStrokes.end()) {
+            continue;
+        }
+
+        remove[i] = true;
+        removed++;
+        for (size_t j = i; j > 0 && config_editor_detail::trim(lines[j - 1]).find('#') == 0; j--) {
+            remove[j - 1] = true;
+        }
+    }
+
+    if (removed > 0) {
+        size_t out = 0;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (remove[i]) {
+                continue;
+            }
+            if (out != i) {
+                lines[out] = std::move(lines[i]);
+            }
+            out++;
+        }
+        lines.resize(out);
+    }
+    return removed;
+}
+
+// Split config text into lines without their '\n'
+inline std::vector<std::string> splitConfigLines(std::string_view text) {
+    std::vector<std::string> lines;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        lines.emplace_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return lines;
+}
+
+// Join lines, each ending in '\n'
+inline std::string joinConfigLines(const std::vector<std::string>& lines) {
+    size_t size = 0;
+    for (const auto& line : lines) {
+        size += line.size() + 1;
+    }
+
+    std::string text;
+    text.reserve(size);
+    for (const auto& line : lines) {
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+// The config lines of `entries`, `placeholderCommand` standing in for
+// entries without a command
+inline std::vector<std::string> formatGestureLines(const std::vector<GestureConfigEntry>& entries,
+                                                   const std::string& placeholderCommand) {
+    std::vector<std::string> lines;
+    for (const auto& entry : entries) {
+        for (const auto& comment : entry.comments) {
+            lines.push_back("    " + comment);
+        }
+        lines.push_back("    gesture_action = " + entry.command.value_or(placeholderCommand) +
+                        "|" + entry.strokeData);
+    }
+    return lines;
+}
+
+// When config writes are flushed to disk
+enum class ConfigFsyncPolicy {
+    None,       // Leave it to the kernel
+    File,       // fsync the new file before renaming it into place
+    Directory,  // Also fsync the directory, so the rename itself is durable
+};
+
+inline ConfigFsyncPolicy configFsyncPolicyFromInt(int64_t value) {
+    if (value <= 0) {
+        return ConfigFsyncPolicy::None;
+    }
+    return value == 1 ? ConfigFsyncPolicy::File : ConfigFsyncPolicy::Directory;
+}
+
+// Replace `path` with `content` through a temporary file and one rename
+inline bool writeConfigAtomically(const std::string& path, std::string_view content,
+                                  ConfigFsyncPolicy policy) {
+    const std::string tempPath = path + ".tmp";
+
+    const int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    size_t written = 0;
+    while (written < content.size()) {
+        const ssize_t result = write(fd, content.data() + written, content.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(result);
+    }
+
+    bool ok = written == content.size();
+    if (ok && policy != ConfigFsyncPolicy::None) {
+        ok = fsync(fd) == 0;
+    }
+    ok = (close(fd) == 0) && ok;
+
+    if (!ok || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    if (policy == ConfigFsyncPolicy::Directory) {
+        const size_t slash = path.rfind('/');
+        const std::string dir = slash == std::string::npos ? "." :
+                                (slash == 0 ? "/" : path.substr(0, slash));
+        const int dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+    }
+    return true;
+}
+
+inline bool writeConfigAtomically(const std::string& path, const std::vector<std::string>& lines,
+                                  ConfigFsyncPolicy policy) {
+    return writeConfigAtomically(path, joinConfigLines(lines), policy);
+}
+
+// Write-behind queue for config edits. Submitted batches are merged into
+// the pending one and applied by a single writer thread, one batch at a
+// time.
+class ConfigWriteQueue {
+  public:
+    // Applies a batch, called on the writer thread
+    using ApplyFn = std::function<void(const GestureEditBatch& batch)>;
+
+    explicit ConfigWriteQueue(ApplyFn apply) : apply(std::move(apply)) {}
+
+    ~ConfigWriteQueue() {
+        shutdown();
+    }
+
+    ConfigWriteQueue(const ConfigWriteQueue&) = delete;
+    ConfigWriteQueue& operator=(const ConfigWriteQueue&) = delete;
+
+    // Queue `batch` behind everything submitted before
+    void submit(GestureEditBatch batch) {
+        if (batch.empty()) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+
+        pending.merge(std::move(batch));
+        submitted++;
+
+        if (pending.empty()) {
+            // Everything cancelled out
+            if (!writing) {
+                completed = submitted;
+                idle.notify_all();
+            }
+            return;
+        }
+
+        if (!writer.joinable()) {
+            writer = std::thread([this]() { writerLoop(); });
+        }
+        wake.notify_all();
+    }
+
+    // Whether edits are queued or being written
+    bool busy() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !pending.empty() || writing;
+    }
+
+    // Wait until everything submitted so far is written
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        const uint64_t target = submitted;
+        idle.wait(lock, [this, target]() { return completed >= target || !writer.joinable(); });
+    }
+
+    // Write what is still pending and stop the writer
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (writer.joinable()) {
+            writer.join();
+        }
+    }
+
+    // Number of batches handed to the apply function
+    uint64_t writes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return writeCount;
+    }
+
+  private:
+    ApplyFn apply;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::thread writer;
+    GestureEditBatch pending;
+    bool writing = false;
+    bool stopping = false;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;   // Submissions covered by finished writes
+    uint64_t writeCount = 0;
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty()) {
+                completed = submitted;
+                idle.notify_all();
+                return;  // Stopping with nothing left
+            }
+
+            GestureEditBatch batch = std::move(pending);
+            pending = GestureEditBatch{};
+            const uint64_t covered = submitted;
+            writing = true;
+            lock.unlock();
+
+            try {
+                apply(batch);
+            } catch (...) {
+                // A failed write drops the batch, like a failed rename
+            }
+
+            lock.lock();
+            writing = false;
+            writeCount++;
+            completed = pending.empty() ? submitted : covered;
+            idle.notify_all();
+        }
+    }
+};
@@ -0,0 +1,442 @@
+#pragma once
+
+// Byte offsets of the mouse_gestures block in the config files, so edits
+// can go straight to the block instead of scanning every file line by
+// line each time record mode is left.
+//
+// Each file is indexed once. An inotify watch on the config directories
+// marks a file stale when something in it changes. It is re-indexed the
+// next time it's needed, and only if its size, mtime or inode actually
+// differ. Directories are watched rather than the files themselves
+// because editors, like our own writer, replace files by renaming.
+//
+// Without inotify every lookup checks the file with stat() instead.
+//
+// The cached index only decides which files to open. Writers index the
+// text they actually read again before splicing into it: inotify misses
+// edits made through a symlink's target, and a file can change between
+// the lookup and the read without changing size.
+
+#include "config_editor.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+struct ConfigSectionIndex {
+    static constexpr size_t npos = std::string_view::npos;
+
+    bool exists = false;
+    size_t size = 0;                // Bytes indexed
+    bool mentionsGestures = false;  // A mouse_gestures or gesture_action line
+    bool hasGestureLines = false;   // A gesture_action line
+
+    // From the comment lines above the first gesture_action line to the
+    // end of the last one, npos without gesture lines
+    size_t gestureLinesBegin = npos;
+    size_t gestureLinesEnd = npos;
+
+    // The mouse_gestures block: first byte after its opening line and
+    // first byte of its closing line, npos without a block
+    size_t bodyBegin = npos;
+    size_t bodyEnd = npos;
+    // First byte of the plugin block's closing line, npos without one
+    size_t pluginEnd = npos;
+
+    bool hasSection() const {
+        return bodyBegin != npos && bodyEnd != npos;
+    }
+};
+
+namespace config_index_detail {
+
+inline std::string_view trim(std::string_view line) {
+    const size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    return line.substr(start, line.find_last_not_of(" \t\r") - start + 1);
+}
+
+// Tracks the first `name {` block while walking the lines, counting
+// braces until it is closed
+struct BlockScanner {
+    std::string_view name;
+    bool inBlock = false;
+    bool done = false;
+    int braceDepth = 0;
+    size_t bodyBegin = std::string_view::npos;
+    size_t end = std::string_view::npos;
+
+    void line(std::string_view trimmed, size_t lineBegin, size_t nextLine) {
+        if (done) {
+            return;
+        }
+
+        if (!inBlock) {
+            if (trimmed.starts_with(name) && trimmed.find('{') != std::string_view::npos) {
+                inBlock = true;
+                braceDepth = 1;
+                bodyBegin = nextLine;
+            }
+            return;
+        }
+
+        for (char c : trimmed) {
+            if (c == '{') braceDepth++;
+            else if (c == '}') braceDepth--;
+        }
+        if (braceDepth == 0) {
+            end = lineBegin;
+            done = true;
+        }
+    }
+};
+
+} // namespace config_index_detail
+
+// Index `content` in one pass
+inline ConfigSectionIndex indexConfigText(std::string_view content) {
+    ConfigSectionIndex index;
+    index.exists = true;
+    index.size = content.size();
+    size_t commentsBegin = ConfigSectionIndex::npos;  // Run of '#' lines above
+
+    config_index_detail::BlockScanner section{.name = "mouse_gestures"};
+    config_index_detail::BlockScanner plugin{.name = "plugin"};
+
+    size_t lineBegin = 0;
+    while (lineBegin < content.size()) {
+        size_t lineEnd = content.find('\n', lineBegin);
+        const size_t nextLine = lineEnd == std::string_view::npos ? content.size() : lineEnd + 1;
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = content.size();
+        }
+
+        const std::string_view trimmed =
+            config_index_detail::trim(content.substr(lineBegin, lineEnd - lineBegin));
+
+        if (trimmed.find("gesture_action") != std::string_view::npos) {
+            index.mentionsGestures = true;
+            if (trimmed.starts_with("gesture_action")) {
+                if (!index.hasGestureLines) {
+                    index.gestureLinesBegin =
+                        commentsBegin != ConfigSectionIndex::npos ? commentsBegin : lineBegin;
+                }
+                index.hasGestureLines = true;
+                index.gestureLinesEnd = nextLine;
+            }
+        } else if (trimmed.find("mouse_gestures") != std::string_view::npos) {
+            index.mentionsGestures = true;
+        }
+
+        if (!trimmed.starts_with('#')) {
+            commentsBegin = ConfigSectionIndex::npos;
+        } else if (commentsBegin == ConfigSectionIndex::npos) {
+            commentsBegin = lineBegin;
+        }
+
+        section.line(trimmed, lineBegin, nextLine);
+        plugin.line(trimmed, lineBegin, nextLine);
+        lineBegin = nextLine;
+    }
+
+    if (section.done) {
+        index.bodyBegin = section.bodyBegin;
+        index.bodyEnd = section.end;
+    }
+    if (plugin.done) {
+        index.pluginEnd = plugin.end;
+    }
+    return index;
+}
+
+// Read all of `path` into `content`
+inline bool readConfigText(const std::string& path, std::string& content) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st{};
+    content.clear();
+    content.resize(fstat(fd, &st) == 0 && st.st_size > 0 ? static_cast<size_t>(st.st_size) : 0);
+
+    size_t total = 0;
+    bool ok = true;
+    while (true) {
+        if (total == content.size()) {
+            content.resize(content.size() + 4096);  // Grew since fstat()
+        }
+        const ssize_t result = read(fd, content.data() + total, content.size() - total);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            ok = result == 0;
+            break;
+        }
+        total += static_cast<size_t>(result);
+    }
+    close(fd);
+    content.resize(total);
+    return ok;
+}
+
+// Remove the gesture lines of `strokes` from `content`, only looking at
+// the indexed gesture lines. `index` is kept up to date. Returns the number
+// of gestures removed.
+inline size_t deleteIndexedGestures(std::string& content, ConfigSectionIndex& index,
+                                    const std::vector<std::string>& strokes) {
+    if (!index.hasGestureLines || strokes.empty()) {
+        return 0;
+    }
+
+    const size_t begin = index.gestureLinesBegin;
+    const size_t end = std::min(index.gestureLinesEnd, content.size());
+    std::vector<std::string> lines = splitConfigLines(std::string_view(content).substr(begin, end - begin));
+    const size_t removed = deleteGestureLines(lines, strokes);
+    if (removed == 0) {
+        return 0;
+    }
+
+    std::string replacement = joinConfigLines(lines);
+    if (end == content.size() && !content.ends_with('\n') && replacement.ends_with('\n')) {
+        replacement.pop_back();
+    }
+    content.replace(begin, end - begin, replacement);
+
+    // Offsets past the edited range move; anything inside it needs a rescan
+    const size_t shrunk = (end - begin) - replacement.size();
+    bool rescan = false;
+    for (size_t* offset : {&index.bodyBegin, &index.bodyEnd, &index.pluginEnd}) {
+        if (*offset == ConfigSectionIndex::npos || *offset <= begin) {
+            continue;
+        }
+        if (*offset < end) {
+            rescan = true;
+        } else {
+            *offset -= shrunk;
+        }
+    }
+
+    if (rescan) {
+        index = indexConfigText(content);
+    } else {
+        index.size = content.size();
+        index.gestureLinesEnd = begin + replacement.size();
+    }
+    return removed;
+}
+
+// Add `gestureLines` (already indented for the mouse_gestures block) to
+// `content`: at the end of the mouse_gestures block, in a new one at the
+// end of the plugin block, or in a new plugin block appended to the file.
+// `index` is stale afterwards.
+inline void insertIndexedGestures(std::string& content, const ConfigSectionIndex& index,
+                                  const std::vector<std::string>& gestureLines) {
+    if (gestureLines.empty()) {
+        return;
+    }
+
+    const std::string text = joinConfigLines(gestureLines);
+    if (index.hasSection()) {
+        content.insert(index.bodyEnd, text);
+        return;
+    }
+
+    if (index.pluginEnd != ConfigSectionIndex::npos) {
+        content.insert(index.pluginEnd, "\n  mouse_gestures {\n" + text + "  }\n");
+        return;
+    }
+
+    if (!content.empty() && !content.ends_with('\n')) {
+        content += '\n';
+    }
+    content += "\nplugin {\n  mouse_gestures {\n" + text + "  }\n}\n";
+}
+
+// Cached indexes of a fixed list of config files
+class ConfigFileIndex {
+  public:
+    explicit ConfigFileIndex(std::vector<std::string> paths) {
+        entries.reserve(paths.size());
+        for (auto& path : paths) {
+            Entry entry;
+            const size_t slash = path.rfind('/');
+            entry.dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+            entry.name = slash == std::string::npos ? path : path.substr(slash + 1);
+            entry.path = std::move(path);
+            entries.push_back(std::move(entry));
+        }
+
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0) {
+            return;
+        }
+
+        constexpr uint32_t MASK = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE |
+                                  IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF |
+                                  IN_MOVE_SELF | IN_ATTRIB;
+        for (auto& entry : entries) {
+            // A missing directory can't be watched; such files are checked
+            // with stat() on every lookup
+            entry.wd = inotify_add_watch(inotifyFd, entry.dir.c_str(), MASK);
+        }
+    }
+
+    ~ConfigFileIndex() {
+        if (inotifyFd >= 0) {
+            close(inotifyFd);
+        }
+    }
+
+    ConfigFileIndex(const ConfigFileIndex&) = delete;
+    ConfigFileIndex& operator=(const ConfigFileIndex&) = delete;
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    const std::string& path(size_t i) const {
+        return entries[i].path;
+    }
+
+    // The index of file `i`, re-indexed first if it changed on disk
+    ConfigSectionIndex get(size_t i) {
+        std::lock_guard<std::mutex> lock(mutex);
+        drainEvents();
+
+        Entry& entry = entries[i];
+        if (entry.indexed && !entry.stale && entry.wd >= 0) {
+            return entry.index;
+        }
+
+        const FileIdentity identity = FileIdentity::of(entry.path);
+        if (!entry.indexed || identity != entry.identity) {
+            reindex(entry, identity);
+        }
+        entry.stale = false;
+        return entry.index;
+    }
+
+    // Record `content` as the new contents of file `i` after writing it
+    // ourselves, which saves reading it back
+    void update(size_t i, std::string_view content) {
+        std::lock_guard<std::mutex> lock(mutex);
+        drainEvents();
+
+        Entry& entry = entries[i];
+        entry.identity = FileIdentity::of(entry.path);
+        entry.index = entry.identity.exists ? indexConfigText(content) : ConfigSectionIndex{};
+        entry.indexed = true;
+        entry.stale = false;
+    }
+
+    // Whether changes are picked up through inotify
+    bool watching() const {
+        return inotifyFd >= 0;
+    }
+
+    // Number of times a file was read to index it
+    uint64_t reindexCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reindexes;
+    }
+
+  private:
+    // What tells a changed file apart without reading it
+    struct FileIdentity {
+        bool exists = false;
+        dev_t dev = 0;
+        ino_t ino = 0;
+        off_t size = 0;
+        int64_t mtimeNs = 0;
+
+        static FileIdentity of(const std::string& path) {
+            struct stat st{};
+            if (stat(path.c_str(), &st) != 0) {
+                return {};
+            }
+            return {true, st.st_dev, st.st_ino, st.st_size,
+                    static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec};
+        }
+
+        bool operator==(const FileIdentity&) const = default;
+    };
+
+    struct Entry {
+        std::string path;
+        std::string dir;
+        std::string name;
+        int wd = -1;
+        bool indexed = false;
+        bool stale = true;
+        FileIdentity identity;
+        ConfigSectionIndex index;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    int inotifyFd = -1;
+    uint64_t reindexes = 0;
+
+    void reindex(Entry& entry, const FileIdentity& identity) {
+        entry.identity = identity;
+        entry.indexed = true;
+        entry.index = ConfigSectionIndex{};
+        if (!identity.exists) {
+            return;
+        }
+
+        std::string content;
+        if (!readConfigText(entry.path, content)) {
+            return;
+        }
+
+        entry.index = indexConfigText(content);
+        reindexes++;
+    }
+
+    // Mark the files named in pending inotify events stale
+    void drainEvents() {
+        if (inotifyFd < 0) {
+            return;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                return;
+            }
+
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                const std::string_view name = event->len > 0 ? std::string_view(event->name) : "";
+                for (auto& entry : entries) {
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        entry.stale = true;
+                    } else if (event->wd == entry.wd) {
+                        if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+                            entry.wd = -1;  // Directory gone, fall back to stat()
+                            entry.stale = true;
+                        } else if (name == entry.name) {
+                            entry.stale = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
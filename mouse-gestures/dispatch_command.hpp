@@ -0,0 +1,107 @@
+#pragma once
+
+// Recognizes gesture commands that do nothing but run
+// `hyprctl dispatch <dispatcher> [args]`, so they can be invoked in
+// process instead of through a shell, a hyprctl process and the socket.
+//
+// Only plain words and simple quoting are accepted. Anything a shell
+// would expand or that does more than one thing (variables, globs,
+// redirections, pipes, command lists, escapes, other hyprctl flags) is
+// left to the shell.
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct DispatchCommand {
+    std::string dispatcher;
+    std::string arg;
+};
+
+namespace dispatch_command_detail {
+
+// Split `command` into words like sh would, or nullopt if it uses
+// anything beyond whitespace, single and double quotes
+inline std::optional<std::vector<std::string>> splitWords(std::string_view command) {
+    std::vector<std::string> words;
+    std::string word;
+    bool inWord = false;
+
+    for (size_t i = 0; i < command.size(); i++) {
+        const char c = command[i];
+
+        if (c == ' ' || c == '\t') {
+            if (inWord) {
+                words.push_back(std::move(word));
+                word.clear();
+                inWord = false;
+            }
+            continue;
+        }
+
+        if (c == '\'' || c == '"') {
+            const size_t close = command.find(c, i + 1);
+            if (close == std::string_view::npos) {
+                return std::nullopt;
+            }
+
+            const std::string_view quoted = command.substr(i + 1, close - i - 1);
+            if (c == '"' && quoted.find_first_of("$`\\!") != std::string_view::npos) {
+                return std::nullopt;
+            }
+
+            word += quoted;
+            inWord = true;
+            i = close;
+            continue;
+        }
+
+        // Expansions, redirections, lists, subshells, escapes, comments
+        // and globs
+        if (std::string_view("$`\\;&|<>(){}*?[]~#!\n\r").find(c) != std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        word += c;
+        inWord = true;
+    }
+
+    if (inWord) {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+} // namespace dispatch_command_detail
+
+// The dispatcher and argument `command` would run, or nullopt if it isn't
+// a plain `hyprctl dispatch` call. Like hyprctl, the words after the
+// dispatcher name are joined with single spaces.
+inline std::optional<DispatchCommand> parseDispatchCommand(std::string_view command) {
+    const auto words = dispatch_command_detail::splitWords(command);
+    if (!words || words->size() < 3) {
+        return std::nullopt;
+    }
+
+    const std::string& program = (*words)[0];
+    const bool isHyprctl = program == "hyprctl" ||
+        (program.size() > 8 && program.ends_with("/hyprctl"));
+    if (!isHyprctl || (*words)[1] != "dispatch") {
+        return std::nullopt;
+    }
+
+    DispatchCommand result;
+    result.dispatcher = (*words)[2];
+    if (result.dispatcher.empty() || result.dispatcher.front() == '-') {
+        return std::nullopt;
+    }
+
+    for (size_t i = 3; i < words->size(); i++) {
+        if (i > 3) {
+            result.arg += ' ';
+        }
+        result.arg += (*words)[i];
+    }
+    return result;
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+// On-disk cache of finished gesture templates.
+//
+// Every gesture_action stroke is parsed and normalized on each config
+// reload. The cache stores the finished points and features of each
+// stroke, keyed by the exact stroke text and resample count, so unchanged
+// gestures are restored with a memcpy. The file is mmap'ed read-only and
+// rewritten atomically (tmp + rename), so an open mapping stays valid.
+//
+// Layout: Header, Entry[entryCount] sorted by key, then per entry
+// StrokeFeatures, Point[pointCount] and the stroke text, 8-byte aligned.
+
+#include "stroke.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+class GestureCache {
+  public:
+    static constexpr uint32_t MAGIC = 0x4347474d;  // "MGGC"
+    // Bump whenever Stroke::finish or computeFeatures change their output
+    static constexpr uint32_t VERSION = 2;
+
+    // A finished stroke to store
+    struct Record {
+        std::string_view strokeData;
+        int resampleCount;
+        const Stroke* pattern;
+    };
+
+    GestureCache() = default;
+    ~GestureCache() {
+        close();
+    }
+
+    GestureCache(const GestureCache&) = delete;
+    GestureCache& operator=(const GestureCache&) = delete;
+
+    // 64-bit FNV-1a of the stroke text
+    static uint64_t hash(std::string_view data) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : data) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // $XDG_CACHE_HOME/hyprland-plugins/mouse-gestures.cache, falling back
+    // to ~/.cache. Empty if neither is known.
+    static std::string defaultPath() {
+        std::string base;
+        const char* xdgCache = std::getenv("XDG_CACHE_HOME");
+        if (xdgCache && xdgCache[0] == '/') {
+            base = xdgCache;
+        } else {
+            const char* home = std::getenv("HOME");
+            if (!home || !home[0]) {
+                return "";
+            }
+            base = std::string(home) + "/.cache";
+        }
+        return base + "/hyprland-plugins/mouse-gestures.cache";
+    }
+
+    // Map a cache file. A missing or invalid file leaves the cache empty.
+    bool open(const std::string& path) {
+        close();
+
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+            ::close(fd);
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+
+        data = static_cast<const unsigned char*>(mapped);
+        dataSize = st.st_size;
+
+        if (!validate()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (data) {
+            munmap(const_cast<unsigned char*>(data), dataSize);
+        }
+        data = nullptr;
+        dataSize = 0;
+        entries = nullptr;
+        entryCount = 0;
+    }
+
+    bool isOpen() const {
+        return data != nullptr;
+    }
+
+    size_t size() const {
+        return entryCount;
+    }
+
+    // Restore the finished stroke for `strokeData`, false on a miss
+    bool lookup(std::string_view strokeData, int resampleCount, Stroke& out) const {
+        if (!entries) {
+            return false;
+        }
+
+        const Key key{hash(strokeData), static_cast<uint32_t>(strokeData.size()), resampleCount};
+        const Entry* end = entries + entryCount;
+        const Entry* it = std::lower_bound(entries, end, key, [](const Entry& entry, const Key& k) {
+            return keyOf(entry) < k;
+        });
+
+        for (; it != end && keyOf(*it) == key; ++it) {
+            const unsigned char* payload = data + it->offset;
+            const unsigned char* text = payload + sizeof(StrokeFeatures) + it->pointCount * sizeof(Point);
+            if (std::memcmp(text, strokeData.data(), strokeData.size()) != 0) {
+                continue;
+            }
+
+            StrokeFeatures features;
+            std::memcpy(&features, payload, sizeof(StrokeFeatures));
+
+            std::vector<Point> points(it->pointCount);
+            std::memcpy(points.data(), payload + sizeof(StrokeFeatures), it->pointCount * sizeof(Point));
+
+            out = Stroke::restoreFinished(std::move(points), features);
+            return out.isFinished();
+        }
+        return false;
+    }
+
+    // Write `records` to `path` atomically. Unfinished strokes are skipped,
+    // duplicates are stored once.
+    static bool write(const std::string& path, std::vector<Record> records) {
+        records.erase(std::remove_if(records.begin(), records.end(), [](const Record& r) {
+            return !r.pattern || !r.pattern->isFinished() || r.pattern->size() < 2;
+        }), records.end());
+
+        auto recordKey = [](const Record& r) {
+            return Key{hash(r.strokeData), static_cast<uint32_t>(r.strokeData.size()), r.resampleCount};
+        };
+        std::sort(records.begin(), records.end(), [&](const Record& a, const Record& b) {
+            const Key keyA = recordKey(a);
+            const Key keyB = recordKey(b);
+            if (keyA == keyB) {
+                return a.strokeData < b.strokeData;
+            }
+            return keyA < keyB;
+        });
+        records.erase(std::unique(records.begin(), records.end(), [](const Record& a, const Record& b) {
+            return a.strokeData == b.strokeData && a.resampleCount == b.resampleCount;
+        }), records.end());
+
+        Header header{MAGIC, VERSION, sizeof(Point), sizeof(StrokeFeatures), records.size(), 0};
+
+        std::vector<Entry> table;
+        table.reserve(records.size());
+        uint64_t offset = align(sizeof(Header) + records.size() * sizeof(Entry));
+        for (const auto& r : records) {
+            const Key key = recordKey(r);
+            const uint32_t pointCount = static_cast<uint32_t>(r.pattern->size());
+            table.push_back({key.hash, key.length, key.resampleCount, pointCount, 0, offset});
+            offset = align(offset + payloadSize(pointCount, key.length));
+        }
+        header.fileSize = offset;
+
+        // Create the cache directory on first use
+        const size_t slash = path.rfind('/');
+        if (slash != std::string::npos && slash > 0) {
+            makeDirectories(path.substr(0, slash));
+        }
+
+        const std::string tempPath = path + ".tmp";
+        FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        if (!table.empty()) {
+            ok = ok && std::fwrite(table.data(), sizeof(Entry), table.size(), file) == table.size();
+        }
+
+        for (size_t i = 0; ok && i < records.size(); i++) {
+            ok = pad(file, table[i].offset);
+            const Stroke& pattern = *records[i].pattern;
+            StrokeFeatures features;
+            copyZeroPadded(pattern.getFeatures(), features);
+            ok = ok && std::fwrite(&features, sizeof(features), 1, file) == 1;
+            ok = ok && std::fwrite(pattern.getPoints().data(), sizeof(Point), pattern.size(), file) == pattern.size();
+            ok = ok && std::fwrite(records[i].strokeData.data(), 1, records[i].strokeData.size(), file) ==
+                           records[i].strokeData.size();
+        }
+        ok = ok && pad(file, header.fileSize);
+
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+  private:
+    static_assert(std::is_trivially_copyable_v<Point>);
+    static_assert(std::is_trivially_copyable_v<StrokeFeatures>);
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t pointSize;
+        uint32_t featuresSize;
+        uint64_t entryCount;
+        uint64_t fileSize;
+    };
+
+    struct Entry {
+        uint64_t hash;
+        uint32_t length;         // Length of the stroke text
+        int32_t resampleCount;
+        uint32_t pointCount;
+        uint32_t reserved = 0;   // Explicit padding, so no indeterminate bytes are written
+        uint64_t offset;         // Payload offset from the start of the file
+    };
+
+    static_assert(std::has_unique_object_representations_v<Header>);
+    static_assert(std::has_unique_object_representations_v<Entry>);
+
+    // Copy `features` member by member into zeroed memory, so its padding
+    // bytes are written as zeros. Needs updating with StrokeFeatures.
+    static void copyZeroPadded(const StrokeFeatures& features, StrokeFeatures& out) {
+        std::memset(static_cast<void*>(&out), 0, sizeof(out));
+        out.startDir = features.startDir;
+        out.endDir = features.endDir;
+        out.aspect = features.aspect;
+        out.histogram = features.histogram;
+        out.turns = features.turns;
+    }
+
+    struct Key {
+        uint64_t hash;
+        uint32_t length;
+        int32_t resampleCount;
+
+        bool operator<(const Key& other) const {
+            return std::tie(hash, length, resampleCount) <
+                   std::tie(other.hash, other.length, other.resampleCount);
+        }
+        bool operator==(const Key& other) const {
+            return hash == other.hash && length == other.length &&
+                   resampleCount == other.resampleCount;
+        }
+    };
+
+    const unsigned char* data = nullptr;
+    size_t dataSize = 0;
+    const Entry* entries = nullptr;
+    size_t entryCount = 0;
+
+    static Key keyOf(const Entry& entry) {
+        return {entry.hash, entry.length, entry.resampleCount};
+    }
+
+    static uint64_t align(uint64_t offset) {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    static uint64_t payloadSize(uint64_t pointCount, uint64_t length) {
+        return sizeof(StrokeFeatures) + pointCount * sizeof(Point) + length;
+    }
+
+    static bool pad(FILE* file, uint64_t offset) {
+        const long position = std::ftell(file);
+        if (position < 0 || static_cast<uint64_t>(position) > offset) {
+            return false;
+        }
+        for (uint64_t i = position; i < offset; i++) {
+            if (std::fputc(0, file) == EOF) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void makeDirectories(const std::string& dir) {
+        for (size_t pos = 1; pos <= dir.size(); pos++) {
+            if (pos == dir.size() || dir[pos] == '/') {
+                mkdir(dir.substr(0, pos).c_str(), 0755);
+            }
+        }
+    }
+
+    // Check the header and that every entry lies inside the file, so
+    // lookups never read out of bounds even from a truncated file
+    bool validate() {
+        Header header;
+        std::memcpy(&header, data, sizeof(Header));
+        if (header.magic != MAGIC || header.version != VERSION ||
+            header.pointSize != sizeof(Point) || header.featuresSize != sizeof(StrokeFeatures) ||
+            header.fileSize != dataSize) {
+            return false;
+        }
+
+        const uint64_t tableEnd = sizeof(Header) + header.entryCount * sizeof(Entry);
+        if (header.entryCount > dataSize / sizeof(Entry) || tableEnd > dataSize) {
+            return false;
+        }
+
+        entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+        entryCount = header.entryCount;
+
+        for (size_t i = 0; i < entryCount; i++) {
+            const Entry& entry = entries[i];
+            if (entry.pointCount < 2 || entry.pointCount > dataSize / sizeof(Point) ||
+                entry.offset % 8 != 0 || entry.offset < tableEnd ||
+                entry.offset > dataSize ||
+                payloadSize(entry.pointCount, entry.length) > dataSize - entry.offset) {
+                return false;
+            }
+            if (i > 0 && keyOf(entry) < keyOf(entries[i - 1])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
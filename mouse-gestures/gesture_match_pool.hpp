@@ -0,0 +1,192 @@
+#pragma once
+
+#include "gesture_matcher.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Small worker pool that matches a stroke against a gesture library off
+// the compositor thread. The candidate list of a request is split across
+// the workers, which share the best cost found so far as DP bound.
+class GestureMatchPool {
+  public:
+    // Returns the pattern of template `index`
+    using PatternFn = std::function<const Stroke&(int index)>;
+    // Receives the final result, called on a worker thread
+    using DoneFn = std::function<void(const GestureMatch& match)>;
+
+    explicit GestureMatchPool(size_t threadCount) {
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~GestureMatchPool() {
+        shutdown();
+    }
+
+    GestureMatchPool(const GestureMatchPool&) = delete;
+    GestureMatchPool& operator=(const GestureMatchPool&) = delete;
+
+    size_t threadCount() const {
+        return workers.size();
+    }
+
+    // Queue a match of `input` against the templates in `index`.
+    // `keepAlive` must own `index` and everything `pattern` refers to; it
+    // is released once the request completes. Template `hint`, if any,
+    // is evaluated first. Returns false after shutdown, in which case
+    // `onDone` is never called.
+    bool submit(std::shared_ptr<const void> keepAlive, Stroke input,
+                const GestureFeatureIndex& index, PatternFn pattern,
+                double maxFeatureDistance, double threshold, DoneFn onDone,
+                int hint = -1) {
+        auto request = std::make_shared<Request>();
+        request->keepAlive = std::move(keepAlive);
+        request->input = std::move(input);
+        request->pattern = std::move(pattern);
+        request->onDone = std::move(onDone);
+        request->bestCost.store(threshold);
+        request->filtered = index.candidates(request->input.getFeatures(),
+                                             maxFeatureDistance, request->candidates);
+        promoteCandidate(request->candidates, hint);
+
+        // No more slices than candidates, but always at least one so
+        // that onDone fires for an empty library too
+        const size_t slices = std::clamp<size_t>(request->candidates.size(), 1, workers.size());
+        request->remaining.store(static_cast<int>(slices));
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (stopping) {
+                return false;
+            }
+            for (size_t slice = 0; slice < slices; slice++) {
+                tasks.push_back({request, slice, slices});
+            }
+        }
+        queueCondition.notify_all();
+        return true;
+    }
+
+    // Finish queued work and join the workers. Safe to call twice.
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCondition.notify_all();
+        for (auto& worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+  private:
+    struct Request {
+        std::shared_ptr<const void> keepAlive;
+        Stroke input;
+        PatternFn pattern;
+        DoneFn onDone;
+        std::vector<std::pair<double, int>> candidates;
+        size_t filtered = 0;
+
+        std::atomic<double> bestCost{STROKE_INFINITY};
+        std::atomic<size_t> evaluated{0};
+        std::atomic<int> remaining{0};
+
+        std::mutex resultMutex;
+        int bestIndex = -1;
+    };
+
+    struct Task {
+        std::shared_ptr<Request> request;
+        size_t slice;
+        size_t stride;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<Task> tasks;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping = false;
+
+    void workerLoop() {
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+
+            try {
+                runSlice(task);
+            } catch (...) {
+                // A failed slice still has to count as finished below
+            }
+
+            if (task.request->remaining.fetch_sub(1) == 1) {
+                finish(*task.request);
+            }
+        }
+    }
+
+    // Candidates are sorted nearest first, so interleaving the slices
+    // gives every worker a share of the likely winners
+    static void runSlice(const Task& task) {
+        Request& request = *task.request;
+        for (size_t c = task.slice; c < request.candidates.size(); c += task.stride) {
+            const int index = request.candidates[c].second;
+            const Stroke& pattern = request.pattern(index);
+            if (!pattern.isFinished()) {
+                continue;
+            }
+            request.evaluated++;
+
+            const double bound = request.bestCost.load();
+            const double cost = request.input.compare(pattern, bound);
+            if (cost >= bound) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(request.resultMutex);
+            if (cost < request.bestCost.load()) {
+                request.bestCost.store(cost);
+                request.bestIndex = index;
+            }
+        }
+    }
+
+    static void finish(Request& request) {
+        GestureMatch match;
+        {
+            std::lock_guard<std::mutex> lock(request.resultMutex);
+            match.index = request.bestIndex;
+            match.cost = request.bestIndex >= 0 ? request.bestCost.load() : STROKE_INFINITY;
+        }
+        match.evaluated = request.evaluated.load();
+        match.filtered = request.filtered;
+
+        try {
+            if (request.onDone) {
+                request.onDone(match);
+            }
+        } catch (...) {
+            // Never let a callback take down a worker
+        }
+    }
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "stroke.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Result of matching an input stroke against a gesture library
+struct GestureMatch {
+    int index = -1;                  // Index of the best template, -1 if none
+    double cost = STROKE_INFINITY;   // Cost of the best template
+    size_t evaluated = 0;            // Templates that went through the DP
+    size_t filtered = 0;             // Templates rejected by the feature prefilter
+};
+
+// Find the template that best matches `input` with a cost below `threshold`.
+//
+// The input stroke is finished once by the caller and shared by every
+// comparison. Each DP run is bounded by the best cost found so far, so
+// templates that cannot beat the current winner are abandoned early.
+// DP buffers come from the calling thread's compare workspace, so
+// repeated matching does not allocate once it has warmed up.
+//
+// `toStroke` projects an element of `templates` to its Stroke pattern.
+template <typename Container, typename Projection>
+GestureMatch findBestStrokeMatch(const Stroke& input, const Container& templates,
+                                 double threshold, Projection toStroke) {
+    GestureMatch match;
+    match.cost = threshold;
+
+    if (!input.isFinished()) {
+        return match;
+    }
+
+    int index = 0;
+    for (const auto& entry : templates) {
+        const Stroke& pattern = toStroke(entry);
+
+        if (pattern.isFinished()) {
+            match.evaluated++;
+
+            const double cost = input.compare(pattern, match.cost);
+            if (cost < match.cost) {
+                match.cost = cost;
+                match.index = index;
+            }
+        }
+        index++;
+    }
+
+    if (match.index < 0) {
+        match.cost = STROKE_INFINITY;
+    }
+
+    return match;
+}
+
+// Feature signatures of every template in a gesture library, stored
+// contiguously so they can be scanned much faster than running the DP.
+// The owner rebuilds it whenever the library changes.
+class GestureFeatureIndex {
+  public:
+    template <typename Container, typename Projection>
+    void rebuild(const Container& templates, Projection toStroke) {
+        entries.clear();
+        for (const auto& entry : templates) {
+            const Stroke& pattern = toStroke(entry);
+            entries.push_back({pattern.getFeatures(), pattern.isFinished()});
+        }
+        valid = true;
+    }
+
+    void invalidate() {
+        valid = false;
+    }
+
+    bool isValidFor(size_t librarySize) const {
+        return valid && entries.size() == librarySize;
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    // Collect finished templates within `maxDistance` of `features`,
+    // nearest first. A maxDistance <= 0 keeps every template.
+    // Returns the number of templates rejected by the distance cut.
+    size_t candidates(const StrokeFeatures& features, double maxDistance,
+                      std::vector<std::pair<double, int>>& out) const {
+        out.clear();
+        size_t rejected = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (!entries[i].finished) {
+                continue;
+            }
+            const double distance = StrokeFeatures::distance(features, entries[i].features);
+            if (maxDistance > 0.0 && distance > maxDistance) {
+                rejected++;
+                continue;
+            }
+            out.emplace_back(distance, static_cast<int>(i));
+        }
+        std::sort(out.begin(), out.end());
+        return rejected;
+    }
+
+  private:
+    struct Entry {
+        StrokeFeatures features;
+        bool finished;
+    };
+
+    std::vector<Entry> entries;
+    bool valid = false;
+};
+
+// Move template `hint` to the front of `candidates`, if it is there
+inline void promoteCandidate(std::vector<std::pair<double, int>>& candidates, int hint) {
+    if (hint < 0) {
+        return;
+    }
+
+    auto it = std::find_if(candidates.begin(), candidates.end(),
+                           [hint](const auto& candidate) { return candidate.second == hint; });
+    if (it != candidates.end()) {
+        std::rotate(candidates.begin(), it, it + 1);
+    }
+}
+
+// Indexed variant of findBestStrokeMatch. Only templates within
+// `maxFeatureDistance` reach the DP, and they are evaluated nearest
+// first so the DP bound tightens as early as possible. A likely winner
+// known up front, such as a live prediction, can be passed as `hint`
+// to be evaluated before everything else.
+// `index` must have been rebuilt for `templates`.
+template <typename Container, typename Projection>
+GestureMatch findBestStrokeMatch(const Stroke& input, const Container& templates,
+                                 const GestureFeatureIndex& index,
+                                 double maxFeatureDistance, double threshold,
+                                 Projection toStroke, int hint = -1) {
+    GestureMatch match;
+    match.cost = threshold;
+
+    if (!input.isFinished()) {
+        return match;
+    }
+
+    static thread_local std::vector<std::pair<double, int>> candidates;
+    match.filtered = index.candidates(input.getFeatures(), maxFeatureDistance, candidates);
+    promoteCandidate(candidates, hint);
+
+    for (const auto& [distance, i] : candidates) {
+        if (static_cast<size_t>(i) >= templates.size()) {
+            continue;
+        }
+
+        const Stroke& pattern = toStroke(templates[i]);
+        if (!pattern.isFinished()) {
+            continue;
+        }
+        match.evaluated++;
+
+        const double cost = input.compare(pattern, match.cost);
+        if (cost < match.cost) {
+            match.cost = cost;
+            match.index = i;
+        }
+    }
+
+    if (match.index < 0) {
+        match.cost = STROKE_INFINITY;
+    }
+
+    return match;
+}
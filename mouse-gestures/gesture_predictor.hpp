@@ -0,0 +1,102 @@
+#pragma once
+
+#include "gesture_matcher.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Bookkeeping for speculative matches of the stroke drawn so far.
+//
+// While the drag button is held, the stroke-so-far is matched in the
+// background every few new points. The best candidate answers "what
+// would fire if the button was released now", which the overlay shows
+// as a live prediction. At release, a prediction that already covers
+// every point is the final answer; otherwise its template is evaluated
+// first so the final DP runs start with a tight bound.
+//
+// Owned by the event loop thread, workers only hand results back to it.
+// `library` tags identify the gesture library a prediction was made
+// against and are only compared, never dereferenced.
+class GesturePredictor {
+  public:
+    // New points needed before the next speculative match
+    static constexpr size_t DEFAULT_INTERVAL = 8;
+
+    explicit GesturePredictor(size_t interval = DEFAULT_INTERVAL) : interval(interval) {}
+
+    // Start tracking a new stroke, results of older strokes are dropped
+    void begin() {
+        sequence++;
+        inFlight = false;
+        submittedSize = 0;
+        best = GestureMatch{};
+        bestSize = 0;
+        bestLibrary = nullptr;
+    }
+
+    uint64_t currentSequence() const {
+        return sequence;
+    }
+
+    // Whether the stroke-so-far of `pathSize` points should be matched
+    bool shouldSpeculate(size_t pathSize) const {
+        return !inFlight && pathSize >= 2 && pathSize >= submittedSize + interval;
+    }
+
+    void submitted(size_t pathSize) {
+        inFlight = true;
+        submittedSize = pathSize;
+    }
+
+    // A speculative match could not be started
+    void cancelled() {
+        inFlight = false;
+    }
+
+    // Record the result of a speculative match. Returns false if it
+    // belongs to an older stroke.
+    bool complete(uint64_t resultSequence, size_t pathSize, const GestureMatch& match,
+                  const void* library) {
+        if (resultSequence != sequence) {
+            return false;
+        }
+
+        inFlight = false;
+        if (pathSize >= bestSize) {
+            best = match;
+            bestSize = pathSize;
+            bestLibrary = library;
+        }
+        return true;
+    }
+
+    // Best candidate for the stroke so far, index -1 if none
+    const GestureMatch& candidate() const {
+        return best;
+    }
+
+    // Number of points the current candidate was matched with
+    size_t candidateSize() const {
+        return bestSize;
+    }
+
+    // Whether the candidate already is the answer for a final stroke of
+    // `pathSize` points matched against `library`
+    bool coversStroke(size_t pathSize, const void* library) const {
+        return bestSize > 0 && bestSize == pathSize && bestLibrary == library;
+    }
+
+    // Template to evaluate first when matching against `library`, -1 if none
+    int hint(const void* library) const {
+        return bestLibrary == library ? best.index : -1;
+    }
+
+  private:
+    size_t interval;
+    uint64_t sequence = 0;
+    bool inFlight = false;
+    size_t submittedSize = 0;
+
+    GestureMatch best;
+    size_t bestSize = 0;
+    const void* bestLibrary = nullptr;
+};
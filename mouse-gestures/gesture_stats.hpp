@@ -0,0 +1,269 @@
+#pragma once
+
+// Recognition statistics: how long it takes from button release to the
+// command being dispatched, and how much matching work that involved.
+//
+// Recording only touches relaxed atomics, so match workers and the event
+// loop record into the same histograms without locks. Readers take a
+// snapshot; concurrent updates may be missed by one sample, never torn.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Histogram with fixed log-linear buckets: values below 4 get their own
+// bucket, every power of two above is split into 4 sub-buckets, so a
+// percentile is within 25% of the true value.
+class StatsHistogram {
+  public:
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int MAX_EXPONENT = 32;  // Larger values land in the last bucket
+    static constexpr int BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - 1) * SUB_BUCKETS;
+
+    static int bucketFor(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<int>(value);
+        }
+        const int exponent = std::bit_width(value) - 1;  // >= 2
+        if (exponent >= MAX_EXPONENT + 1) {
+            return BUCKETS - 1;
+        }
+        const int sub = static_cast<int>((value >> (exponent - 2)) & (SUB_BUCKETS - 1));
+        return std::min(SUB_BUCKETS + (exponent - 2) * SUB_BUCKETS + sub, BUCKETS - 1);
+    }
+
+    // Smallest value of bucket `index`
+    static uint64_t bucketLower(int index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const int exponent = (index - SUB_BUCKETS) / SUB_BUCKETS + 2;
+        const uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        return (SUB_BUCKETS + sub) << (exponent - 2);
+    }
+
+    // One past the largest value of bucket `index`
+    static uint64_t bucketUpper(int index) {
+        if (index < SUB_BUCKETS) {
+            return index + 1;
+        }
+        const int exponent = (index - SUB_BUCKETS) / SUB_BUCKETS + 2;
+        return bucketLower(index) + (uint64_t(1) << (exponent - 2));
+    }
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        double mean() const {
+            return count ? static_cast<double>(sum) / count : 0.0;
+        }
+
+        // Value at quantile `q` in [0, 1], interpolated inside its bucket
+        double percentile(double q) const {
+            uint64_t total = 0;
+            for (uint64_t b : buckets) {
+                total += b;
+            }
+            if (total == 0) {
+                return 0.0;
+            }
+
+            const double rank = std::clamp(q, 0.0, 1.0) * total;
+            uint64_t seen = 0;
+            for (int i = 0; i < BUCKETS; i++) {
+                if (buckets[i] == 0) {
+                    continue;
+                }
+                if (seen + buckets[i] >= rank) {
+                    const double lower = static_cast<double>(bucketLower(i));
+                    const double upper = std::min(static_cast<double>(bucketUpper(i)),
+                                                  static_cast<double>(max) + 1.0);
+                    const double within = (rank - seen) / buckets[i];
+                    return std::max(lower, lower + (upper - lower) * within);
+                }
+                seen += buckets[i];
+            }
+            return static_cast<double>(max);
+        }
+    };
+
+    void record(uint64_t value) {
+        buckets[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t currentMax = max.load(std::memory_order_relaxed);
+        while (value > currentMax &&
+               !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    Snapshot snapshot() const {
+        Snapshot result;
+        for (int i = 0; i < BUCKETS; i++) {
+            result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+        result.count = count.load(std::memory_order_relaxed);
+        result.sum = sum.load(std::memory_order_relaxed);
+        result.max = max.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void reset() {
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+};
+
+struct GestureStats {
+    // Latencies in microseconds, measured from the button release
+    StatsHistogram strokeBuild;        // Path to finished stroke
+    StatsHistogram matching;           // Matcher run, including pool queueing
+    StatsHistogram releaseToDecision;  // Until the best match (or none) is known
+    StatsHistogram releaseToDispatch;  // Until the matched command is started
+
+    StatsHistogram templatesEvaluated; // DP runs per final match
+    StatsHistogram templatesFiltered;  // Prefilter rejections per final match
+
+    std::atomic<uint64_t> gestures{0};            // Final matches attempted
+    std::atomic<uint64_t> matched{0};
+    std::atomic<uint64_t> unmatched{0};
+    std::atomic<uint64_t> predictionHits{0};      // Answered by the live prediction
+    std::atomic<uint64_t> speculativeMatches{0};
+    std::atomic<uint64_t> directDispatches{0};    // Commands run without a process
+
+    static uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        return micros > 0 ? static_cast<uint64_t>(micros) : 0;
+    }
+
+    // Account a final match decision
+    void recordDecision(std::chrono::steady_clock::time_point releaseTime, bool found,
+                        size_t evaluated, size_t filtered) {
+        gestures.fetch_add(1, std::memory_order_relaxed);
+        (found ? matched : unmatched).fetch_add(1, std::memory_order_relaxed);
+        releaseToDecision.record(microsSince(releaseTime));
+        templatesEvaluated.record(evaluated);
+        templatesFiltered.record(filtered);
+    }
+
+    void reset() {
+        strokeBuild.reset();
+        matching.reset();
+        releaseToDecision.reset();
+        releaseToDispatch.reset();
+        templatesEvaluated.reset();
+        templatesFiltered.reset();
+        gestures.store(0, std::memory_order_relaxed);
+        matched.store(0, std::memory_order_relaxed);
+        unmatched.store(0, std::memory_order_relaxed);
+        predictionHits.store(0, std::memory_order_relaxed);
+        speculativeMatches.store(0, std::memory_order_relaxed);
+        directDispatches.store(0, std::memory_order_relaxed);
+    }
+
+    static void appendJsonString(std::string& out, std::string_view value) {
+        out += '"';
+        for (unsigned char c : value) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    } else {
+                        out += static_cast<char>(c);
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    // {"count":..,"mean":..,"p50":..,"p90":..,"p99":..,"max":..,"buckets":[[lower,upper,count],..]}
+    static void appendHistogramJson(std::string& out, const StatsHistogram::Snapshot& snapshot) {
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+                      "{\"count\":%llu,\"mean\":%.1f,\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%llu,\"buckets\":[",
+                      static_cast<unsigned long long>(snapshot.count), snapshot.mean(),
+                      snapshot.percentile(0.50), snapshot.percentile(0.90), snapshot.percentile(0.99),
+                      static_cast<unsigned long long>(snapshot.max));
+        out += buffer;
+
+        bool first = true;
+        for (int i = 0; i < StatsHistogram::BUCKETS; i++) {
+            if (snapshot.buckets[i] == 0) {
+                continue;
+            }
+            std::snprintf(buffer, sizeof(buffer), "%s[%llu,%llu,%llu]", first ? "" : ",",
+                          static_cast<unsigned long long>(StatsHistogram::bucketLower(i)),
+                          static_cast<unsigned long long>(StatsHistogram::bucketUpper(i)),
+                          static_cast<unsigned long long>(snapshot.buckets[i]));
+            out += buffer;
+            first = false;
+        }
+        out += "]}";
+    }
+
+    // Everything except per-gesture counts and command spawning stats,
+    // which the caller passes in as "per_gesture" and "commands"
+    std::string toJson(std::string_view perGestureJson = "[]",
+                       std::string_view commandsJson = "{}") const {
+        std::string out = "{";
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+                      "\"gestures\":%llu,\"matched\":%llu,\"unmatched\":%llu,"
+                      "\"prediction_hits\":%llu,\"speculative_matches\":%llu,"
+                      "\"direct_dispatches\":%llu,",
+                      static_cast<unsigned long long>(gestures.load(std::memory_order_relaxed)),
+                      static_cast<unsigned long long>(matched.load(std::memory_order_relaxed)),
+                      static_cast<unsigned long long>(unmatched.load(std::memory_order_relaxed)),
+                      static_cast<unsigned long long>(predictionHits.load(std::memory_order_relaxed)),
+                      static_cast<unsigned long long>(speculativeMatches.load(std::memory_order_relaxed)),
+                      static_cast<unsigned long long>(directDispatches.load(std::memory_order_relaxed)));
+        out += buffer;
+
+        out += "\"latency_us\":{\"stroke_build\":";
+        appendHistogramJson(out, strokeBuild.snapshot());
+        out += ",\"matching\":";
+        appendHistogramJson(out, matching.snapshot());
+        out += ",\"release_to_decision\":";
+        appendHistogramJson(out, releaseToDecision.snapshot());
+        out += ",\"release_to_dispatch\":";
+        appendHistogramJson(out, releaseToDispatch.snapshot());
+        out += "},\"templates_evaluated\":";
+        appendHistogramJson(out, templatesEvaluated.snapshot());
+        out += ",\"templates_filtered\":";
+        appendHistogramJson(out, templatesFiltered.snapshot());
+        out += ",\"commands\":";
+        out += commandsJson;
+        out += ",\"per_gesture\":";
+        out += perGestureJson;
+        out += "}";
+        return out;
+    }
+};
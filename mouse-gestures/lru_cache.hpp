@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// Map with a fixed number of entries; inserting into a full cache evicts
+// the least recently used entry. Lookups count as a use.
+//
+// Not thread safe.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+  public:
+    explicit LruCache(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    // Value for `key`, nullptr if not cached. The pointer is valid until
+    // the next insert or clear.
+    Value* find(const Key& key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
+    }
+
+    // Add or replace the value for `key`
+    Value& insert(const Key& key, Value value) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+
+        if (entries.size() >= capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+
+        entries.emplace_front(key, std::move(value));
+        index.emplace(key, entries.begin());
+        return entries.front().second;
+    }
+
+    bool contains(const Key& key) const {
+        return index.find(key) != index.end();
+    }
+
+    void clear() {
+        index.clear();
+        entries.clear();
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    size_t maxSize() const {
+        return capacity;
+    }
+
+  private:
+    using Entry = std::pair<Key, Value>;
+
+    size_t capacity;
+    std::list<Entry> entries;  // Most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+};
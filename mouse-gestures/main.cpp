@@ -2,18 +2,22 @@
 
 #include <any>
 #include <string>
+#include <fstream>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
-#include <fstream>
 #include <sstream>
 #include <chrono>
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <memory>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <wayland-server.h>
 #include <wayland-server-protocol.h>
 #include <linux/input-event-codes.h>
@@ -23,6 +27,7 @@
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/event/EventBus.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
+#include <hyprland/src/managers/KeybindManager.hpp>
 #include <hyprland/src/managers/SeatManager.hpp>
 #include <hyprland/src/devices/IPointer.hpp>
 #include <hyprland/src/render/Renderer.hpp>
@@ -37,21 +42,52 @@
 #undef private
 
 #include "stroke.hpp"
+#include "gesture_matcher.hpp"
+#include "gesture_match_pool.hpp"
+#include "gesture_predictor.hpp"
+#include "gesture_cache.hpp"
+#include "gesture_stats.hpp"
+#include "command_spawner.hpp"
+#include "dispatch_command.hpp"
+#include "config_editor.hpp"
+#include "config_index.hpp"
+#include "motion_buffer.hpp"
+#include "trail_buffer.hpp"
+#include "trail_damage.hpp"
+#include "record_hover.hpp"
+#include "record_list.hpp"
 #include "ascii_gesture.hpp"
+#include "background_image.hpp"
+#include "../common/pixel_format.hpp"
 #include "MouseGestureOverlay.hpp"
+#include "TrailBatchRenderer.hpp"
 
 using Render::GL::g_pHyprOpenGL;
 
 inline HANDLE PHANDLE = nullptr;
 
-// Global background texture shared across all monitors
-inline SP<Render::ITexture> g_pBackgroundTexture;
+// Background image of the record mode overlay, one texture per output
+// pixel size. Decoded and scaled by g_backgroundLoader, uploaded on the
+// event loop; g_backgroundGeneration is the load the textures belong to.
+std::unique_ptr<BackgroundLoader> g_backgroundLoader;
+wl_event_source* g_backgroundEventSource = nullptr;
+std::unordered_map<uint64_t, SP<Render::ITexture>> g_backgroundTextures;
+uint64_t g_backgroundGeneration = 0;
+std::string g_backgroundPath;
+int64_t g_backgroundMtime = 0;
+
+// Batched trail and thumbnail circles, owned by the overlay
+extern CTrailBatchRenderer g_trailBatchRenderer;
 
 // Gesture action configuration
 struct GestureAction {
     Stroke pattern;
     std::string command;
     std::string name;  // Optional name for display
+    std::string strokeData;  // Stroke as written in the config
+    int resampleCount = 0;   // Points the pattern was resampled to, 0 if raw
+    std::string dispatcher;  // Set if command is a plain "hyprctl dispatch"
+    std::string dispatchArg;
 };
 
 // Timestamped path point for trail rendering
@@ -66,7 +102,7 @@ struct MouseGestureState {
     Vector2D mouseDownPos = {0, 0};
     bool dragDetected = false;
     std::vector<Vector2D> path;  // For gesture matching
-    std::vector<PathPoint> timestampedPath;  // For trail rendering
+    TrailBuffer<PathPoint> timestampedPath;  // For trail rendering, oldest first
     std::chrono::steady_clock::time_point pressTime;
     uint32_t pressButton = 0;
     uint32_t pressTimeMs = 0;
@@ -84,20 +120,99 @@ struct MouseGestureState {
 
 MouseGestureState g_gestureState;
 std::vector<GestureAction> g_gestureActions;
+
+// Immutable copy of g_gestureActions shared with the match workers
+struct GestureLibrarySnapshot {
+    std::vector<GestureAction> actions;
+    GestureFeatureIndex index;
+};
+
+// Rebuilt lazily after g_gestureActions changes, null while stale
+std::shared_ptr<const GestureLibrarySnapshot> g_gestureLibrary;
+
+// Bumped on every change of g_gestureActions, for caches derived from it
+uint64_t g_gestureActionsGeneration = 0;
+
+// Call after modifying g_gestureActions
+static void invalidateGestureLibrary() {
+    g_gestureLibrary.reset();
+    g_gestureActionsGeneration++;
+}
+
+// Finished templates from the previous reload, opened lazily while the
+// config is parsed and closed once it is rewritten
+GestureCache g_gestureCache;
+bool g_gestureCacheOpened = false;
+size_t g_gestureCacheMisses = 0;
+
+// Result of a match run on g_matchPool
+struct MatchResult {
+    uint64_t sequence = 0;      // Predictor sequence of the matched stroke
+    size_t pathSize = 0;        // Path points the stroke was built from
+    bool speculative = false;   // Match of a stroke still being drawn
+    std::chrono::steady_clock::time_point releaseTime;  // Button release of a final match
+    GestureMatch match;
+    std::shared_ptr<const GestureLibrarySnapshot> library;
+};
+
+// Gesture matching runs on g_matchPool, results are handed back to the
+// event loop through g_matchEventFd
+std::unique_ptr<GestureMatchPool> g_matchPool;
+int g_matchEventFd = -1;
+wl_event_source* g_matchEventSource = nullptr;
+std::mutex g_matchResultsMutex;
+std::vector<MatchResult> g_matchResults;
+
+// Gesture commands are started by g_commandSpawner; exited launchers are
+// reaped when its pollFd() turns readable on the event loop
+std::unique_ptr<CommandSpawner> g_commandSpawner;
+wl_event_source* g_spawnerEventSource = nullptr;
+
+// Speculative matching of the stroke being drawn. g_predictionLibrary
+// keeps the library the prediction refers to alive.
+GesturePredictor g_gesturePredictor;
+std::shared_ptr<const GestureLibrarySnapshot> g_predictionLibrary;
+int g_livePredictionIndex = -1;  // Predicted entry of g_gestureActions, -1 if none
+
+// Recognition latency and work, recorded from the event loop and match
+// workers. Per-gesture counts are keyed by stroke text so they survive
+// config reloads and are only touched on the event loop.
+GestureStats g_gestureStats;
+std::unordered_map<std::string, uint64_t> g_gestureMatchCounts;
+// Pointer motion since the last frame, processed from the render hook
+struct MotionSample {
+    Vector2D pos;
+    std::chrono::steady_clock::time_point time;
+};
+MotionBuffer<MotionSample> g_pendingMotion;
+
+// Screen area of the trail, damaged instead of whole monitors
+TrailDamage g_trailDamage;
+
 bool g_recordMode = false;
 bool g_lastRecordMode = false;
 bool g_pluginShuttingDown = false;
 std::string g_configFilePath;
 Vector2D g_lastMousePos = {0, 0};
 
-// Synchronization for config file writes
-std::atomic<int> g_fileWriteCount{0};
+// Where the mouse_gestures block is in each config candidate, kept up to
+// date through inotify
+std::unique_ptr<ConfigFileIndex> g_configIndex;
+
+// Config file writes: gesture edits are applied on the writer thread of
+// g_configWriteQueue, g_fileWriteMutex serializes all config rewrites
+static void writeGestureEdits(const GestureEditBatch& batch);
 std::mutex g_fileWriteMutex;
+ConfigWriteQueue g_configWriteQueue{writeGestureEdits};
+std::atomic<ConfigFsyncPolicy> g_configFsyncPolicy{ConfigFsyncPolicy::File};
 
 // Scroll offset for gesture list in record mode (per-monitor)
 std::unordered_map<PHLMONITOR, float> g_scrollOffsets;
 std::unordered_map<PHLMONITOR, float> g_maxScrollOffsets;
 
+// Hover targets of the record mode UI as last drawn (per-monitor)
+std::unordered_map<PHLMONITOR, RecordHoverMap> g_recordHover;
+
 // Animation state for record mode entry (per-monitor)
 std::unordered_map<PHLMONITOR, PHLANIMVAR<Vector2D>> g_recordAnimSize;
 std::unordered_map<PHLMONITOR, PHLANIMVAR<Vector2D>> g_recordAnimPos;
@@ -120,14 +235,9 @@ CHyprSignalListener g_mouseMoveHook;
 CHyprSignalListener g_mouseAxisHook;
 CHyprSignalListener g_renderHook;
 
-// Helper function to check if there are any visible trail points
-static bool hasVisibleTrailPoints() {
-    if (g_gestureState.timestampedPath.empty()) {
-        return false;
-    }
-
+// Trail fade duration from config, -1 if unavailable
+static int getTrailFadeDurationMs() {
     try {
-        // Get trail fade duration from config
         static auto* const PFADEDURATION = (Hyprlang::INT* const*)
             HyprlandAPI::getConfigValue(
                 PHANDLE,
@@ -135,26 +245,97 @@ static bool hasVisibleTrailPoints() {
             )->getDataStaticPtr();
 
         if (!PFADEDURATION || !*PFADEDURATION) {
-            return false;
+            return -1;
         }
 
-        const int fadeDurationMs = **PFADEDURATION;
-        auto now = std::chrono::steady_clock::now();
+        return static_cast<int>(**PFADEDURATION);
+    } catch (...) {
+        return -1;
+    }
+}
 
-        // Check if any point is still visible (not fully faded)
-        for (const auto& point : g_gestureState.timestampedPath) {
-            auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - point.timestamp
-            ).count();
+// Drop trail points that have fully faded
+static void expireTrailPoints() {
+    const int fadeDurationMs = getTrailFadeDurationMs();
+    if (fadeDurationMs < 0) {
+        return;
+    }
 
-            if (age <= fadeDurationMs) {
-                return true;
-            }
+    g_gestureState.timestampedPath.expireBefore(
+        std::chrono::steady_clock::now() - std::chrono::milliseconds(fadeDurationMs));
+}
+
+// Radius of the trail circles from config
+static double getTrailCircleRadius() {
+    try {
+        static auto* const PCIRCLERADIUS = (Hyprlang::FLOAT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:drag_trail_circle_radius"
+            )->getDataStaticPtr();
+
+        if (!PCIRCLERADIUS || !*PCIRCLERADIUS) {
+            return 8.0;
         }
 
-        return false;
+        return std::max(0.0, static_cast<double>(**PCIRCLERADIUS));
     } catch (...) {
-        return false;
+        return 8.0;
+    }
+}
+
+// Damage a box in global coordinates on the monitors it touches
+static void damageGlobalRect(const DamageRect& rect) {
+    if (!rect.valid || !g_pHyprRenderer) {
+        return;
+    }
+
+    // Round outwards so antialiased circle edges are repainted too
+    const double x1 = std::floor(rect.x1) - 1.0;
+    const double y1 = std::floor(rect.y1) - 1.0;
+    const double x2 = std::ceil(rect.x2) + 1.0;
+    const double y2 = std::ceil(rect.y2) + 1.0;
+    CBox box = {x1, y1, x2 - x1, y2 - y1};
+    g_pHyprRenderer->damageBox(box);
+}
+
+// Number of points strokes are resampled to, 0 keeps the raw points
+static int getResamplePoints() {
+    try {
+        static auto* const PRESAMPLEPOINTS = (Hyprlang::INT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:resample_points"
+            )->getDataStaticPtr();
+
+        if (!PRESAMPLEPOINTS || !*PRESAMPLEPOINTS) {
+            return 0;
+        }
+
+        // finish() only resamples to two or more points
+        const int resamplePoints = std::clamp(static_cast<int>(**PRESAMPLEPOINTS), 0, 4096);
+        return resamplePoints < 2 ? 0 : resamplePoints;
+    } catch (...) {
+        return 0;
+    }
+}
+
+// Whether new gestures are written in the compact "v1:" format
+static bool useCompactStrokeEncoding() {
+    try {
+        static auto* const PCOMPACTSTROKES = (Hyprlang::INT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:compact_stroke_encoding"
+            )->getDataStaticPtr();
+
+        if (!PCOMPACTSTROKES || !*PCOMPACTSTROKES) {
+            return true;
+        }
+
+        return **PCOMPACTSTROKES != 0;
+    } catch (...) {
+        return true;
     }
 }
 
@@ -183,6 +364,7 @@ static void finishRecordModeClose(WP<Hyprutils::Animation::CBaseAnimatedVariable
     g_recordModeClosing.clear();
     g_recordAnimSize.clear();
     g_recordAnimPos.clear();
+    g_recordHover.clear();
 
     // Clear gesture animations
     g_gestureScaleAnims.clear();
@@ -233,8 +415,9 @@ static void finishGestureRemoval(const std::string& strokeData) {
 
         for (size_t i = 0; i < g_gestureActions.size(); ++i) {
             try {
-                if (g_gestureActions[i].pattern.serialize() == strokeData) {
+                if (g_gestureActions[i].strokeData == strokeData) {
                     g_gestureActions.erase(g_gestureActions.begin() + i);
+                    invalidateGestureLibrary();
                     g_gestureScaleAnims.erase(i);
                     g_gestureAlphaAnims.erase(i);
                     g_gesturesPendingRemoval.erase(i);
@@ -262,7 +445,7 @@ static void startGestureRemovalAnimation(size_t gestureIndex) {
         g_gesturesPendingRemoval.insert(gestureIndex);
 
         // Capture stroke data for the removal callback
-        std::string strokeData = g_gestureActions[gestureIndex].pattern.serialize();
+        std::string strokeData = g_gestureActions[gestureIndex].strokeData;
 
         if (g_pAnimationManager) {
             auto animConfig = Config::animationTree()->getAnimationPropertyConfig("windowsMove");
@@ -322,21 +505,12 @@ static void startRecordModeCloseAnimation() {
 
             const Vector2D monitorSize = monitor->m_size;
 
-            // Calculate the record square position (where we'll zoom to)
-            constexpr float PADDING = 20.0f;
-            const float verticalSpace = monitorSize.y - (2.0f * PADDING);
-            constexpr int VISIBLE_GESTURES = 3;
-            constexpr float GAP_WIDTH = 10.0f;
-            const float totalGaps = (VISIBLE_GESTURES - 1) * GAP_WIDTH;
-            const float baseHeight = (verticalSpace - totalGaps) / VISIBLE_GESTURES;
-            const float gestureRectHeight = baseHeight * 0.9f;
-            const float gestureRectWidth = gestureRectHeight;
-            const float recordSquareSize = verticalSpace;
-            const float totalWidth = gestureRectWidth + recordSquareSize;
-            const float horizontalMargin = (monitorSize.x - totalWidth) / 3.0f;
-
-            const float recordSquareX = horizontalMargin + gestureRectWidth + horizontalMargin;
-            const float recordSquareY = PADDING;
+            // Calculate the record square position (where we'll zoom to),
+            // the same square the overlay draws
+            const auto layout = RecordListLayout::forMonitor(monitorSize.x, monitorSize.y);
+            const float recordSquareSize = layout.recordSquareSize;
+            const float recordSquareX = layout.recordSquareX();
+            const float recordSquareY = layout.recordSquareY();
 
             // Calculate the center of the record square
             const Vector2D recordCenter = Vector2D{
@@ -420,6 +594,11 @@ static void executeCommand(const std::string& command) {
     }
 
     try {
+        if (g_commandSpawner) {
+            g_commandSpawner->submit(command);
+            return;
+        }
+
         std::thread([command]() {
             try {
                 system(command.c_str());
@@ -436,37 +615,69 @@ static void executeCommand(const std::string& command) {
     }
 }
 
-// Helper to calculate gesture rectangle layout
-struct GestureLayout {
-    float gestureRectHeight;
-    float gestureRectWidth;
-    float horizontalMargin;
-};
+// Set the command of a gesture, resolving plain "hyprctl dispatch"
+// commands to the dispatcher they call
+static void setGestureCommand(GestureAction& action, const std::string& command) {
+    action.command = command;
+    action.dispatcher.clear();
+    action.dispatchArg.clear();
 
-static GestureLayout calculateGestureLayout(PHLMONITOR monitor) {
-    constexpr float PADDING = 20.0f;
-    constexpr float GAP_WIDTH = 10.0f;
-    constexpr int VISIBLE_GESTURES = 3;
-    constexpr float TEXT_HEIGHT = 80.0f;
-    constexpr float TEXT_GAP = 20.0f;
-    constexpr float BOTTOM_MARGIN = 20.0f;
+    if (auto dispatch = parseDispatchCommand(command)) {
+        action.dispatcher = std::move(dispatch->dispatcher);
+        action.dispatchArg = std::move(dispatch->arg);
+    }
+}
 
-    const Vector2D& monitorSize = monitor->m_size;
-    const float verticalSpace = monitorSize.y - (2.0f * PADDING);
-    const float totalGaps = (VISIBLE_GESTURES - 1) * GAP_WIDTH;
-    const float baseHeight = (verticalSpace - totalGaps) / VISIBLE_GESTURES;
-    const float gestureRectHeight = baseHeight * 0.9f;
-    const float gestureRectWidth = gestureRectHeight;
+// Whether "hyprctl dispatch" commands are run in process
+static bool isDirectDispatchEnabled() {
+    try {
+        static auto* const PDIRECTDISPATCH = (Hyprlang::INT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:direct_dispatch"
+            )->getDataStaticPtr();
+
+        if (!PDIRECTDISPATCH || !*PDIRECTDISPATCH) {
+            return true;
+        }
+
+        return **PDIRECTDISPATCH != 0;
+    } catch (...) {
+        return true;
+    }
+}
+
+// Call the dispatcher of a "hyprctl dispatch" gesture directly. Returns
+// false if the command has to go through the shell, e.g. because the
+// dispatcher comes from a plugin that isn't loaded.
+static bool runDispatcherDirectly(const GestureAction& action) {
+    if (action.dispatcher.empty() || !g_pKeybindManager || !isDirectDispatchEnabled()) {
+        return false;
+    }
 
-    // Calculate record square size (matching MouseGestureOverlay.cpp)
-    const float maxVerticalSize = monitorSize.y - (PADDING + TEXT_HEIGHT +
-                                                    TEXT_GAP) - BOTTOM_MARGIN;
-    const float recordSquareSize = maxVerticalSize;
+    const auto dispatcher = g_pKeybindManager->m_dispatchers.find(action.dispatcher);
+    if (dispatcher == g_pKeybindManager->m_dispatchers.end()) {
+        return false;
+    }
 
-    // Calculate equal spacing for all three gaps (matching MouseGestureOverlay.cpp)
-    const float horizontalMargin = (monitorSize.x - gestureRectWidth - recordSquareSize) / 3.0f;
+    try {
+        dispatcher->second(action.dispatchArg);
+    } catch (...) {
+        // Dispatcher errors are not ours to handle, like with hyprctl
+    }
 
-    return {gestureRectHeight, gestureRectWidth, horizontalMargin};
+    g_gestureStats.directDispatches.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Run the command of a matched gesture and account it in the stats
+static void dispatchGesture(const GestureAction& action,
+                            std::chrono::steady_clock::time_point releaseTime) {
+    g_gestureMatchCounts[action.strokeData]++;
+    if (!runDispatcherDirectly(action)) {
+        executeCommand(action.command);
+    }
+    g_gestureStats.releaseToDispatch.record(GestureStats::microsSince(releaseTime));
 }
 
 // Helper function to check if position is inside a delete button
@@ -476,45 +687,17 @@ static int getDeleteButtonAtPosition(const Vector2D& mousePos,
         return -1;
     }
 
-    constexpr float PADDING = 20.0f;
-    constexpr float GAP_WIDTH = 10.0f;
-    const float circleSize = 36.0f;
-    const float margin = 4.0f;
-
-    auto layout = calculateGestureLayout(monitor);
     const Vector2D& monitorPos = monitor->m_position;
     const Vector2D& monitorSize = monitor->m_size;
+    const auto layout = RecordListLayout::forMonitor(monitorSize.x, monitorSize.y);
 
     float scrollOffset = 0.0f;
     if (g_scrollOffsets.find(monitor) != g_scrollOffsets.end()) {
         scrollOffset = g_scrollOffsets[monitor];
     }
 
-    const size_t totalGestures = g_gestureActions.size();
-    for (size_t i = 0; i < totalGestures; ++i) {
-        const float yPosLocal = PADDING + i * (layout.gestureRectHeight +
-                                GAP_WIDTH) - scrollOffset;
-
-        if (yPosLocal + layout.gestureRectHeight < 0 ||
-            yPosLocal > monitorSize.y) {
-            continue;
-        }
-
-        const float deleteButtonXLocal = layout.horizontalMargin +
-            layout.gestureRectWidth - circleSize - margin;
-        const float deleteButtonYLocal = yPosLocal + margin;
-        const float deleteButtonXGlobal = monitorPos.x + deleteButtonXLocal;
-        const float deleteButtonYGlobal = monitorPos.y + deleteButtonYLocal;
-
-        if (mousePos.x >= deleteButtonXGlobal &&
-            mousePos.x <= deleteButtonXGlobal + circleSize &&
-            mousePos.y >= deleteButtonYGlobal &&
-            mousePos.y <= deleteButtonYGlobal + circleSize) {
-            return static_cast<int>(i);
-        }
-    }
-
-    return -1;
+    return layout.deleteButtonAt(mousePos.x - monitorPos.x, mousePos.y - monitorPos.y,
+                                 g_gestureActions.size(), scrollOffset);
 }
 
 // Helper function to check if position is inside record mode right square
@@ -523,34 +706,13 @@ static bool isInsideRecordSquare(const Vector2D& mousePos, PHLMONITOR monitor) {
         return false;
     }
 
-    // Calculate the right square bounds (matching renderRecordModeUI)
-    constexpr float PADDING = 20.0f;
-    constexpr float GAP_WIDTH = 10.0f;
-    constexpr int VISIBLE_GESTURES = 3;
-    constexpr float TEXT_HEIGHT = 80.0f;
-    constexpr float TEXT_GAP = 20.0f;
-    constexpr float BOTTOM_MARGIN = 20.0f;
-
-    const Vector2D& monitorSize = monitor->m_size;
     const Vector2D& monitorPos = monitor->m_position;
-
-    const float verticalSpace = monitorSize.y - (2.0f * PADDING);
-    const float totalGaps = (VISIBLE_GESTURES - 1) * GAP_WIDTH;
-    const float baseHeight = (verticalSpace - totalGaps) / VISIBLE_GESTURES;
-    const float gestureRectHeight = baseHeight * 0.9f;
-    const float gestureRectWidth = gestureRectHeight;
-
-    // Calculate record square size (matching MouseGestureOverlay.cpp)
-    const float maxVerticalSize = monitorSize.y - (PADDING + TEXT_HEIGHT +
-                                                    TEXT_GAP) - BOTTOM_MARGIN;
-    const float recordSquareSize = maxVerticalSize;
-
-    // Calculate equal spacing for all three gaps (matching MouseGestureOverlay.cpp)
-    const float horizontalMargin = (monitorSize.x - gestureRectWidth - recordSquareSize) / 3.0f;
+    const auto layout = RecordListLayout::forMonitor(monitor->m_size.x, monitor->m_size.y);
 
     // Right square position and size
-    const float recordSquareX = monitorPos.x + horizontalMargin + gestureRectWidth + horizontalMargin;
-    const float recordSquareY = monitorPos.y + PADDING + TEXT_HEIGHT + TEXT_GAP;
+    const float recordSquareX = monitorPos.x + layout.recordSquareX();
+    const float recordSquareY = monitorPos.y + layout.recordSquareY();
+    const float recordSquareSize = layout.recordSquareSize;
 
     // Check if mouse is inside the right square
     return mousePos.x >= recordSquareX &&
@@ -559,653 +721,550 @@ static bool isInsideRecordSquare(const Vector2D& mousePos, PHLMONITOR monitor) {
            mousePos.y <= recordSquareY + recordSquareSize;
 }
 
-// Forward declarations
-static std::string normalizeStrokeData(const std::string& stroke);
-static bool batchDeleteGesturesFromConfig(
-    const std::vector<std::string>& strokesToDelete);
-static bool addGestureToConfig(const std::string& strokeData);
-
-// Normalize stroke data by replacing -0.000000 with 0.000000
-static std::string normalizeStrokeData(const std::string& stroke) {
-    std::string normalized = stroke;
-    size_t pos = 0;
-    while ((pos = normalized.find("-0.000000", pos)) != std::string::npos) {
-        normalized.replace(pos, 9, "0.000000");
-        pos += 8;
-    }
-    return normalized;
-}
-
-// Helper to find ASCII art comments before a gesture line
-static void findAsciiArtComments(const std::vector<std::string>& lines,
-                                  int gestureLineIndex,
-                                  std::vector<int>& asciiArtLines) {
-    int lookbackLine = gestureLineIndex - 1;
-    while (lookbackLine >= 0) {
-        std::string prevLine = lines[lookbackLine];
-        prevLine.erase(0, prevLine.find_first_not_of(" \t"));
-        if (prevLine.find("#") == 0) {
-            asciiArtLines.push_back(lookbackLine);
-            lookbackLine--;
-        } else {
-            break;
-        }
+// Config files gestures are written to, in order of preference
+static std::vector<std::string> gestureConfigCandidates() {
+    const char* home = std::getenv("HOME");
+    if (!home) {
+        return {};
     }
+
+    std::string configBasePath = std::string(home) + "/.config/hypr";
+    return {
+        configBasePath + "/config/plugins.conf",
+        configBasePath + "/hyprland.conf"
+    };
 }
 
-// Helper to check if stroke matches any in deletion list
-static bool shouldDeleteStroke(const std::string& strokeData,
-                                const std::vector<std::string>& strokesToDelete) {
-    std::string normalizedStroke = normalizeStrokeData(strokeData);
-    for (const auto& strokeToDelete : strokesToDelete) {
-        if (normalizedStroke == normalizeStrokeData(strokeToDelete)) {
-            return true;
+// When config rewrites are flushed to disk
+static ConfigFsyncPolicy getConfigFsyncPolicy() {
+    try {
+        static auto* const PCONFIGFSYNC = (Hyprlang::INT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:config_fsync"
+            )->getDataStaticPtr();
+
+        if (!PCONFIGFSYNC || !*PCONFIGFSYNC) {
+            return ConfigFsyncPolicy::File;
         }
+
+        return configFsyncPolicyFromInt(**PCONFIGFSYNC);
+    } catch (...) {
+        return ConfigFsyncPolicy::File;
     }
-    return false;
 }
 
-// Helper function to process pending gesture deletions
-static void processPendingGestureDeletions() {
-    if (g_pendingGestureDeletions.empty()) {
-        return;
-    }
-    std::vector<std::string> deletionsToProcess = g_pendingGestureDeletions;
-    g_pendingGestureDeletions.clear();
-    g_fileWriteCount++;
-    std::thread([deletionsToProcess]() {
-        try {
-            std::lock_guard<std::mutex> lock(g_fileWriteMutex);
-            batchDeleteGesturesFromConfig(deletionsToProcess);
-        } catch (...) {
-            // Silently catch errors
-        }
-        g_fileWriteCount--;
-    }).detach();
+// Placeholder command for recorded gestures without a configured default
+static std::string placeholderCommandFor(const std::string& configPath) {
+    return "hyprctl notify -1 2000 \"rgb(ff0000)\" "
+        "\"modify me in config file " + configPath + "\"";
 }
 
-// Helper function to process pending gesture additions
-static void processPendingGestureAdditions() {
-    if (g_pendingGestureAdditions.empty()) {
-        return;
+// The config entry of a newly recorded gesture. Reads the config values
+// here, on the event loop, rather than on the writer thread.
+static GestureConfigEntry makeGestureConfigEntry(const std::string& strokeData) {
+    GestureConfigEntry entry;
+    entry.strokeData = strokeData;
+
+    // Check if ASCII art comments are enabled
+    static auto* const PENABLEASCIIART = (Hyprlang::STRING const*)
+        HyprlandAPI::getConfigValue(
+            PHANDLE,
+            "plugin:mouse_gestures:enable_ascii_art_comments"
+        )->getDataStaticPtr();
+
+    bool enableAsciiArt = PENABLEASCIIART && *PENABLEASCIIART &&
+                          std::string(*PENABLEASCIIART) == "true";
+
+    // Get default command for config from config
+    static auto* const PDEFAULTCMDFORCONFIG = (Hyprlang::STRING const*)
+        HyprlandAPI::getConfigValue(
+            PHANDLE,
+            "plugin:mouse_gestures:default_command_for_config"
+        )->getDataStaticPtr();
+
+    if (PDEFAULTCMDFORCONFIG && *PDEFAULTCMDFORCONFIG) {
+        // Config value is defined (even if empty string)
+        entry.command = std::string(*PDEFAULTCMDFORCONFIG);
     }
-    std::vector<std::string> additionsToProcess = g_pendingGestureAdditions;
-    g_pendingGestureAdditions.clear();
-    g_fileWriteCount++;
-    std::thread([additionsToProcess]() {
-        try {
-            std::lock_guard<std::mutex> lock(g_fileWriteMutex);
-            for (const auto& strokeData : additionsToProcess) {
-                addGestureToConfig(strokeData);
-            }
-        } catch (...) {
-            // Silently catch errors
-        }
-        g_fileWriteCount--;
-    }).detach();
-}
 
-// Helper function to process all pending changes on record mode exit
-static void processPendingGestureChanges() {
-    // First, handle conflicts: if a gesture was added then deleted,
-    // remove from both lists (no config write needed)
-    std::vector<std::string> filteredAdditions;
-    for (const auto& addition : g_pendingGestureAdditions) {
-        bool foundInDeletions = false;
-        for (size_t i = 0; i < g_pendingGestureDeletions.size(); ++i) {
-            if (normalizeStrokeData(addition) == normalizeStrokeData(g_pendingGestureDeletions[i])) {
-                // Found a match - remove from deletions and don't add to filtered list
-                g_pendingGestureDeletions.erase(g_pendingGestureDeletions.begin() + i);
-                foundInDeletions = true;
-                break;
-            }
-        }
-        if (!foundInDeletions) {
-            filteredAdditions.push_back(addition);
-        }
+    if (enableAsciiArt) {
+        // Generate ASCII art for the gesture
+        Stroke previewStroke = Stroke::deserialize(strokeData);
+        entry.comments = AsciiGestureRenderer::render(previewStroke);
     }
-    g_pendingGestureAdditions = filteredAdditions;
 
-    // Now process additions and deletions
-    processPendingGestureAdditions();
-    processPendingGestureDeletions();
+    return entry;
 }
 
-// Helper function to batch delete multiple gestures from config file
-static bool batchDeleteGesturesFromConfig(
-    const std::vector<std::string>& strokesToDelete) {
-    if (strokesToDelete.empty()) {
-        return true;
-    }
+// Apply a batch of gesture edits to the config files. Only files the
+// cached index says are affected are read, each is indexed again from
+// what was read, and each is rewritten at most once.
+// New gestures go to the first file with a mouse_gestures block, else the
+// first with a plugin block, else into a new plugin block in
+// hyprland.conf. Runs on the writer thread.
+static void writeGestureEdits(const GestureEditBatch& batch) {
+    std::lock_guard<std::mutex> lock(g_fileWriteMutex);
 
-    const char* home = std::getenv("HOME");
-    if (!home) {
-        return false;
+    if (!g_configIndex || g_configIndex->size() == 0) {
+        return;
     }
+    ConfigFileIndex& configIndex = *g_configIndex;
 
-    std::string configBasePath = std::string(home) + "/.config/hypr";
-    std::vector<std::string> configPaths = {
-        configBasePath + "/config/plugins.conf",
-        configBasePath + "/hyprland.conf"
+    struct ConfigFile {
+        ConfigSectionIndex index;
+        std::string content;
+        bool loaded = false;
+        bool modified = false;
     };
 
-    // Try each config file
-    for (const auto& configPath : configPaths) {
-        std::ifstream inFile(configPath);
-        if (!inFile.is_open()) {
-            continue;
+    std::vector<ConfigFile> files(configIndex.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        files[i].index = configIndex.get(i);
+    }
+
+    auto load = [&configIndex](size_t i, ConfigFile& file) {
+        if (file.loaded) {
+            return file.index.exists;
         }
+        file.loaded = true;
+        if (!file.index.exists || !readConfigText(configIndex.path(i), file.content)) {
+            file.index = ConfigSectionIndex{};
+            return false;
+        }
+        // Edits are spliced at byte offsets, so they must come from the bytes
+        // just read. The cached index can be stale without a size change, e.g.
+        // a symlinked config edited through its target isn't seen by inotify.
+        file.index = indexConfigText(file.content);
+        return true;
+    };
 
-        std::vector<std::string> lines;
-        std::string line;
-        std::vector<int> linesToDelete;
-        std::vector<int> asciiArtLinesToDelete;
-
-        // Read the file and find all gesture_action lines to delete
-        int currentLine = 0;
-        while (std::getline(inFile, line)) {
-            lines.push_back(line);
-
-            std::string trimmed = line;
-            trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-            trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
-
-            // Check if this is a gesture_action line with any of our strokes
-            if (trimmed.find("gesture_action") == 0) {
-                size_t equalPos = trimmed.find('=');
-                if (equalPos != std::string::npos) {
-                    std::string value = trimmed.substr(equalPos + 1);
-                    size_t pipePos = value.rfind('|');
-                    if (pipePos != std::string::npos) {
-                        std::string strokeData = value.substr(pipePos + 1);
-
-                        // Trim whitespace
-                        size_t start = strokeData.find_first_not_of(" \t\n\r");
-                        size_t end = strokeData.find_last_not_of(" \t\n\r");
-                        if (start != std::string::npos &&
-                            end != std::string::npos) {
-                            strokeData = strokeData.substr(start,
-                                                            end - start + 1);
-                        }
+    for (size_t i = 0; i < files.size(); i++) {
+        ConfigFile& file = files[i];
+        if (!batch.deletions.empty() && file.index.hasGestureLines && load(i, file) &&
+            deleteIndexedGestures(file.content, file.index, batch.deletions) > 0) {
+            file.modified = true;
+        }
+    }
 
-                        // Check if this stroke should be deleted
-                        if (shouldDeleteStroke(strokeData, strokesToDelete)) {
-                            linesToDelete.push_back(currentLine);
-                            findAsciiArtComments(lines, currentLine,
-                                                 asciiArtLinesToDelete);
-                        }
-                    }
-                }
+    if (!batch.additions.empty()) {
+        size_t target = files.size() - 1;  // hyprland.conf
+        bool found = false;
+        for (size_t i = 0; i < files.size() && !found; i++) {
+            if (files[i].index.hasSection()) {
+                target = i;
+                found = true;
             }
-            currentLine++;
         }
-        inFile.close();
-
-        if (!linesToDelete.empty()) {
-            // Sort all lines to delete in descending order
-            std::sort(linesToDelete.begin(), linesToDelete.end(),
-                      std::greater<int>());
-            std::sort(asciiArtLinesToDelete.begin(),
-                      asciiArtLinesToDelete.end(), std::greater<int>());
-
-            // Delete ASCII art lines first
-            for (int idx : asciiArtLinesToDelete) {
-                lines.erase(lines.begin() + idx);
+        for (size_t i = 0; i < files.size() && !found; i++) {
+            if (files[i].index.pluginEnd != ConfigSectionIndex::npos) {
+                target = i;
+                found = true;
             }
+        }
 
-            // Then delete gesture_action lines
-            for (int idx : linesToDelete) {
-                // Adjust index based on how many ASCII art lines were deleted before it
-                int adjustedIdx = idx;
-                for (int asciiIdx : asciiArtLinesToDelete) {
-                    if (asciiIdx < idx) {
-                        adjustedIdx--;
-                    }
-                }
-                if (adjustedIdx >= 0 && adjustedIdx < static_cast<int>(lines.size())) {
-                    lines.erase(lines.begin() + adjustedIdx);
-                }
-            }
+        ConfigFile& file = files[target];
+        load(target, file);
+        insertIndexedGestures(file.content, file.index,
+                              formatGestureLines(batch.additions,
+                                                 placeholderCommandFor(configIndex.path(target))));
+        file.modified = true;
+    }
 
-            // Write to temporary file first (atomic write)
-            std::string tempPath = configPath + ".tmp";
-            std::ofstream outFile(tempPath);
-            if (!outFile.is_open()) {
-                return false;
-            }
+    const ConfigFsyncPolicy policy = g_configFsyncPolicy.load();
+    for (size_t i = 0; i < files.size(); i++) {
+        if (files[i].modified &&
+            writeConfigAtomically(configIndex.path(i), files[i].content, policy)) {
+            configIndex.update(i, files[i].content);
+            g_configFilePath = configIndex.path(i);
+        }
+    }
+}
 
-            for (const auto& l : lines) {
-                outFile << l << "\n";
-            }
-            outFile.close();
+// Queue the gestures added and deleted in record mode for writing
+static void processPendingGestureChanges() {
+    GestureEditBatch batch;
+    for (const auto& strokeData : g_pendingGestureAdditions) {
+        batch.additions.push_back(makeGestureConfigEntry(strokeData));
+    }
+    batch.deletions = g_pendingGestureDeletions;
+    g_pendingGestureAdditions.clear();
+    g_pendingGestureDeletions.clear();
 
-            // Atomically rename temp file to final file
-            if (std::rename(tempPath.c_str(), configPath.c_str()) != 0) {
-                // Failed to rename, try to clean up temp file
-                std::remove(tempPath.c_str());
-                return false;
-            }
-            g_configFilePath = configPath;
-            return true;
-        }
+    // A gesture added and deleted again needs no config write
+    batch.cancelAddedThenDeleted();
+    if (batch.empty()) {
+        return;
     }
 
-    return false;
+    g_configFsyncPolicy = getConfigFsyncPolicy();
+    g_configWriteQueue.submit(std::move(batch));
 }
 
 // Helper function to detect which config file is being used
 static void detectConfigFilePath() {
-    const char* home = std::getenv("HOME");
-    if (!home) {
+    if (!g_configIndex || g_configIndex->size() == 0) {
         return;
     }
 
-    std::string configBasePath = std::string(home) + "/.config/hypr";
-    std::vector<std::string> configPaths = {
-        configBasePath + "/config/plugins.conf",
-        configBasePath + "/hyprland.conf"
-    };
-
-    // Try each config file to see which one contains mouse_gestures configuration
-    for (const auto& configPath : configPaths) {
-        std::ifstream inFile(configPath);
-        if (!inFile.is_open()) {
-            continue;
-        }
-
-        std::string line;
-        while (std::getline(inFile, line)) {
-            std::string trimmed = line;
-            trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-            trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
-
-            // Check if this line contains mouse_gestures configuration
-            if (trimmed.find("mouse_gestures") != std::string::npos ||
-                trimmed.find("gesture_action") != std::string::npos) {
-                g_configFilePath = configPath;
-                inFile.close();
-                return;
-            }
+    // The first file with mouse_gestures configuration
+    for (size_t i = 0; i < g_configIndex->size(); i++) {
+        if (g_configIndex->get(i).mentionsGestures) {
+            g_configFilePath = g_configIndex->path(i);
+            return;
         }
-        inFile.close();
     }
 
     // Default to plugins.conf if no config found
     if (g_configFilePath.empty()) {
-        g_configFilePath = configBasePath + "/config/plugins.conf";
+        g_configFilePath = g_configIndex->path(0);
     }
 }
 
-// Helper function to add gesture to Hyprland config file
-static bool addGestureToConfig(const std::string& strokeData) {
-    const char* home = std::getenv("HOME");
-    if (!home) {
-        return false;
-    }
-
-    std::string configBasePath = std::string(home) + "/.config/hypr";
-    std::vector<std::string> configPaths = {
-        configBasePath + "/config/plugins.conf",
-        configBasePath + "/hyprland.conf"
-    };
+// Matching parameters read from the config
+struct MatchSettings {
+    double threshold = 0.0;
+    double prefilterDistance = 0.0;  // 0 disables the feature prefilter
+};
 
-    // Step 1: Try to find existing mouse_gestures section
-    for (const auto& configPath : configPaths) {
-        std::ifstream inFile(configPath);
-        if (!inFile.is_open()) continue;
-
-        std::vector<std::string> lines;
-        std::string line;
-        bool foundMouseGestures = false;
-        int mouseGesturesSectionEnd = -1;
-        int currentLine = 0;
-        int braceDepth = 0;
-        int pluginBraceDepth = 0;
-        bool inPlugin = false;
-
-        // Read the file and find mouse_gestures section
-        while (std::getline(inFile, line)) {
-            lines.push_back(line);
-
-            std::string trimmed = line;
-            trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-            trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
-
-            if (trimmed.find("plugin") == 0 && trimmed.find("{") != std::string::npos) {
-                inPlugin = true;
-                pluginBraceDepth = 1;
-            } else if (inPlugin) {
-                for (char c : trimmed) {
-                    if (c == '{') pluginBraceDepth++;
-                    else if (c == '}') pluginBraceDepth--;
-                }
-                if (pluginBraceDepth == 0) inPlugin = false;
-            }
+static bool getMatchSettings(MatchSettings& settings) {
+    try {
+        // Get match threshold from config
+        static auto* const PMATCHTHRESHOLD = (Hyprlang::FLOAT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:match_threshold"
+            )->getDataStaticPtr();
 
-            if (trimmed.find("mouse_gestures") == 0 && trimmed.find("{") != std::string::npos) {
-                foundMouseGestures = true;
-                braceDepth = 1;
-            } else if (foundMouseGestures && braceDepth > 0) {
-                for (char c : trimmed) {
-                    if (c == '{') braceDepth++;
-                    else if (c == '}') braceDepth--;
-                }
-                if (braceDepth == 0) {
-                    mouseGesturesSectionEnd = currentLine;
-                }
-            }
-            currentLine++;
+        if (!PMATCHTHRESHOLD || !*PMATCHTHRESHOLD) {
+            return false;
         }
-        inFile.close();
-
-        if (foundMouseGestures && mouseGesturesSectionEnd > 0) {
-            // Check if ASCII art comments are enabled
-            static auto* const PENABLEASCIIART = (Hyprlang::STRING const*)
-                HyprlandAPI::getConfigValue(
-                    PHANDLE,
-                    "plugin:mouse_gestures:enable_ascii_art_comments"
-                )->getDataStaticPtr();
 
-            bool enableAsciiArt = PENABLEASCIIART && *PENABLEASCIIART &&
-                                  std::string(*PENABLEASCIIART) == "true";
-
-            // Get default command for config from config
-            static auto* const PDEFAULTCMDFORCONFIG = (Hyprlang::STRING const*)
-                HyprlandAPI::getConfigValue(
-                    PHANDLE,
-                    "plugin:mouse_gestures:default_command_for_config"
-                )->getDataStaticPtr();
-
-            std::string defaultCmd;
-            if (PDEFAULTCMDFORCONFIG && *PDEFAULTCMDFORCONFIG) {
-                // Config value is defined (even if empty string)
-                defaultCmd = std::string(*PDEFAULTCMDFORCONFIG);
-            } else {
-                // Config value is not defined (null), use fallback
-                defaultCmd = "hyprctl notify -1 2000 \"rgb(ff0000)\" "
-                    "\"modify me in config file " + configPath + "\"";
-            }
+        settings.threshold = static_cast<double>(**PMATCHTHRESHOLD);
 
-            std::string gestureAction = "    gesture_action = " + defaultCmd + "|" + strokeData;
-
-            // Insert ASCII art first (if enabled), then gesture_action
-            int insertPos = mouseGesturesSectionEnd;
-            if (enableAsciiArt) {
-                // Generate ASCII art for the gesture
-                Stroke previewStroke = Stroke::deserialize(strokeData);
-                auto asciiArt = AsciiGestureRenderer::render(previewStroke);
-
-                for (const auto& artLine : asciiArt) {
-                    lines.insert(lines.begin() + insertPos, "    " + artLine);
-                    insertPos++;
-                }
-            }
-            lines.insert(lines.begin() + insertPos, gestureAction);
+        // Feature distance above which templates skip the DP (0 = off)
+        static auto* const PPREFILTERDISTANCE = (Hyprlang::FLOAT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:prefilter_distance"
+            )->getDataStaticPtr();
 
-            // Write to temporary file first (atomic write)
-            std::string tempPath = configPath + ".tmp";
-            std::ofstream outFile(tempPath);
-            if (!outFile.is_open()) return false;
+        settings.prefilterDistance = (PPREFILTERDISTANCE && *PPREFILTERDISTANCE) ?
+            static_cast<double>(**PPREFILTERDISTANCE) : 0.0;
 
-            for (const auto& l : lines) {
-                outFile << l << "\n";
-            }
-            outFile.close();
-
-            // Atomically rename temp file to final file
-            if (std::rename(tempPath.c_str(), configPath.c_str()) != 0) {
-                // Failed to rename, try to clean up temp file
-                std::remove(tempPath.c_str());
-                return false;
-            }
-            g_configFilePath = configPath;
-            return true;
-        }
+        return true;
+    } catch (...) {
+        return false;
     }
+}
 
-    // Step 2: If no mouse_gestures section found, try to find plugin section
-    for (const auto& configPath : configPaths) {
-        std::ifstream inFile(configPath);
-        if (!inFile.is_open()) continue;
-
-        std::vector<std::string> lines;
-        std::string line;
-        int pluginSectionEnd = -1;
-        int currentLine = 0;
-        int braceDepth = 0;
-        bool inPluginSection = false;
+// Current gesture library snapshot, rebuilt if g_gestureActions changed
+static std::shared_ptr<const GestureLibrarySnapshot> getGestureLibrary() {
+    if (!g_gestureLibrary) {
+        auto library = std::make_shared<GestureLibrarySnapshot>();
+        library->actions = g_gestureActions;
+        library->index.rebuild(library->actions, [](const GestureAction& action) -> const Stroke& {
+            return action.pattern;
+        });
+        g_gestureLibrary = std::move(library);
+    }
+    return g_gestureLibrary;
+}
 
-        while (std::getline(inFile, line)) {
-            lines.push_back(line);
+// Find best matching gesture action for a finished input stroke.
+// The result points into `library`, which the caller keeps alive.
+static const GestureAction* findMatchingGestureAction(
+    const Stroke& inputStroke,
+    const std::shared_ptr<const GestureLibrarySnapshot>& library,
+    std::chrono::steady_clock::time_point releaseTime,
+    int hint = -1) {
 
-            std::string trimmed = line;
-            trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-            trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
+    if (!inputStroke.isFinished() || !library || library->actions.empty()) {
+        return nullptr;
+    }
 
-            if (trimmed.find("plugin") == 0 && trimmed.find("{") != std::string::npos) {
-                inPluginSection = true;
-                braceDepth = 1;
-            } else if (inPluginSection && braceDepth > 0) {
-                for (char c : trimmed) {
-                    if (c == '{') braceDepth++;
-                    else if (c == '}') braceDepth--;
-                }
-                if (braceDepth == 0) {
-                    pluginSectionEnd = currentLine;
-                }
-            }
-            currentLine++;
+    try {
+        MatchSettings settings;
+        if (!getMatchSettings(settings)) {
+            return nullptr;
         }
-        inFile.close();
 
-        if (pluginSectionEnd > 0) {
-            // Check if ASCII art comments are enabled
-            static auto* const PENABLEASCIIART = (Hyprlang::STRING const*)
-                HyprlandAPI::getConfigValue(
-                    PHANDLE,
-                    "plugin:mouse_gestures:enable_ascii_art_comments"
-                )->getDataStaticPtr();
-
-            bool enableAsciiArt = PENABLEASCIIART && *PENABLEASCIIART &&
-                                  std::string(*PENABLEASCIIART) == "true";
-
-            // Get default command for config from config
-            static auto* const PDEFAULTCMDFORCONFIG = (Hyprlang::STRING const*)
-                HyprlandAPI::getConfigValue(
-                    PHANDLE,
-                    "plugin:mouse_gestures:default_command_for_config"
-                )->getDataStaticPtr();
+        // Candidates are evaluated nearest first, with the best cost so
+        // far as DP bound
+        const auto matchStart = std::chrono::steady_clock::now();
+        const GestureMatch match = findBestStrokeMatch(
+            inputStroke, library->actions, library->index,
+            settings.prefilterDistance, settings.threshold,
+            [](const GestureAction& action) -> const Stroke& {
+                return action.pattern;
+            }, hint);
 
-            std::string defaultCmd;
-            if (PDEFAULTCMDFORCONFIG && *PDEFAULTCMDFORCONFIG) {
-                // Config value is defined (even if empty string)
-                defaultCmd = std::string(*PDEFAULTCMDFORCONFIG);
-            } else {
-                // Config value is not defined (null), use fallback
-                defaultCmd = "hyprctl notify -1 2000 \"rgb(ff0000)\" "
-                    "\"modify me in config file " + configPath + "\"";
-            }
+        g_gestureStats.matching.record(GestureStats::microsSince(matchStart));
+        g_gestureStats.recordDecision(releaseTime, match.index >= 0, match.evaluated, match.filtered);
 
-            // Add mouse_gestures section before the closing brace of plugin section
-            std::vector<std::string> newSection = {
-                "",
-                "  mouse_gestures {"
-            };
-
-            // Add ASCII art with proper indentation (if enabled)
-            if (enableAsciiArt) {
-                // Generate ASCII art for the gesture
-                Stroke previewStroke = Stroke::deserialize(strokeData);
-                auto asciiArt = AsciiGestureRenderer::render(previewStroke);
-
-                for (const auto& artLine : asciiArt) {
-                    newSection.push_back("    " + artLine);
-                }
-            }
+        if (match.index < 0) {
+            return nullptr;
+        }
 
-            // Add gesture action
-            newSection.push_back("    gesture_action = " + defaultCmd + "|" + strokeData);
-            newSection.push_back("  }");
+        return &library->actions[match.index];
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+}
 
-            for (int i = newSection.size() - 1; i >= 0; i--) {
-                lines.insert(lines.begin() + pluginSectionEnd, newSection[i]);
-            }
+static bool isLivePredictionEnabled() {
+    try {
+        static auto* const PLIVEPREDICTION = (Hyprlang::INT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:live_prediction"
+            )->getDataStaticPtr();
 
-            // Write to temporary file first (atomic write)
-            std::string tempPath = configPath + ".tmp";
-            std::ofstream outFile(tempPath);
-            if (!outFile.is_open()) return false;
+        return PLIVEPREDICTION && *PLIVEPREDICTION && **PLIVEPREDICTION;
+    } catch (...) {
+        return false;
+    }
+}
 
-            for (const auto& l : lines) {
-                outFile << l << "\n";
-            }
-            outFile.close();
+// Forget the prediction of the previous stroke
+static void resetLivePrediction() {
+    g_gesturePredictor.begin();
+    g_predictionLibrary.reset();
 
-            // Atomically rename temp file to final file
-            if (std::rename(tempPath.c_str(), configPath.c_str()) != 0) {
-                // Failed to rename, try to clean up temp file
-                std::remove(tempPath.c_str());
-                return false;
-            }
-            g_configFilePath = configPath;
-            return true;
+    if (g_livePredictionIndex >= 0) {
+        g_livePredictionIndex = -1;
+        if (isLivePredictionEnabled()) {
+            damageAllMonitors();
         }
     }
+}
 
-    // Step 3: If no plugin section found, add to hyprland.conf
-    std::string hyprlandConf = configBasePath + "/hyprland.conf";
-    std::ofstream outFile(hyprlandConf, std::ios::app);
-    if (!outFile.is_open()) return false;
+static void applySpeculativeResult(const MatchResult& result) {
+    if (!g_gesturePredictor.complete(result.sequence, result.pathSize, result.match,
+                                     result.library.get())) {
+        return;
+    }
 
-    // Check if ASCII art comments are enabled
-    static auto* const PENABLEASCIIART = (Hyprlang::STRING const*)
-        HyprlandAPI::getConfigValue(
-            PHANDLE,
-            "plugin:mouse_gestures:enable_ascii_art_comments"
-        )->getDataStaticPtr();
+    g_predictionLibrary = result.library;
 
-    bool enableAsciiArt = PENABLEASCIIART && *PENABLEASCIIART &&
-                          std::string(*PENABLEASCIIART) == "true";
+    // Indices only map onto g_gestureActions while the snapshot is current
+    const int predicted = (result.library == g_gestureLibrary) ? result.match.index : -1;
+    if (predicted != g_livePredictionIndex) {
+        g_livePredictionIndex = predicted;
+        if (isLivePredictionEnabled()) {
+            damageAllMonitors();
+        }
+    }
+}
 
-    // Get default command for config from config
-    static auto* const PDEFAULTCMDFORCONFIG = (Hyprlang::STRING const*)
-        HyprlandAPI::getConfigValue(
-            PHANDLE,
-            "plugin:mouse_gestures:default_command_for_config"
-        )->getDataStaticPtr();
+// Runs on the event loop once match workers have posted results
+static int onMatchResultsReady(int fd, uint32_t mask, void* data) {
+    uint64_t posted = 0;
+    if (read(fd, &posted, sizeof(posted)) != sizeof(posted)) {
+        return 0;
+    }
 
-    std::string defaultCmd;
-    if (PDEFAULTCMDFORCONFIG && *PDEFAULTCMDFORCONFIG) {
-        // Config value is defined (even if empty string)
-        defaultCmd = std::string(*PDEFAULTCMDFORCONFIG);
-    } else {
-        // Config value is not defined (null), use fallback
-        defaultCmd = "hyprctl notify -1 2000 \"rgb(ff0000)\" "
-            "\"modify me in config file " + hyprlandConf + "\"";
+    std::vector<MatchResult> results;
+    {
+        std::lock_guard<std::mutex> lock(g_matchResultsMutex);
+        results.swap(g_matchResults);
     }
 
-    outFile << "\nplugin {\n";
-    outFile << "  mouse_gestures {\n";
+    if (g_pluginShuttingDown) {
+        return 0;
+    }
 
-    // Write ASCII art (if enabled)
-    if (enableAsciiArt) {
-        // Generate ASCII art for the gesture
-        Stroke previewStroke = Stroke::deserialize(strokeData);
-        auto asciiArt = AsciiGestureRenderer::render(previewStroke);
+    for (const auto& result : results) {
+        if (result.speculative) {
+            applySpeculativeResult(result);
+            continue;
+        }
 
-        for (const auto& artLine : asciiArt) {
-            outFile << "    " << artLine << "\n";
+        // Matches that complete after entering record mode are dropped
+        if (g_recordMode || result.match.index < 0) {
+            continue;
         }
-    }
 
-    outFile << "    gesture_action = " << defaultCmd << "|" << strokeData << "\n";
-    outFile << "  }\n";
-    outFile << "}\n";
-    outFile.close();
+        dispatchGesture(result.library->actions[result.match.index], result.releaseTime);
+    }
 
-    return true;
+    return 0;
 }
 
+// Start the match workers and register their eventfd with the event loop.
+// Without them, gestures are matched synchronously.
+static void startMatchPool() {
+    try {
+        if (!g_pCompositor || !g_pCompositor->m_wlEventLoop) {
+            return;
+        }
 
+        g_matchEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (g_matchEventFd < 0) {
+            return;
+        }
 
+        g_matchEventSource = wl_event_loop_add_fd(g_pCompositor->m_wlEventLoop,
+                                                  g_matchEventFd, WL_EVENT_READABLE,
+                                                  onMatchResultsReady, nullptr);
+        if (!g_matchEventSource) {
+            close(g_matchEventFd);
+            g_matchEventFd = -1;
+            return;
+        }
 
+        // A few threads are plenty; the compositor needs the rest
+        const size_t threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4);
+        g_matchPool = std::make_unique<GestureMatchPool>(threads);
+    } catch (...) {
+        g_matchPool.reset();
+    }
+}
 
-
-
-// Convert path to stroke and find best matching gesture action
-static const GestureAction* findMatchingGestureAction(const std::vector<Vector2D>& path) {
-
-    if (path.size() < 2) {
-        return nullptr;
+static int onSpawnedCommandExited(int fd, uint32_t mask, void* data) {
+    if (g_commandSpawner) {
+        g_commandSpawner->reap();
     }
+    return 0;
+}
 
+// Create the command spawner and watch its children from the event loop.
+// Without it, commands fall back to a thread running system().
+static void startCommandSpawner() {
     try {
-        // Get match threshold from config
-        static auto* const PMATCHTHRESHOLD = (Hyprlang::FLOAT* const*)
-            HyprlandAPI::getConfigValue(
-                PHANDLE,
-                "plugin:mouse_gestures:match_threshold"
-            )->getDataStaticPtr();
-
-        if (!PMATCHTHRESHOLD || !*PMATCHTHRESHOLD) {
-            return nullptr;
+        g_commandSpawner = std::make_unique<CommandSpawner>();
+
+        // Without the event source, exited launchers are still reaped
+        // whenever the spawner runs out of slots
+        if (g_pCompositor && g_pCompositor->m_wlEventLoop && g_commandSpawner->pollFd() >= 0) {
+            g_spawnerEventSource = wl_event_loop_add_fd(g_pCompositor->m_wlEventLoop,
+                                                        g_commandSpawner->pollFd(),
+                                                        WL_EVENT_READABLE,
+                                                        onSpawnedCommandExited, nullptr);
         }
+    } catch (...) {
+        g_commandSpawner.reset();
+    }
+}
 
-        const double matchThreshold = static_cast<double>(**PMATCHTHRESHOLD);
+static void stopCommandSpawner() {
+    if (g_spawnerEventSource) {
+        wl_event_source_remove(g_spawnerEventSource);
+        g_spawnerEventSource = nullptr;
+    }
+    g_commandSpawner.reset();
+}
 
-        // Create stroke from path
-        Stroke inputStroke;
-        for (size_t i = 0; i < path.size(); i++) {
-            if (!inputStroke.addPoint(path[i].x, path[i].y)) {
-                return nullptr;
-            }
-        }
+// Join the match workers before tearing down the eventfd they post to
+static void stopMatchPool() {
+    if (g_matchPool) {
+        g_matchPool->shutdown();
+        g_matchPool.reset();
+    }
 
-        if (!inputStroke.finish()) {
-            return nullptr;
-        }
+    if (g_matchEventSource) {
+        wl_event_source_remove(g_matchEventSource);
+        g_matchEventSource = nullptr;
+    }
 
-        // Find best matching gesture
-        if (g_gestureActions.empty()) {
-            return nullptr;
-        }
+    if (g_matchEventFd >= 0) {
+        close(g_matchEventFd);
+        g_matchEventFd = -1;
+    }
 
-        const GestureAction* bestMatch = nullptr;
-        double bestCost = matchThreshold;
+    std::lock_guard<std::mutex> lock(g_matchResultsMutex);
+    g_matchResults.clear();
+}
 
-        for (size_t i = 0; i < g_gestureActions.size(); i++) {
-            const auto& action = g_gestureActions[i];
+// Queue a finished stroke built from `pathSize` path points on the
+// workers, its result is handled from the event loop. Template `hint` is
+// evaluated first. Returns false if nothing was queued.
+static bool submitGestureMatch(const Stroke& inputStroke, size_t pathSize,
+                               bool speculative, int hint = -1,
+                               std::chrono::steady_clock::time_point releaseTime = {}) {
+    if (!g_matchPool || g_matchEventFd < 0 || !g_matchEventSource) {
+        return false;
+    }
+
+    MatchSettings settings;
+    if (!getMatchSettings(settings)) {
+        return false;
+    }
 
-            std::string actionName = action.name.empty() ?
-                "Action_" + std::to_string(i) : action.name;
+    auto library = getGestureLibrary();
+    if (library->actions.empty()) {
+        return false;
+    }
 
+    // The snapshot is kept alive by the request until it completes
+    const GestureLibrarySnapshot* snapshot = library.get();
+    const uint64_t sequence = g_gesturePredictor.currentSequence();
+    const auto submitTime = std::chrono::steady_clock::now();
+
+    return g_matchPool->submit(
+        library, inputStroke, snapshot->index,
+        [snapshot](int index) -> const Stroke& {
+            return snapshot->actions[index].pattern;
+        },
+        settings.prefilterDistance, settings.threshold,
+        [library, sequence, pathSize, speculative, releaseTime, submitTime](const GestureMatch& match) {
+            if (speculative) {
+                g_gestureStats.speculativeMatches.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                g_gestureStats.matching.record(GestureStats::microsSince(submitTime));
+                g_gestureStats.recordDecision(releaseTime, match.index >= 0,
+                                              match.evaluated, match.filtered);
+            }
 
-            if (!action.pattern.isFinished()) {
-                continue;
+            // Final matches without a command have nothing to deliver
+            if (!speculative && (match.index < 0 ||
+                                 library->actions[match.index].command.empty())) {
+                return;
             }
 
+            {
+                std::lock_guard<std::mutex> lock(g_matchResultsMutex);
+                g_matchResults.push_back({sequence, pathSize, speculative, releaseTime, match, library});
+            }
+
+            const uint64_t one = 1;
+            if (write(g_matchEventFd, &one, sizeof(one)) != sizeof(one)) {
+                // Counter overflow only, the event loop is already woken
+            }
+        },
+        hint);
+}
 
-            double cost = inputStroke.compare(action.pattern);
+// Match the stroke drawn so far in the background, every few new points
+static void speculateGestureMatch() {
+    const size_t pathSize = g_gestureState.path.size();
+    if (!g_matchPool || !g_gesturePredictor.shouldSpeculate(pathSize)) {
+        return;
+    }
 
-            if (cost < bestCost) {
-                bestCost = cost;
-                bestMatch = &action;
+    try {
+        Stroke stroke;
+        for (const auto& point : g_gestureState.path) {
+            if (!stroke.addPoint(point.x, point.y)) {
+                return;
             }
         }
 
-        if (bestMatch) {
-            std::string matchName = bestMatch->name.empty() ? "unnamed" : bestMatch->name;
-        } else {
+        if (!stroke.finish(getResamplePoints())) {
+            return;
         }
 
-        return bestMatch;
-    } catch (const std::exception& e) {
-        return nullptr;
+        g_gesturePredictor.submitted(pathSize);
+        if (!submitGestureMatch(stroke, pathSize, true)) {
+            g_gesturePredictor.cancelled();
+        }
+    } catch (...) {
+        g_gesturePredictor.cancelled();
     }
 }
 
 // Handle detected gesture - analyze path and display result
-static void handleGestureDetected() {
+static void handleGestureDetected(std::chrono::steady_clock::time_point releaseTime) {
 
     if (g_gestureState.path.size() <= 1) {
         return;
@@ -1220,15 +1279,17 @@ static void handleGestureDetected() {
             }
         }
 
-        if (!inputStroke.finish()) {
+        if (!inputStroke.finish(getResamplePoints())) {
             return;
         }
+        g_gestureStats.strokeBuild.record(GestureStats::microsSince(releaseTime));
 
         // If in record mode, save the stroke data
         if (g_recordMode) {
             try {
                 // Serialize the stroke
-                std::string strokeData = inputStroke.serialize();
+                std::string strokeData = useCompactStrokeEncoding() ?
+                    inputStroke.serializeCompact() : inputStroke.serialize();
 
                 // Add to pending additions (will be written to config on exit)
                 g_pendingGestureAdditions.push_back(strokeData);
@@ -1250,9 +1311,12 @@ static void handleGestureDetected() {
                 // Add to in-memory list for immediate display
                 GestureAction newAction;
                 newAction.name = "";
-                newAction.command = defaultCmd;
+                setGestureCommand(newAction, defaultCmd);
                 newAction.pattern = inputStroke;
+                newAction.strokeData = strokeData;
+                newAction.resampleCount = getResamplePoints();
                 g_gestureActions.push_back(newAction);
+                invalidateGestureLibrary();
 
                 // Initialize scale and fade-in animation for the new gesture
                 size_t newGestureIndex = g_gestureActions.size() - 1;
@@ -1297,19 +1361,10 @@ static void handleGestureDetected() {
                     for (auto& monitor : g_pCompositor->m_monitors) {
                         if (!monitor) continue;
 
-                        constexpr float PADDING = 20.0f;
-                        constexpr float GAP_WIDTH = 10.0f;
-                        constexpr int VISIBLE_GESTURES = 3;
-
-                        const float verticalSpace = monitor->m_size.y - (2.0f * PADDING);
-                        const float totalGaps = (VISIBLE_GESTURES - 1) * GAP_WIDTH;
-                        const float baseHeight = (verticalSpace - totalGaps) / VISIBLE_GESTURES;
-                        const float gestureRectHeight = baseHeight * 0.9f;
-
                         // Scroll to bottom to show newest gestures
-                        const float totalHeight = g_gestureActions.size() * (gestureRectHeight + GAP_WIDTH);
-                        const float maxScrollOffset = totalHeight - verticalSpace;
-                        g_scrollOffsets[monitor] = std::max(0.0f, maxScrollOffset);
+                        const auto layout = RecordListLayout::forMonitor(monitor->m_size.x,
+                                                                         monitor->m_size.y);
+                        g_scrollOffsets[monitor] = std::max(0.0f, layout.maxScrollOffset(g_gestureActions.size()));
                     }
                 }
 
@@ -1325,11 +1380,33 @@ static void handleGestureDetected() {
             return;
         }
 
-        // Check for matching gesture action
-        const GestureAction* matchingAction = findMatchingGestureAction(g_gestureState.path);
+        const size_t pathSize = g_gestureState.path.size();
+        const auto library = getGestureLibrary();
+
+        // A prediction that already saw every point is the final answer
+        if (g_gesturePredictor.coversStroke(pathSize, library.get())) {
+            const int predicted = g_gesturePredictor.candidate().index;
+            g_gestureStats.predictionHits.fetch_add(1, std::memory_order_relaxed);
+            g_gestureStats.recordDecision(releaseTime, predicted >= 0, 0, 0);
+            if (predicted >= 0) {
+                dispatchGesture(library->actions[predicted], releaseTime);
+            }
+            return;
+        }
+
+        // Otherwise the predicted template goes first so the DP bound is
+        // tight from the start. Match off the event loop so large
+        // libraries don't stall the compositor, inline without workers.
+        const int hint = g_gesturePredictor.hint(library.get());
+        if (submitGestureMatch(inputStroke, pathSize, false, hint, releaseTime)) {
+            return;
+        }
+
+        const GestureAction* matchingAction =
+            findMatchingGestureAction(inputStroke, library, releaseTime, hint);
 
         if (matchingAction) {
-            executeCommand(matchingAction->command);
+            dispatchGesture(*matchingAction, releaseTime);
         }
     } catch (const std::exception& e) {
         // Silently catch errors
@@ -1355,10 +1432,10 @@ static void replayButtonEvents(uint32_t releaseTimeMs) {
 }
 
 // Check if drag threshold is exceeded within time window
-static bool checkDragThresholdExceeded(const Vector2D& mousePos) {
+static bool checkDragThresholdExceeded(const Vector2D& mousePos,
+                                       std::chrono::steady_clock::time_point now) {
     try {
         // Calculate time elapsed since button press
-        auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
             now - g_gestureState.pressTime
         ).count();
@@ -1379,25 +1456,84 @@ static bool checkDragThresholdExceeded(const Vector2D& mousePos) {
             return false;
         }
 
-        const float dragThreshold = static_cast<float>(**PDRAGTHRESHOLD);
+        const float dragThreshold = static_cast<float>(**PDRAGTHRESHOLD);
+
+        const float distanceX = std::abs(
+            mousePos.x - g_gestureState.mouseDownPos.x
+        );
+        const float distanceY = std::abs(
+            mousePos.y - g_gestureState.mouseDownPos.y
+        );
+
+        return (distanceX > dragThreshold || distanceY > dragThreshold);
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// Config handler for gesture_action keyword
+// NEW FORMAT: gesture_action = <command>|<stroke_data>
+// The pipe character | separates command from stroke data
+// Stroke data contains x,y;x,y;... (commas and semicolons are preserved)
+static bool isGestureCacheEnabled() {
+    try {
+        static auto* const PGESTURECACHE = (Hyprlang::INT* const*)
+            HyprlandAPI::getConfigValue(
+                PHANDLE,
+                "plugin:mouse_gestures:gesture_cache"
+            )->getDataStaticPtr();
+
+        if (!PGESTURECACHE || !*PGESTURECACHE) {
+            return true;
+        }
+
+        return **PGESTURECACHE != 0;
+    } catch (...) {
+        return true;
+    }
+}
+
+// Map the gesture cache once per reload, false if there is none
+static bool openGestureCache() {
+    if (!g_gestureCacheOpened) {
+        g_gestureCacheOpened = true;
+        try {
+            const std::string path = GestureCache::defaultPath();
+            if (isGestureCacheEnabled() && !path.empty()) {
+                g_gestureCache.open(path);
+            }
+        } catch (...) {
+            g_gestureCache.close();
+        }
+    }
+    return g_gestureCache.isOpen();
+}
+
+// Store the finished templates for the next reload. Only rewrites the
+// cache when some gesture had to be parsed or entries went stale.
+static void saveGestureCache() {
+    try {
+        const bool upToDate = g_gestureCacheMisses == 0 &&
+                              g_gestureCache.size() == g_gestureActions.size();
+        g_gestureCache.close();
 
-        const float distanceX = std::abs(
-            mousePos.x - g_gestureState.mouseDownPos.x
-        );
-        const float distanceY = std::abs(
-            mousePos.y - g_gestureState.mouseDownPos.y
-        );
+        const std::string path = GestureCache::defaultPath();
+        if (upToDate || !isGestureCacheEnabled() || path.empty()) {
+            return;
+        }
 
-        return (distanceX > dragThreshold || distanceY > dragThreshold);
-    } catch (const std::exception&) {
-        return false;
+        std::vector<GestureCache::Record> records;
+        records.reserve(g_gestureActions.size());
+        for (const auto& action : g_gestureActions) {
+            records.push_back({action.strokeData, action.resampleCount, &action.pattern});
+        }
+
+        GestureCache::write(path, std::move(records));
+    } catch (...) {
+        // The cache is only an optimization
     }
 }
 
-// Config handler for gesture_action keyword
-// NEW FORMAT: gesture_action = <command>|<stroke_data>
-// The pipe character | separates command from stroke data
-// Stroke data contains x,y;x,y;... (commas and semicolons are preserved)
 static Hyprlang::CParseResult onGestureAction(const char* COMMAND, const char* VALUE) {
 
     try {
@@ -1444,14 +1580,25 @@ static Hyprlang::CParseResult onGestureAction(const char* COMMAND, const char* V
         // Create action
         GestureAction action;
         action.name = "";  // No name in simple format
-        action.command = command;
-        action.pattern = Stroke::deserialize(strokeData);
+        setGestureCommand(action, command);
+        // Unchanged gestures are restored from the cache without parsing
+        const int resamplePoints = getResamplePoints();
+        if (openGestureCache() &&
+            g_gestureCache.lookup(strokeData, resamplePoints, action.pattern)) {
+            action.resampleCount = resamplePoints;
+        } else {
+            action.pattern = Stroke::deserialize(strokeData);
+            action.resampleCount = 0;
+            g_gestureCacheMisses++;
+        }
+        action.strokeData = strokeData;
 
         if (!action.pattern.isFinished() || action.pattern.size() < 2) {
             return Hyprlang::CParseResult{};
         }
 
         g_gestureActions.push_back(action);
+        invalidateGestureLibrary();
 
     } catch (const std::exception& e) {
         // Silently catch errors
@@ -1463,6 +1610,163 @@ static Hyprlang::CParseResult onGestureAction(const char* COMMAND, const char* V
 // Handler to clear gesture actions on config reload
 static void onPreConfigReload() {
     g_gestureActions.clear();
+    invalidateGestureLibrary();
+
+    // Pick up the cache written after the previous reload
+    g_gestureCache.close();
+    g_gestureCacheOpened = false;
+    g_gestureCacheMisses = 0;
+}
+
+// Bring all templates to the configured point count. Runs after the
+// whole config is parsed, since resample_points may appear after the
+// gesture_action lines.
+static void resampleGestureLibrary() {
+    const int resamplePoints = getResamplePoints();
+
+    for (auto& action : g_gestureActions) {
+        try {
+            if (!action.pattern.isFinished() || action.resampleCount == resamplePoints) {
+                continue;
+            }
+
+            Stroke pattern;
+            if (g_gestureCache.lookup(action.strokeData, resamplePoints, pattern)) {
+                // Cached from an earlier reload with this point count
+            } else if (resamplePoints == 0 || action.resampleCount != 0) {
+                // Resampled to another count, start over from the config
+                pattern = Stroke::deserialize(action.strokeData);
+                g_gestureCacheMisses++;
+            } else {
+                pattern = action.pattern.resampled(resamplePoints);
+                g_gestureCacheMisses++;
+            }
+
+            if (pattern.isFinished()) {
+                action.pattern = std::move(pattern);
+                action.resampleCount = resamplePoints;
+                invalidateGestureLibrary();
+            }
+        } catch (...) {
+            // Keep the original pattern on error
+        }
+    }
+}
+
+// Recompute the trail area and damage it, together with the area it
+// covered at the last update, so fading points are redrawn and expired or
+// cleared ones erased on the next frame. Only monitors the trail touches
+// are damaged.
+static void damageTrail() {
+    if (g_gestureState.timestampedPath.empty() && !g_trailDamage.hasDamage()) {
+        return;
+    }
+
+    try {
+        g_trailDamage.update(g_gestureState.timestampedPath, getTrailCircleRadius(),
+                             [](const PathPoint& point) { return point.position; });
+
+        // The live prediction preview follows the cursor on either side
+        if (g_livePredictionIndex >= 0 && g_gestureState.rightButtonPressed &&
+            !g_gestureState.path.empty() && isLivePredictionEnabled()) {
+            constexpr double REACH = CMouseGestureOverlay::LIVE_PREVIEW_CURSOR_OFFSET +
+                                     CMouseGestureOverlay::LIVE_PREVIEW_SIZE;
+            const Vector2D cursor = g_gestureState.path.back();
+            DamageRect preview;
+            preview.include(cursor.x, cursor.y, REACH);
+            g_trailDamage.addRect(preview);
+        }
+
+        // The record mode UI under the trail is drawn with full damage
+        if (g_recordMode) {
+            damageAllMonitors();
+        } else {
+            g_trailDamage.forEachDamage(damageGlobalRect);
+        }
+    } catch (...) {
+        // Fall back to repainting everything
+        damageAllMonitors();
+    }
+}
+
+// Apply one queued motion sample to the gesture state
+static void processMotionSample(const MotionSample& sample) {
+    // Update global mouse position for hover detection in record mode
+    if (g_recordMode) {
+        g_lastMousePos = sample.pos;
+    }
+
+    if (!g_gestureState.rightButtonPressed)
+        return;
+
+    // Always record timestamped path points while button is pressed
+    // This ensures we capture the full gesture from the start
+    g_gestureState.timestampedPath.push_back({sample.pos, sample.time});
+
+    // Check if drag threshold exceeded (if not yet detected)
+    if (!g_gestureState.dragDetected) {
+        if (checkDragThresholdExceeded(sample.pos, sample.time)) {
+            g_gestureState.dragDetected = true;
+        }
+    }
+
+    // Record path point for gesture matching
+    // In record mode: always record all points from the start
+    // In normal mode: only record after drag threshold is exceeded
+    if (g_recordMode || g_gestureState.dragDetected) {
+        g_gestureState.path.push_back(sample.pos);
+    }
+}
+
+// Process the motion queued since the last frame. Called once per frame
+// from the render hook and before button events, which need an up to
+// date path.
+static void flushPendingMotion() {
+    if (g_pendingMotion.flush(processMotionSample) == 0) {
+        return;
+    }
+
+    // Keep a live prediction of the stroke drawn so far
+    if (!g_recordMode && g_gestureState.rightButtonPressed && g_gestureState.dragDetected) {
+        speculateGestureMatch();
+    }
+}
+
+// Whether any record mode animation is still running
+static bool isRecordModeAnimating() {
+    for (const auto& anims : {&g_recordAnimSize, &g_recordAnimPos}) {
+        for (const auto& [monitor, var] : *anims) {
+            if (var && var->isBeingAnimated())
+                return true;
+        }
+    }
+    for (const auto& anims : {&g_gestureScaleAnims, &g_gestureAlphaAnims}) {
+        for (const auto& [index, var] : *anims) {
+            if (var && var->isBeingAnimated())
+                return true;
+        }
+    }
+    return false;
+}
+
+// Redraw the monitors where the pointer at `pos` changes what the record
+// mode UI shows, i.e. it entered or left a gesture's hover area
+static void damageRecordHover(const Vector2D& pos) {
+    if (!g_pHyprRenderer || !g_pCompositor) {
+        return;
+    }
+
+    for (const auto& [monitor, hover] : g_recordHover) {
+        if (!monitor) {
+            continue;
+        }
+
+        const Vector2D relative = pos - monitor->m_position;
+        if (hover.hoverChanged(relative.x, relative.y)) {
+            g_pHyprRenderer->damageMonitor(monitor);
+            g_pCompositor->scheduleFrameForMonitor(monitor);
+        }
+    }
 }
 
 static void setupRenderHook() {
@@ -1477,6 +1781,13 @@ static void setupRenderHook() {
                     return;
                 }
 
+                // Catch up with the pointer motion since the last frame
+                flushPendingMotion();
+                expireTrailPoints();
+
+                // Fading points change every frame, damage them for the next
+                damageTrail();
+
                 // Detect when record mode changes and trigger damage
                 if (g_recordMode != g_lastRecordMode) {
                     g_lastRecordMode = g_recordMode;
@@ -1511,15 +1822,12 @@ static void setupRenderHook() {
                     makeUnique<CMouseGestureOverlay>(monitor)
                 );
 
-                // Only schedule next frame if we need continuous rendering:
-                // - In record mode (UI visible)
-                // - Actively dragging (button pressed and drag detected)
-                // - Trail points are still visible and fading
-                bool needsContinuousRendering = g_recordMode ||
-                    (g_gestureState.rightButtonPressed && g_gestureState.dragDetected) ||
-                    hasVisibleTrailPoints();
+                // Record mode is redrawn on change only: hover, scroll and
+                // the trail damage what they touch, animations keep frames
+                // coming until they settle
+                bool needsNextFrame = g_recordMode && isRecordModeAnimating();
 
-                if (needsContinuousRendering) {
+                if (needsNextFrame) {
                     try {
                         if (g_pCompositor) {
                             g_pCompositor->scheduleFrameForMonitor(monitor);
@@ -1543,8 +1851,74 @@ static void setupRenderHook() {
     }
 }
 
+// Recognition stats as JSON, per-gesture counts for the configured gestures
+static std::string gestureStatsJson() {
+    std::string perGesture = "[";
+    for (size_t i = 0; i < g_gestureActions.size(); i++) {
+        const auto& action = g_gestureActions[i];
+        const auto count = g_gestureMatchCounts.find(action.strokeData);
+
+        if (i > 0) {
+            perGesture += ",";
+        }
+        perGesture += "{\"index\":" + std::to_string(i) + ",\"name\":";
+        GestureStats::appendJsonString(perGesture, action.name);
+        perGesture += ",\"command\":";
+        GestureStats::appendJsonString(perGesture, action.command);
+        perGesture += ",\"matches\":" +
+            std::to_string(count != g_gestureMatchCounts.end() ? count->second : 0) + "}";
+    }
+    perGesture += "]";
+
+    return g_gestureStats.toJson(perGesture,
+                                 g_commandSpawner ? g_commandSpawner->getStats().toJson() : "{}");
+}
+
+// $XDG_RUNTIME_DIR/mouse-gestures-stats.json, falling back to /tmp
+static std::string gestureStatsPath() {
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    const std::string dir = (runtimeDir && runtimeDir[0] == '/') ? runtimeDir : "/tmp";
+    return dir + "/mouse-gestures-stats.json";
+}
+
+// `mouse-gestures stats` writes the stats file and shows the headline
+// numbers, `mouse-gestures stats reset` starts counting afresh
+static SDispatchResult dispatchGestureStats(const std::string& arg) {
+    if (arg == "stats reset") {
+        g_gestureStats.reset();
+        g_gestureMatchCounts.clear();
+        if (g_commandSpawner) {
+            g_commandSpawner->getStats().reset();
+        }
+        return {};
+    }
+
+    const std::string path = gestureStatsPath();
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << gestureStatsJson() << "\n";
+        if (!file) {
+            return {.success = false, .error = "mouse-gestures: could not write " + path};
+        }
+    }
+
+    const auto dispatch = g_gestureStats.releaseToDispatch.snapshot();
+    char summary[160];
+    std::snprintf(summary, sizeof(summary),
+                  "[mouse-gestures] %llu gestures, release to dispatch p50 %.2f ms, p99 %.2f ms",
+                  static_cast<unsigned long long>(g_gestureStats.gestures.load(std::memory_order_relaxed)),
+                  dispatch.percentile(0.50) / 1000.0, dispatch.percentile(0.99) / 1000.0);
+    HyprlandAPI::addNotification(PHANDLE, std::string(summary) + " (" + path + ")",
+                                 CHyprColor{0.2f, 0.6f, 1.0f, 1.0f}, 5000);
+    return {};
+}
+
 static SDispatchResult mouseGesturesDispatch(std::string arg) {
     try {
+        if (arg == "stats" || arg == "stats reset") {
+            return dispatchGestureStats(arg);
+        }
+
         if (arg == "record") {
             bool wasRecordMode = g_recordMode;
 
@@ -1559,7 +1933,7 @@ static SDispatchResult mouseGesturesDispatch(std::string arg) {
                 constexpr int MAX_WAIT_MS = 5000;  // 5 seconds max wait
                 constexpr int SLEEP_MS = 10;       // Check every 10ms
                 int totalWaitMs = 0;
-                while (g_fileWriteCount > 0 && totalWaitMs < MAX_WAIT_MS) {
+                while (g_configWriteQueue.busy() && totalWaitMs < MAX_WAIT_MS) {
                     std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_MS));
                     totalWaitMs += SLEEP_MS;
                 }
@@ -1567,6 +1941,7 @@ static SDispatchResult mouseGesturesDispatch(std::string arg) {
                 g_recordMode = true;
                 g_scrollOffsets.clear();
                 g_maxScrollOffsets.clear();
+                g_recordHover.clear();
 
                 // Clear any closing states
                 g_recordModeClosing.clear();
@@ -1581,21 +1956,12 @@ static SDispatchResult mouseGesturesDispatch(std::string arg) {
 
                         const Vector2D monitorSize = monitor->m_size;
 
-                        // Calculate the record square position (where we'll zoom from)
-                        constexpr float PADDING = 20.0f;
-                        const float verticalSpace = monitorSize.y - (2.0f * PADDING);
-                        constexpr int VISIBLE_GESTURES = 3;
-                        constexpr float GAP_WIDTH = 10.0f;
-                        const float totalGaps = (VISIBLE_GESTURES - 1) * GAP_WIDTH;
-                        const float baseHeight = (verticalSpace - totalGaps) / VISIBLE_GESTURES;
-                        const float gestureRectHeight = baseHeight * 0.9f;
-                        const float gestureRectWidth = gestureRectHeight;
-                        const float recordSquareSize = verticalSpace;
-                        const float totalWidth = gestureRectWidth + recordSquareSize;
-                        const float horizontalMargin = (monitorSize.x - totalWidth) / 3.0f;
-
-                        const float recordSquareX = horizontalMargin + gestureRectWidth + horizontalMargin;
-                        const float recordSquareY = PADDING;
+                        // Calculate the record square position (where we'll zoom from),
+                        // the same square the overlay draws
+                        const auto layout = RecordListLayout::forMonitor(monitorSize.x, monitorSize.y);
+                        const float recordSquareSize = layout.recordSquareSize;
+                        const float recordSquareX = layout.recordSquareX();
+                        const float recordSquareY = layout.recordSquareY();
 
                         // Calculate the center of the record square
                         const Vector2D recordCenter = Vector2D{
@@ -1705,7 +2071,7 @@ static void setupMouseButtonHook() {
                     if (static_cast<size_t>(deleteButtonIndex) <
                         g_gestureActions.size()) {
                         std::string gestureStrokeData =
-                            g_gestureActions[deleteButtonIndex].pattern.serialize();
+                            g_gestureActions[deleteButtonIndex].strokeData;
 
                         // Add to pending deletions list
                         g_pendingGestureDeletions.push_back(gestureStrokeData);
@@ -1744,6 +2110,9 @@ static void setupMouseButtonHook() {
             if (e.button != dragButton)
                 return;
 
+            // Bring the path up to date with motion not yet seen by a frame
+            flushPendingMotion();
+
             if (e.state == WL_POINTER_BUTTON_STATE_PRESSED) {
                 // Drag button pressed - record position and time
                 if (!g_pInputManager) {
@@ -1770,19 +2139,22 @@ static void setupMouseButtonHook() {
                 g_gestureState.path.push_back(mousePos);
                 g_gestureState.timestampedPath.clear();
                 g_gestureState.timestampedPath.push_back({mousePos, now});
+                damageTrail();  // Erase the previous trail
                 g_gestureState.pressTime = now;
                 g_gestureState.pressButton = dragButton;
                 g_gestureState.pressTimeMs = e.timeMs;
+                resetLivePrediction();
 
                 // Consume the press - will replay on release if no drag detected
                 info.cancelled = true;
             } else {
                 // Drag button released
                 if (g_gestureState.dragDetected) {
-                    handleGestureDetected();
+                    handleGestureDetected(std::chrono::steady_clock::now());
                 } else {
                     // No drag detected - clear trail immediately
                     g_gestureState.timestampedPath.clear();
+                    damageTrail();
                     replayButtonEvents(e.timeMs);
                 }
 
@@ -1791,6 +2163,7 @@ static void setupMouseButtonHook() {
 
                 // Reset state
                 g_gestureState.reset();
+                resetLivePrediction();
             }
         } catch (const std::exception&) {
             // Catch all exceptions to prevent crashing Hyprland
@@ -1808,38 +2181,58 @@ static void setupMouseMoveHook() {
                 return;
             }
 
+            // Motion only matters for hover in record mode and while drawing
+            if (!g_recordMode && !g_gestureState.rightButtonPressed)
+                return;
+
             const Vector2D mousePos = g_pInputManager->getMouseCoordsInternal();
 
-            // Update global mouse position for hover detection in record mode
-            if (g_recordMode) {
+            // Just hovering the record UI: only redraw when the hovered
+            // gesture changes, so no frames are queued while idle
+            if (!g_gestureState.rightButtonPressed) {
                 g_lastMousePos = mousePos;
-                damageAllMonitors(); // Trigger redraw for hover updates
-            }
-
-            if (!g_gestureState.rightButtonPressed)
+                damageRecordHover(mousePos);
                 return;
-            auto now = std::chrono::steady_clock::now();
+            }
 
-            // Always record timestamped path points while button is pressed
-            // This ensures we capture the full gesture from the start
-            g_gestureState.timestampedPath.push_back({mousePos, now});
+            // Queue the sample for the next frame. Cleanup of old points
+            // is handled in the render pass.
+            const bool firstSinceFrame =
+                g_pendingMotion.push({mousePos, std::chrono::steady_clock::now()});
 
-            // Check if drag threshold exceeded (if not yet detected)
-            if (!g_gestureState.dragDetected) {
-                if (checkDragThresholdExceeded(mousePos)) {
-                    g_gestureState.dragDetected = true;
+            if (g_recordMode) {
+                // The record UI is drawn with full damage; one per frame,
+                // the rest ride along with it
+                if (firstSinceFrame) {
+                    damageAllMonitors();
+                }
+            } else {
+                // No trail is drawn before the drag threshold is crossed.
+                // Apply the samples right away so the threshold is checked
+                // without asking for frames, and request the first frame
+                // once it is crossed.
+                bool requestFrame = firstSinceFrame;
+                if (!g_gestureState.dragDetected) {
+                    flushPendingMotion();
+                    if (!g_gestureState.dragDetected) {
+                        return;
+                    }
+                    requestFrame = true;
                 }
-            }
 
-            // Record path point for gesture matching
-            // In record mode: always record all points from the start
-            // In normal mode: only record after drag threshold is exceeded
-            if (g_recordMode || g_gestureState.dragDetected) {
-                g_gestureState.path.push_back(mousePos);
+                // One frame per vblank. The render hook damages the whole
+                // trail, including the circles of samples queued after this.
+                if (requestFrame) {
+                    DamageRect sampleRect;
+                    sampleRect.include(mousePos.x, mousePos.y, getTrailCircleRadius());
+                    damageGlobalRect(sampleRect);
 
-                // Damage all monitors to trigger redraw with new trail
-                // Cleanup of old points is handled in the render pass
-                damageAllMonitors();
+                    if (g_pCompositor) {
+                        if (auto monitor = g_pCompositor->getMonitorFromVector(mousePos)) {
+                            g_pCompositor->scheduleFrameForMonitor(monitor);
+                        }
+                    }
+                }
             }
         } catch (const std::exception&) {
             // Catch all exceptions to prevent crashing Hyprland
@@ -1899,87 +2292,190 @@ static void setupMouseAxisHook() {
     });
 }
 
-// Helper function to convert pixel data to RGBA format
-static std::vector<uint8_t> convertPixelDataToRGBA(const guchar* pixels, int width, int height,
-                                                    int channels, int stride) {
-    std::vector<uint8_t> pixelData(width * height * 4);
-
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            const guchar* src = pixels + y * stride + x * channels;
-            uint8_t* dst = pixelData.data() + (y * width + x) * 4;
-
-            if (channels == 4) {
-                // RGBA format
-                dst[0] = src[0];  // R
-                dst[1] = src[1];  // G
-                dst[2] = src[2];  // B
-                dst[3] = src[3];  // A
-            } else if (channels == 3) {
-                // RGB format - add alpha channel
-                dst[0] = src[0];  // R
-                dst[1] = src[1];  // G
-                dst[2] = src[2];  // B
-                dst[3] = 255;     // A (fully opaque)
-            }
-        }
+// Decode the image at `path` to RGBA, on the loader's worker thread
+static std::optional<BackgroundImage> decodeBackgroundImage(const std::string& path) {
+    GError* error = nullptr;
+    GdkPixbuf* pixbuf = gdk_pixbuf_new_from_file(path.c_str(), &error);
+
+    if (!pixbuf) {
+        if (error)
+            g_error_free(error);
+        return std::nullopt;
+    }
+
+    const int width = gdk_pixbuf_get_width(pixbuf);
+    const int height = gdk_pixbuf_get_height(pixbuf);
+    const int channels = gdk_pixbuf_get_n_channels(pixbuf);
+
+    if (channels != 3 && channels != 4) {
+        g_object_unref(pixbuf);
+        return std::nullopt;
     }
 
-    return pixelData;
+    const int stride = gdk_pixbuf_get_rowstride(pixbuf);
+    const guchar* pixels = gdk_pixbuf_get_pixels(pixbuf);
+
+    BackgroundImage image;
+    image.width = width;
+    image.height = height;
+    image.rgba.resize(static_cast<size_t>(width) * height * 4);
+    PixelFormat::toRGBA(pixels, stride, channels, image.rgba.data(), static_cast<size_t>(width) * 4,
+                        width, height);
+    g_object_unref(pixbuf);
+
+    return image;
 }
 
 // Helper function to create texture from pixel data
-static bool createTextureFromPixelData(const std::vector<uint8_t>& pixelData,
-                                       int width, int height) {
+static SP<Render::ITexture> createTextureFromPixelData(const std::vector<uint8_t>& pixelData,
+                                                       int width, int height) {
     const uint32_t drmFormat = DRM_FORMAT_ABGR8888;
     const uint32_t textureStride = width * 4;
 
     try {
         auto* pixels = const_cast<uint8_t*>(pixelData.data());
-        g_pBackgroundTexture = makeShared<Render::GL::CGLTexture>(drmFormat, pixels, textureStride,
-                                                     Vector2D{(double)width, (double)height},
-                                                     true);
-        return true;
+        return makeShared<Render::GL::CGLTexture>(drmFormat, pixels, textureStride,
+                                                  Vector2D{(double)width, (double)height},
+                                                  true);
     } catch (const std::exception&) {
-        g_pBackgroundTexture.reset();
-        return false;
+        return nullptr;
     }
 }
 
-// Load background image from file path
-static void loadBackgroundImage(const std::string& path) {
-    if (path.empty()) {
-        g_pBackgroundTexture.reset();
-        return;
+// Pixel size the overlay covers on `monitor`
+static BackgroundSize backgroundSizeFor(const PHLMONITOR& monitor) {
+    return {static_cast<int>(std::round(monitor->m_size.x * monitor->m_scale)),
+            static_cast<int>(std::round(monitor->m_size.y * monitor->m_scale))};
+}
+
+static std::vector<BackgroundSize> backgroundSizesOfMonitors() {
+    std::vector<BackgroundSize> sizes;
+    if (!g_pCompositor) {
+        return sizes;
     }
 
-    GError* error = nullptr;
-    GdkPixbuf* pixbuf = gdk_pixbuf_new_from_file(path.c_str(), &error);
+    for (auto& monitor : g_pCompositor->m_monitors) {
+        if (monitor) {
+            sizes.push_back(backgroundSizeFor(monitor));
+        }
+    }
+    return sizes;
+}
 
-    if (!pixbuf) {
-        if (error)
-            g_error_free(error);
-        g_pBackgroundTexture.reset();
-        return;
+// The background texture for `monitor`, already cropped and scaled to its
+// pixel size. nullptr while it is still being made.
+SP<Render::ITexture> backgroundTextureFor(PHLMONITOR monitor) {
+    if (!monitor || !g_backgroundLoader) {
+        return nullptr;
     }
 
-    const int width = gdk_pixbuf_get_width(pixbuf);
-    const int height = gdk_pixbuf_get_height(pixbuf);
-    const int channels = gdk_pixbuf_get_n_channels(pixbuf);
+    const BackgroundSize size = backgroundSizeFor(monitor);
+    auto it = g_backgroundTextures.find(size.key());
+    if (it != g_backgroundTextures.end()) {
+        return it->second;
+    }
 
-    if (channels != 3 && channels != 4) {
-        g_object_unref(pixbuf);
-        g_pBackgroundTexture.reset();
-        return;
+    // A new output or mode; the loader ignores sizes it already has
+    g_backgroundLoader->request(size);
+    return nullptr;
+}
+
+// Upload the variants the loader finished
+static int onBackgroundReady(int fd, uint32_t mask, void* data) {
+    if (!g_backgroundLoader) {
+        return 0;
     }
 
-    const int stride = gdk_pixbuf_get_rowstride(pixbuf);
-    const guchar* pixels = gdk_pixbuf_get_pixels(pixbuf);
+    auto results = g_backgroundLoader->takeResults();
+    if (results.empty() || g_pluginShuttingDown) {
+        return 0;
+    }
 
-    auto pixelData = convertPixelDataToRGBA(pixels, width, height, channels, stride);
-    g_object_unref(pixbuf);
+    try {
+        if (g_pHyprRenderer) {
+            g_pHyprRenderer->makeEGLCurrent();
+        }
+
+        for (const auto& result : results) {
+            // The first result of a new image replaces the old one
+            if (result.generation != g_backgroundGeneration) {
+                g_backgroundTextures.clear();
+                g_backgroundGeneration = result.generation;
+            }
+
+            if (result.failed) {
+                continue;
+            }
+
+            auto texture = createTextureFromPixelData(result.image.rgba, result.image.width,
+                                                      result.image.height);
+            if (texture) {
+                g_backgroundTextures[result.output.key()] = texture;
+            }
+        }
+    } catch (...) {
+        // Keep whatever was uploaded
+    }
+
+    if (g_recordMode) {
+        damageAllMonitors();
+    }
+    return 0;
+}
+
+static void startBackgroundLoader() {
+    try {
+        g_backgroundLoader = std::make_unique<BackgroundLoader>(decodeBackgroundImage);
+        if (!g_pCompositor || !g_pCompositor->m_wlEventLoop || g_backgroundLoader->pollFd() < 0) {
+            g_backgroundLoader.reset();
+            return;
+        }
+
+        g_backgroundEventSource = wl_event_loop_add_fd(g_pCompositor->m_wlEventLoop,
+                                                       g_backgroundLoader->pollFd(),
+                                                       WL_EVENT_READABLE,
+                                                       onBackgroundReady, nullptr);
+        if (!g_backgroundEventSource) {
+            g_backgroundLoader.reset();
+        }
+    } catch (...) {
+        g_backgroundLoader.reset();
+    }
+}
+
+// Join the worker before its eventfd goes away
+static void stopBackgroundLoader() {
+    if (g_backgroundLoader) {
+        g_backgroundLoader->shutdown();
+    }
+    if (g_backgroundEventSource) {
+        wl_event_source_remove(g_backgroundEventSource);
+        g_backgroundEventSource = nullptr;
+    }
+    g_backgroundLoader.reset();
+}
+
+// Load background image from file path. The image is decoded and scaled
+// for every monitor in the background; the old one stays up until then.
+// Reloading the config with an unchanged image does nothing.
+static void loadBackgroundImage(const std::string& path) {
+    if (!g_backgroundLoader) {
+        return;
+    }
+
+    struct stat st{};
+    const int64_t mtime = !path.empty() && stat(path.c_str(), &st) == 0 ?
+        static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec : 0;
+    if (path == g_backgroundPath && mtime == g_backgroundMtime) {
+        return;
+    }
 
-    createTextureFromPixelData(pixelData, width, height);
+    g_backgroundPath = path;
+    g_backgroundMtime = mtime;
+    g_backgroundLoader->load(path, backgroundSizesOfMonitors());
+    if (path.empty()) {
+        g_backgroundTextures.clear();
+    }
 }
 
 
@@ -2049,6 +2545,11 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
         "plugin:mouse_gestures:enable_ascii_art_comments",
         Hyprlang::STRING{""}
     );
+    HyprlandAPI::addConfigValue(
+        PHANDLE,
+        "plugin:mouse_gestures:config_fsync",
+        Hyprlang::INT{1}
+    ); // 0 = no fsync, 1 = fsync the file, 2 = also fsync its directory
     HyprlandAPI::addConfigValue(
         PHANDLE,
         "plugin:mouse_gestures:background_path",
@@ -2059,6 +2560,40 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
         "plugin:mouse_gestures:delete_gesture_button",
         Hyprlang::INT{272}
     ); // BTN_LEFT
+    HyprlandAPI::addConfigValue(
+        PHANDLE,
+        "plugin:mouse_gestures:resample_points",
+        Hyprlang::INT{0}
+    ); // 0 = use raw motion events
+    HyprlandAPI::addConfigValue(
+        PHANDLE,
+        "plugin:mouse_gestures:prefilter_distance",
+        Hyprlang::FLOAT{0.0}
+    ); // 0 = run the DP for every template
+
+    HyprlandAPI::addConfigValue(
+        PHANDLE,
+        "plugin:mouse_gestures:live_prediction",
+        Hyprlang::INT{0}
+    ); // 1 = show the gesture that would fire next to the cursor
+
+    HyprlandAPI::addConfigValue(
+        PHANDLE,
+        "plugin:mouse_gestures:direct_dispatch",
+        Hyprlang::INT{1}
+    ); // 0 = run "hyprctl dispatch" commands through the shell too
+
+    HyprlandAPI::addConfigValue(
+        PHANDLE,
+        "plugin:mouse_gestures:compact_stroke_encoding",
+        Hyprlang::INT{1}
+    ); // 0 = record new gestures as plain x,y; pairs
+
+    HyprlandAPI::addConfigValue(
+        PHANDLE,
+        "plugin:mouse_gestures:gesture_cache",
+        Hyprlang::INT{1}
+    ); // 0 = parse every gesture on reload, no cache file
 
     // Register config keyword for gesture_action
     HyprlandAPI::addConfigKeyword(
@@ -2076,6 +2611,12 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     // Register configReloaded handler
     static auto configReloadedHook = Event::bus()->m_events.config.reloaded.listen(
         []() {
+            // Resample templates now that all config values are known
+            resampleGestureLibrary();
+
+            // Cache the finished templates for the next reload
+            saveGestureCache();
+
             // Detect which config file is being used
             detectConfigFilePath();
 
@@ -2094,6 +2635,16 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
         }
     );
 
+    // The reload below loads the background image through it
+    startBackgroundLoader();
+
+    // Index the config files before the reload looks for the active one
+    try {
+        g_configIndex = std::make_unique<ConfigFileIndex>(gestureConfigCandidates());
+    } catch (...) {
+        g_configIndex.reset();
+    }
+
     // Reload config to apply registered values
     HyprlandAPI::reloadConfig();
 
@@ -2105,6 +2656,8 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     setupMouseAxisHook();
     setupRenderHook();
 
+    startMatchPool();
+    startCommandSpawner();
 
     return {"mouse-gestures", "Mouse gestures for Hyprland", "cmihail", "1.0"};
 }
@@ -2118,21 +2671,11 @@ APICALL EXPORT void PLUGIN_EXIT() {
         // Exit record mode to prevent overlay rendering
         g_recordMode = false;
 
-        // Process any pending gesture changes synchronously before exit
-        // Lock the mutex to ensure no background threads are writing
-        {
-            std::lock_guard<std::mutex> lock(g_fileWriteMutex);
-            if (!g_pendingGestureAdditions.empty()) {
-                for (const auto& strokeData : g_pendingGestureAdditions) {
-                    addGestureToConfig(strokeData);
-                }
-                g_pendingGestureAdditions.clear();
-            }
-            if (!g_pendingGestureDeletions.empty()) {
-                batchDeleteGesturesFromConfig(g_pendingGestureDeletions);
-                g_pendingGestureDeletions.clear();
-            }
-        }
+        // Write any pending gesture changes before exit, the writer
+        // finishes everything queued before it stops
+        processPendingGestureChanges();
+        g_configWriteQueue.shutdown();
+        g_configIndex.reset();
 
         // Unhook all event handlers to prevent callbacks from running
         // during cleanup. This automatically unregisters the callbacks.
@@ -2141,20 +2684,34 @@ APICALL EXPORT void PLUGIN_EXIT() {
         g_mouseAxisHook.reset();
         g_renderHook.reset();
 
+        // Wait for in-flight matches, their results are discarded
+        stopMatchPool();
+        stopCommandSpawner();
+
         // Clear gesture state after hooks are removed
         g_gestureState.timestampedPath.clear();
         g_gestureState.reset();
 
         // Clear gesture actions
         g_gestureActions.clear();
+        invalidateGestureLibrary();
 
         // Clear gesture animations
         g_gestureScaleAnims.clear();
         g_gestureAlphaAnims.clear();
         g_gesturesPendingRemoval.clear();
+        g_recordHover.clear();
 
-        // Clear background texture
-        g_pBackgroundTexture.reset();
+        // Stop decoding and drop the background textures
+        stopBackgroundLoader();
+        g_backgroundTextures.clear();
+
+        // Free the batch renderer's GL objects
+        if (g_pHyprRenderer) {
+            g_pHyprRenderer->makeEGLCurrent();
+        }
+        g_trailBatchRenderer.destroy();
+        clearOverlayCaches();
     } catch (...) {
         // Silently catch any errors during cleanup
     }
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Pointer motion samples waiting for the next frame.
+//
+// High polling rate mice deliver many motion events per refresh. Instead
+// of updating the gesture and damaging every monitor per event, samples
+// are queued here and processed once when the next frame renders. Only
+// the first sample after a flush asks for a frame, so damage and frame
+// scheduling happen at most once per frame however fast the mouse is.
+//
+// Owned by the event loop thread.
+template <typename Sample>
+class MotionBuffer {
+  public:
+    explicit MotionBuffer(size_t reserve = 256) {
+        pending.reserve(reserve);
+    }
+
+    // Queue a sample. Returns true if it is the first since the last flush,
+    // i.e. the caller has to schedule a frame to get it processed.
+    bool push(const Sample& sample) {
+        pending.push_back(sample);
+        if (framePending) {
+            return false;
+        }
+        framePending = true;
+        return true;
+    }
+
+    // Hand every queued sample to `onSample` in arrival order. Returns the
+    // number of samples processed.
+    template <typename OnSample>
+    size_t flush(OnSample&& onSample) {
+        framePending = false;
+        if (pending.empty()) {
+            return 0;
+        }
+
+        // Swap out first so onSample may push without invalidating the loop
+        processing.swap(pending);
+        for (const auto& sample : processing) {
+            onSample(sample);
+        }
+
+        const size_t count = processing.size();
+        processing.clear();
+        return count;
+    }
+
+    // Drop queued samples, e.g. when the gesture they belong to is reset
+    void clear() {
+        pending.clear();
+        framePending = false;
+    }
+
+    bool empty() const {
+        return pending.empty();
+    }
+
+    size_t size() const {
+        return pending.size();
+    }
+
+  private:
+    std::vector<Sample> pending;
+    std::vector<Sample> processing;  // Kept to reuse its capacity
+    bool framePending = false;
+};
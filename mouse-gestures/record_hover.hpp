@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+// Pointer sensitive areas of the record mode UI on one monitor, as laid
+// out by the last rendered frame, in monitor-relative coordinates.
+//
+// Record mode is only redrawn when something changes. Pointer motion
+// redraws the monitor only if it moves the hover onto a different
+// target than the one the last frame was drawn with.
+//
+// Owned by the event loop thread.
+class RecordHoverMap {
+  public:
+    static constexpr int NONE = -1;
+
+    // Start laying out a new frame
+    void beginFrame() {
+        targets.clear();
+        hovered = NONE;
+    }
+
+    // Register the box of target `id` (e.g. a gesture index). Bounds are
+    // inclusive, like the overlay's hover test.
+    void add(int id, double x, double y, double width, double height) {
+        targets.push_back({id, x, y, x + width, y + height});
+    }
+
+    // The target drawn as hovered in this frame
+    void setHovered(int id) {
+        if (hovered == NONE) {
+            hovered = id;
+        }
+    }
+
+    int renderedHover() const {
+        return hovered;
+    }
+
+    // Target under (x, y), NONE if there is none
+    int hitTest(double x, double y) const {
+        for (const auto& target : targets) {
+            if (x >= target.x1 && x <= target.x2 && y >= target.y1 && y <= target.y2) {
+                return target.id;
+            }
+        }
+        return NONE;
+    }
+
+    // Whether the pointer at (x, y) would be drawn differently than in
+    // the last frame
+    bool hoverChanged(double x, double y) const {
+        return hitTest(x, y) != hovered;
+    }
+
+  private:
+    struct Target {
+        int id;
+        double x1;
+        double y1;
+        double x2;
+        double y2;
+    };
+
+    std::vector<Target> targets;
+    int hovered = NONE;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Layout of the record mode UI: the gesture list on the left and the
+// record square on the right, in monitor-relative coordinates before the
+// open/close zoom. Drawing and hit testing both use it, so what is drawn
+// is what the pointer hits.
+//
+// Gestures are stacked in one column of equal squares, so the rows on
+// screen and the row under the pointer follow from the scroll offset
+// alone. Rendering and hit testing only touch those rows, however many
+// gestures are configured.
+struct RecordListLayout {
+    static constexpr float PADDING = 20.0f;
+    static constexpr float GAP_WIDTH = 10.0f;
+    static constexpr int VISIBLE_GESTURES = 3;
+    static constexpr float TEXT_HEIGHT = 80.0f;
+    static constexpr float TEXT_GAP = 20.0f;
+    static constexpr float BOTTOM_MARGIN = 20.0f;
+
+    // Delete button in the top right corner of each square
+    static constexpr float DELETE_BUTTON_SIZE = 36.0f;
+    static constexpr float DELETE_BUTTON_MARGIN = 4.0f;
+
+    float viewportHeight = 0.0f;   // Monitor height
+    float verticalSpace = 0.0f;    // Height between the top and bottom padding
+    float gestureRectSize = 0.0f;  // Width and height of a square
+    float horizontalMargin = 0.0f; // Gap left of the list, between it and the record square
+    float recordSquareSize = 0.0f; // Width and height of the record square right of the list
+
+    struct Range {
+        size_t begin = 0;
+        size_t end = 0;  // Exclusive
+
+        size_t size() const {
+            return end - begin;
+        }
+    };
+
+    static RecordListLayout forMonitor(float width, float height) {
+        RecordListLayout layout;
+        layout.viewportHeight = height;
+        layout.verticalSpace = height - (2.0f * PADDING);
+
+        const float totalGaps = (VISIBLE_GESTURES - 1) * GAP_WIDTH;
+        const float baseHeight = (layout.verticalSpace - totalGaps) / VISIBLE_GESTURES;
+        layout.gestureRectSize = baseHeight * 0.9f;
+
+        // Record square extends from below the header text to the bottom margin
+        layout.recordSquareSize = height - (PADDING + TEXT_HEIGHT + TEXT_GAP) - BOTTOM_MARGIN;
+
+        // Equal gaps left of the list, between the two and right of the square
+        layout.horizontalMargin = (width - layout.gestureRectSize - layout.recordSquareSize) / 3.0f;
+        return layout;
+    }
+
+    // Top left corner of the record square; the header text sits above it
+    float recordSquareX() const {
+        return horizontalMargin + gestureRectSize + horizontalMargin;
+    }
+
+    float recordSquareY() const {
+        return PADDING + TEXT_HEIGHT + TEXT_GAP;
+    }
+
+    // Distance between the tops of two neighbouring squares
+    float rowPitch() const {
+        return gestureRectSize + GAP_WIDTH;
+    }
+
+    // Top of square `index`
+    float rowY(size_t index, float scrollOffset) const {
+        return PADDING + index * rowPitch() - scrollOffset;
+    }
+
+    bool isRowVisible(size_t index, float scrollOffset) const {
+        const float y = rowY(index, scrollOffset);
+        return !(y + gestureRectSize < 0 || y > viewportHeight);
+    }
+
+    // Largest scroll offset for `count` gestures
+    float maxScrollOffset(size_t count) const {
+        if (count <= static_cast<size_t>(VISIBLE_GESTURES)) {
+            return 0.0f;
+        }
+        return count * rowPitch() - verticalSpace;
+    }
+
+    // Rows of `count` gestures at least partly on screen
+    Range visibleRange(size_t count, float scrollOffset) const {
+        const float pitch = rowPitch();
+        if (count == 0 || pitch <= 0.0f) {
+            return {};
+        }
+
+        const float first = std::ceil((scrollOffset - PADDING - gestureRectSize) / pitch);
+        const float last = std::floor((viewportHeight + scrollOffset - PADDING) / pitch);
+        Range range;
+        range.begin = static_cast<size_t>(std::clamp(first, 0.0f, static_cast<float>(count)));
+        range.end = static_cast<size_t>(std::clamp(last + 1.0f, 0.0f, static_cast<float>(count)));
+
+        // The estimate can be a row off where float rounding lands right on
+        // an edge; settle it with the exact per-row test
+        while (range.begin > 0 && isRowVisible(range.begin - 1, scrollOffset)) {
+            range.begin--;
+        }
+        while (range.begin < count && !isRowVisible(range.begin, scrollOffset)) {
+            range.begin++;
+        }
+        range.end = std::max(range.end, range.begin);
+        while (range.end < count && isRowVisible(range.end, scrollOffset)) {
+            range.end++;
+        }
+        while (range.end > range.begin && !isRowVisible(range.end - 1, scrollOffset)) {
+            range.end--;
+        }
+        return range;
+    }
+
+    // Visible gesture whose delete button contains (x, y), -1 if none.
+    // Bounds are inclusive, like the hover test.
+    int deleteButtonAt(float x, float y, size_t count, float scrollOffset) const {
+        const float buttonX = horizontalMargin + gestureRectSize - DELETE_BUTTON_SIZE - DELETE_BUTTON_MARGIN;
+        if (x < buttonX || x > buttonX + DELETE_BUTTON_SIZE || count == 0 || rowPitch() <= 0.0f) {
+            return -1;
+        }
+
+        // Only the row the point falls into and its neighbours can be hit
+        const float row = std::floor((y + scrollOffset - PADDING - DELETE_BUTTON_MARGIN) / rowPitch());
+        const float firstCandidate = std::max(0.0f, row - 1.0f);
+        if (firstCandidate >= static_cast<float>(count)) {
+            return -1;
+        }
+
+        const size_t begin = static_cast<size_t>(firstCandidate);
+        const size_t end = std::min(count, begin + 3);
+        for (size_t i = begin; i < end; i++) {
+            if (!isRowVisible(i, scrollOffset)) {
+                continue;
+            }
+            const float buttonY = rowY(i, scrollOffset) + DELETE_BUTTON_MARGIN;
+            if (y >= buttonY && y <= buttonY + DELETE_BUTTON_SIZE) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+};
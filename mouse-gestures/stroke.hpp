@@ -15,6 +15,10 @@
 #include <cassert>
 #include <algorithm>
 #include <limits>
+#include <array>
+#include <string_view>
+#include "stroke_codec.hpp"
+#include "stroke_simd.hpp"
 
 constexpr double STROKE_INFINITY = 0.2;
 constexpr double EPS = 0.000001;
@@ -27,90 +31,292 @@ struct Point {
     double alpha;  // Angle in range [-1, 1] (normalized by PI)
 };
 
+// Cheap shape signature of a finished stroke, used to rank and prefilter
+// templates before running the DP. Directions are angles normalized by
+// PI like Point::alpha.
+struct StrokeFeatures {
+    static constexpr int HISTOGRAM_BINS = 8;
+
+    double startDir = 0.0;   // Direction over the first fifth of the stroke
+    double endDir = 0.0;     // Direction over the last fifth of the stroke
+    double aspect = 0.0;     // Bounding box short side / long side, [0, 1]
+    std::array<float, HISTOGRAM_BINS> histogram{};  // Direction histogram by arc length
+    int turns = 0;           // Direction changes larger than 45 degrees
+
+    // Distance in [0, 1], the mean of the per-feature differences
+    static double distance(const StrokeFeatures& a, const StrokeFeatures& b) {
+        auto angleDelta = [](double alpha, double beta) {
+            double d = alpha - beta;
+            if (d < -1.0)
+                d += 2.0;
+            else if (d > 1.0)
+                d -= 2.0;
+            return std::abs(d);
+        };
+
+        double histogramDelta = 0.0;
+        for (int i = 0; i < HISTOGRAM_BINS; i++) {
+            histogramDelta += std::abs(a.histogram[i] - b.histogram[i]);
+        }
+
+        const int maxTurns = std::max({a.turns, b.turns, 1});
+
+        return (angleDelta(a.startDir, b.startDir) +
+                angleDelta(a.endDir, b.endDir) +
+                std::abs(a.aspect - b.aspect) +
+                histogramDelta / 2.0 +
+                static_cast<double>(std::abs(a.turns - b.turns)) / maxTurns) / 5.0;
+    }
+};
+
+// Scratch buffers for Stroke::compare, kept across calls so the DP does
+// not allocate once the buffers have grown to the largest stroke pair.
+// Stroke::compare without a workspace uses a thread-local instance.
+class StrokeCompareWorkspace {
+public:
+    // Record DP predecessors in getPrevX()/getPrevY() for path recovery.
+    // Off by default since matching only needs the final cost.
+    bool backtrace = false;
+
+    const std::vector<int>& getPrevX() const { return prev_x; }
+    const std::vector<int>& getPrevY() const { return prev_y; }
+    size_t capacity() const { return dist.capacity(); }
+
+private:
+    friend class Stroke;
+
+    std::vector<double> dist;
+    std::vector<int> prev_x;
+    std::vector<int> prev_y;
+
+    // Gathered angle pairs and weights of one DP step
+    std::vector<StrokeScalar> runA;
+    std::vector<StrokeScalar> runB;
+    std::vector<StrokeScalar> runW;
+
+    // assign() reuses existing capacity, so this only allocates on growth
+    void prepare(size_t cells, size_t maxRun, double limit) {
+        dist.assign(cells, limit);
+        if (runA.size() < maxRun) {
+            runA.resize(maxRun);
+            runB.resize(maxRun);
+            runW.resize(maxRun);
+        }
+        if (backtrace) {
+            prev_x.assign(cells, 0);
+            prev_y.assign(cells, 0);
+        }
+    }
+};
+
 class Stroke {
 private:
     std::vector<Point> points;
     bool finished = false;
 
-    static inline double angleDifference(double alpha, double beta) {
-        double d = alpha - beta;
-        if (d < -1.0)
-            d += 2.0;
-        else if (d > 1.0)
-            d -= 2.0;
-        return d;
-    }
-
-    static inline double sqr(double x) {
-        return x * x;
-    }
+    // Structure-of-arrays copy of the fields the DP reads, built by finish()
+    std::vector<StrokeScalar> ts;      // Arc-length parameter per point
+    std::vector<StrokeScalar> alphas;  // Angle per point
+    StrokeFeatures features;
 
     static inline void step(
         const Stroke& a, const Stroke& b, const int N,
-        std::vector<double>& dist,
-        std::vector<int>& prev_x, std::vector<int>& prev_y,
+        StrokeCompareWorkspace& ws,
+        double* dist, int* prev_x, int* prev_y,
         const int x, const int y,
         const double tx, const double ty,
         int& k,
-        const int x2, const int y2
+        const int x2, const int y2,
+        const double limit, int& live
     ) {
+        const int sizeA = a.ts.size();
+        const int sizeB = b.ts.size();
+
         // Bounds checking
-        if (x2 >= (int)a.points.size() || y2 >= (int)b.points.size()) {
+        if (x2 >= sizeA || y2 >= sizeB) {
             return;
         }
 
-        double dtx = a.points[x2].t - tx;
-        double dty = b.points[y2].t - ty;
+        double dtx = a.ts[x2] - tx;
+        double dty = b.ts[y2] - ty;
         if (dtx >= dty * 2.2 || dty >= dtx * 2.2 || dtx < EPS || dty < EPS)
             return;
         k++;
 
-        double d = 0.0;
+        // Walk both strokes in parallel and gather the angle pairs and
+        // their weights, then sum the run in one vectorized pass
+        StrokeScalar* runA = ws.runA.data();
+        StrokeScalar* runB = ws.runB.data();
+        StrokeScalar* runW = ws.runW.data();
+        int run = 0;
+
         int i = x, j = y;
-        double next_tx = (a.points[i + 1].t - tx) / dtx;
-        double next_ty = (b.points[j + 1].t - ty) / dty;
+        double next_tx = (a.ts[i + 1] - tx) / dtx;
+        double next_ty = (b.ts[j + 1] - ty) / dty;
         double cur_t = 0.0;
 
         for (;;) {
             // Bounds checking
-            if (i >= (int)a.points.size() || j >= (int)b.points.size()) {
+            if (i >= sizeA || j >= sizeB) {
                 break;
             }
 
-            double ad = sqr(angleDifference(
-                a.points[i].alpha,
-                b.points[j].alpha
-            ));
             double next_t = std::min(next_tx, next_ty);
             bool done = next_t >= 1.0 - EPS;
             if (done)
                 next_t = 1.0;
-            d += (next_t - cur_t) * ad;
+            runA[run] = a.alphas[i];
+            runB[run] = b.alphas[j];
+            runW[run] = next_t - cur_t;
+            run++;
             if (done)
                 break;
             cur_t = next_t;
             if (next_tx < next_ty) {
                 i++;
-                if (i + 1 >= (int)a.points.size())
+                if (i + 1 >= sizeA)
                     break;
-                next_tx = (a.points[i + 1].t - tx) / dtx;
+                next_tx = (a.ts[i + 1] - tx) / dtx;
             } else {
                 j++;
-                if (j + 1 >= (int)b.points.size())
+                if (j + 1 >= sizeB)
                     break;
-                next_ty = (b.points[j + 1].t - ty) / dty;
+                next_ty = (b.ts[j + 1] - ty) / dty;
             }
         }
+        double d = StrokeKernel::angleCost(runA, runB, runW, run);
         double new_dist = dist[x * N + y] + d * (dtx + dty);
 
         if (new_dist >= dist[x2 * N + y2])
             return;
 
-        prev_x[x2 * N + y2] = x;
-        prev_y[x2 * N + y2] = y;
+        // Cell drops below the limit for the first time
+        if (dist[x2 * N + y2] >= limit)
+            live++;
+
+        if (prev_x) {
+            prev_x[x2 * N + y2] = x;
+            prev_y[x2 * N + y2] = y;
+        }
         dist[x2 * N + y2] = new_dist;
     }
 
+    // Replace points with `count` points evenly spaced along the polyline
+    void resampleByArcLength(int count) {
+        const int n = points.size() - 1;
+
+        std::vector<double> lengths(points.size());
+        lengths[0] = 0.0;
+        for (int i = 0; i < n; i++) {
+            lengths[i + 1] = lengths[i] + std::hypot(points[i + 1].x - points[i].x,
+                                                     points[i + 1].y - points[i].y);
+        }
+
+        const double total = lengths[n];
+        if (total < EPS) {
+            return;
+        }
+
+        std::vector<Point> samples;
+        samples.reserve(count);
+
+        int segment = 0;
+        for (int k = 0; k < count; k++) {
+            const double target = total * k / (count - 1);
+            while (segment < n - 1 && lengths[segment + 1] < target) {
+                segment++;
+            }
+
+            const double segmentLength = lengths[segment + 1] - lengths[segment];
+            double f = segmentLength > 0.0 ? (target - lengths[segment]) / segmentLength : 0.0;
+            f = std::clamp(f, 0.0, 1.0);
+
+            const Point& p0 = points[segment];
+            const Point& p1 = points[segment + 1];
+            samples.push_back({p0.x + (p1.x - p0.x) * f,
+                                 p0.y + (p1.y - p0.y) * f,
+                                 0.0, 0.0, 0.0});
+        }
+
+        points = std::move(samples);
+    }
+
+    // Signature from the normalized points, sampled at equal arc length
+    // steps so that dense and sparse recordings of a shape agree
+    void computeFeatures() {
+        constexpr int STEPS = 16;
+        const int n = points.size() - 1;
+
+        std::array<double, STEPS + 1> xs{};
+        std::array<double, STEPS + 1> ys{};
+        int segment = 0;
+        for (int k = 0; k <= STEPS; k++) {
+            const double target = static_cast<double>(k) / STEPS;
+            while (segment < n - 1 && points[segment + 1].t < target) {
+                segment++;
+            }
+            const double span = points[segment + 1].t - points[segment].t;
+            double f = span > 0.0 ? (target - points[segment].t) / span : 0.0;
+            f = std::clamp(f, 0.0, 1.0);
+            xs[k] = points[segment].x + (points[segment + 1].x - points[segment].x) * f;
+            ys[k] = points[segment].y + (points[segment + 1].y - points[segment].y) * f;
+        }
+
+        auto direction = [&](int from, int to) {
+            return std::atan2(ys[to] - ys[from], xs[to] - xs[from]) / M_PI;
+        };
+
+        features = StrokeFeatures{};
+        features.startDir = direction(0, STEPS / 5);
+        features.endDir = direction(STEPS - STEPS / 5, STEPS);
+
+        double minX = xs[0], maxX = xs[0], minY = ys[0], maxY = ys[0];
+        for (int k = 1; k <= STEPS; k++) {
+            minX = std::min(minX, xs[k]);
+            maxX = std::max(maxX, xs[k]);
+            minY = std::min(minY, ys[k]);
+            maxY = std::max(maxY, ys[k]);
+        }
+        const double longSide = std::max(maxX - minX, maxY - minY);
+        features.aspect = longSide > EPS ? std::min(maxX - minX, maxY - minY) / longSide : 0.0;
+
+        double reference = direction(0, 1);
+        for (int k = 0; k < STEPS; k++) {
+            const double heading = direction(k, k + 1);
+
+            // Map [-1, 1] onto circular bins centred on the cardinal and
+            // diagonal directions, bin 0 at angle -PI. Each step is split
+            // between the two nearest bins, so a slightly tilted line
+            // doesn't flip to a neighbouring bin.
+            const double position = (heading + 1.0) / 2.0 * StrokeFeatures::HISTOGRAM_BINS;
+            const double lower = std::floor(position);
+            const double upperWeight = position - lower;
+            const int bin = static_cast<int>(lower) % StrokeFeatures::HISTOGRAM_BINS;
+            const int next = (bin + 1) % StrokeFeatures::HISTOGRAM_BINS;
+            features.histogram[bin] += static_cast<float>((1.0 - upperWeight) / STEPS);
+            features.histogram[next] += static_cast<float>(upperWeight / STEPS);
+
+            double change = heading - reference;
+            if (change < -1.0)
+                change += 2.0;
+            else if (change > 1.0)
+                change -= 2.0;
+            if (std::abs(change) > 0.25) {
+                features.turns++;
+                reference = heading;
+            }
+        }
+    }
+
+    void buildArrays() {
+        ts.resize(points.size());
+        alphas.resize(points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            ts[i] = static_cast<StrokeScalar>(points[i].t);
+            alphas[i] = static_cast<StrokeScalar>(points[i].alpha);
+        }
+    }
+
 public:
     Stroke() = default;
 
@@ -122,12 +328,20 @@ public:
         return true;
     }
 
-    bool finish() {
+    // Finish the stroke and compute the matching data.
+    // With resampleCount >= 2 the raw points are first replaced by that
+    // many points evenly spaced by arc length, so the DP cost no longer
+    // depends on how many motion events the pointer produced.
+    bool finish(int resampleCount = 0) {
         if (finished || points.size() < 2) {
             return false;
         }
         finished = true;
 
+        if (resampleCount >= 2) {
+            resampleByArcLength(resampleCount);
+        }
+
         const int n = points.size() - 1;
 
         // Calculate arc-length parametrization
@@ -174,6 +388,9 @@ public:
             points[i].alpha = std::atan2(dy, dx) / M_PI;
         }
 
+        buildArrays();
+        computeFeatures();
+
         return true;
     }
 
@@ -181,65 +398,126 @@ public:
     // Returns cost (lower is better, < STROKE_INFINITY means match)
     // Returns STROKE_INFINITY on error
     double compare(const Stroke& other) const {
+        return compare(other, STROKE_INFINITY);
+    }
+
+    // Bounded comparison for matching against a library of templates.
+    // Paths whose partial cost reaches `bound` are pruned, and the DP is
+    // abandoned as soon as no cell below the bound is left to expand.
+    // The result is exact when it is below `bound`; otherwise a value
+    // >= min(bound, STROKE_INFINITY) is returned.
+    double compare(const Stroke& other, double bound) const {
+        static thread_local StrokeCompareWorkspace workspace;
+        return compare(other, bound, workspace);
+    }
+
+    // Bounded comparison using caller-provided scratch buffers
+    double compare(const Stroke& other, double bound,
+                   StrokeCompareWorkspace& workspace) const {
         if (!finished || !other.finished || points.empty() || other.points.empty()) {
             return STROKE_INFINITY;
         }
 
+        const double limit = std::min(bound, STROKE_INFINITY);
+        if (limit <= 0.0) {
+            return limit;
+        }
+
         const int M = points.size();
         const int N = other.points.size();
         const int m = M - 1;
         const int n = N - 1;
 
-        std::vector<double> dist(M * N, STROKE_INFINITY);
-        std::vector<int> prev_x(M * N);
-        std::vector<int> prev_y(M * N);
+        workspace.prepare(M * N, M + N, limit);
+        double* dist = workspace.dist.data();
+        int* prev_x = workspace.backtrace ? workspace.prev_x.data() : nullptr;
+        int* prev_y = workspace.backtrace ? workspace.prev_y.data() : nullptr;
 
         dist[0] = 0.0;
 
+        // Number of cells below the limit that have not been expanded yet.
+        // Steps only move to higher x, so once a row is done its cells can
+        // never be reached again.
+        int live = 1;
+
         for (int x = 0; x < m; x++) {
+            int rowLive = 0;
             for (int y = 0; y < n; y++) {
-                if (dist[x * N + y] >= STROKE_INFINITY)
+                if (dist[x * N + y] >= limit)
                     continue;
+                rowLive++;
 
-                double tx = points[x].t;
-                double ty = other.points[y].t;
+                double tx = ts[x];
+                double ty = other.ts[y];
                 int max_x = x;
                 int max_y = y;
                 int k = 0;
 
                 while (k < 4) {
-                    if (points[max_x + 1].t - tx >
-                        other.points[max_y + 1].t - ty) {
+                    if (ts[max_x + 1] - tx >
+                        other.ts[max_y + 1] - ty) {
                         max_y++;
                         if (max_y == n) {
-                            step(*this, other, N, dist, prev_x, prev_y,
-                                 x, y, tx, ty, k, m, n);
+                            step(*this, other, N, workspace, dist, prev_x, prev_y,
+                                 x, y, tx, ty, k, m, n, limit, live);
                             break;
                         }
                         for (int x2 = x + 1; x2 <= max_x; x2++)
-                            step(*this, other, N, dist, prev_x, prev_y,
-                                 x, y, tx, ty, k, x2, max_y);
+                            step(*this, other, N, workspace, dist, prev_x, prev_y,
+                                 x, y, tx, ty, k, x2, max_y, limit, live);
                     } else {
                         max_x++;
                         if (max_x == m) {
-                            step(*this, other, N, dist, prev_x, prev_y,
-                                 x, y, tx, ty, k, m, n);
+                            step(*this, other, N, workspace, dist, prev_x, prev_y,
+                                 x, y, tx, ty, k, m, n, limit, live);
                             break;
                         }
                         for (int y2 = y + 1; y2 <= max_y; y2++)
-                            step(*this, other, N, dist, prev_x, prev_y,
-                                 x, y, tx, ty, k, max_x, y2);
+                            step(*this, other, N, workspace, dist, prev_x, prev_y,
+                                 x, y, tx, ty, k, max_x, y2, limit, live);
                     }
                 }
             }
+
+            live -= rowLive;
+            if (live <= 0)
+                return limit;
         }
 
         return dist[M * N - 1];
     }
 
+    // Restore a stroke finished earlier, e.g. loaded from the gesture
+    // cache. `points` and `features` must come from a finished stroke;
+    // the normalization in finish() is skipped.
+    static Stroke restoreFinished(std::vector<Point> points, const StrokeFeatures& features) {
+        Stroke stroke;
+        if (points.size() < 2) {
+            return stroke;
+        }
+        stroke.points = std::move(points);
+        stroke.features = features;
+        stroke.finished = true;
+        stroke.buildArrays();
+        return stroke;
+    }
+
+    // Copy of this stroke resampled to `count` points by arc length.
+    // Works on finished strokes since normalization preserves arc length
+    // ratios; returns an unfinished stroke if there are too few points.
+    Stroke resampled(int count) const {
+        Stroke result;
+        for (const auto& p : points) {
+            result.addPoint(p.x, p.y);
+        }
+        result.finish(count);
+        return result;
+    }
+
     size_t size() const { return points.size(); }
     bool isFinished() const { return finished; }
     const std::vector<Point>& getPoints() const { return points; }
+    const StrokeFeatures& getFeatures() const { return features; }
 
     // Serialize stroke to string for configuration
     std::string serialize() const {
@@ -251,40 +529,36 @@ public:
         return result;
     }
 
-    // Deserialize stroke from string
+    // Serialize stroke in the compact "v1:" format, see stroke_codec.hpp
+    std::string serializeCompact() const {
+        return StrokeCodec::encodeCompact(points);
+    }
+
+    // Deserialize stroke from either format
     // Returns empty stroke on error
-    static Stroke deserialize(const std::string& data) {
+    static Stroke deserialize(std::string_view data, int resampleCount = 0) {
         Stroke stroke;
-        try {
-            size_t pos = 0;
-            while (pos < data.size()) {
-                size_t comma = data.find(',', pos);
-                size_t semi = data.find(';', pos);
-                if (comma == std::string::npos || semi == std::string::npos)
-                    break;
-
-                // Check bounds
-                if (comma >= data.size() || semi >= data.size() ||
-                    comma <= pos || semi <= comma) {
-                    break;
-                }
-
-                double x = std::stod(data.substr(pos, comma - pos));
-                double y = std::stod(data.substr(comma + 1, semi - comma - 1));
-
-                // Validate coordinates (should be reasonable screen coords)
-                if (!std::isfinite(x) || !std::isfinite(y)) {
-                    return Stroke();
-                }
+        auto addPoint = [&stroke](double x, double y) {
+            // Validate coordinates (should be reasonable screen coords)
+            if (!std::isfinite(x) || !std::isfinite(y)) {
+                return false;
+            }
+            return stroke.addPoint(x, y);
+        };
 
-                if (!stroke.addPoint(x, y)) {
+        try {
+            if (StrokeCodec::isCompact(data)) {
+                // Four bytes per point, four characters per three bytes
+                stroke.points.reserve((data.size() - StrokeCodec::COMPACT_PREFIX.size()) * 3 / 16);
+                if (!StrokeCodec::decodeCompact(data, addPoint)) {
                     return Stroke();
                 }
-
-                pos = semi + 1;
+            } else if (StrokeCodec::decodeLegacy(data, addPoint) != StrokeCodec::LegacyResult::Ok) {
+                return Stroke();
             }
+
             if (stroke.size() > 1) {
-                if (!stroke.finish()) {
+                if (!stroke.finish(resampleCount)) {
                     return Stroke();
                 }
             }
@@ -0,0 +1,210 @@
+#pragma once
+
+// Text encodings of stroke points as stored in gesture_action lines.
+//
+// Legacy: "x,y;x,y;..." with six decimals per coordinate.
+// Compact: "v1:" followed by unpadded base64url of little-endian 16-bit
+// (x, y) pairs, quantized over the bounding box of the stroke. Strokes
+// are renormalized when finished, so only the shape has to survive.
+//
+// Both decoders are allocation-free and report points through a callback.
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace StrokeCodec {
+
+constexpr std::string_view COMPACT_PREFIX = "v1:";
+constexpr double QUANT_MAX = 65535.0;
+
+inline bool isCompact(std::string_view data) {
+    return data.substr(0, COMPACT_PREFIX.size()) == COMPACT_PREFIX;
+}
+
+inline constexpr char BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Value of a base64url digit, -1 if invalid
+inline int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '-')
+        return 62;
+    if (c == '_')
+        return 63;
+    return -1;
+}
+
+// Encode points (anything with x and y) in the compact format
+template <typename Container>
+std::string encodeCompact(const Container& points) {
+    if (points.empty()) {
+        return std::string(COMPACT_PREFIX);
+    }
+
+    double minX = points.front().x, minY = points.front().y;
+    double maxX = minX, maxY = minY;
+    for (const auto& p : points) {
+        minX = std::min(minX, p.x);
+        maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y);
+        maxY = std::max(maxY, p.y);
+    }
+
+    // Quantize over the longer side to keep the aspect ratio
+    double scale = std::max(maxX - minX, maxY - minY);
+    if (!(scale > 0.0) || !std::isfinite(scale)) {
+        scale = 1.0;
+    }
+
+    auto quantize = [scale](double v, double origin) {
+        const double q = std::round((v - origin) / scale * QUANT_MAX);
+        return static_cast<uint16_t>(std::clamp(q, 0.0, QUANT_MAX));
+    };
+
+    const size_t byteCount = points.size() * 4;
+    std::string out;
+    out.reserve(COMPACT_PREFIX.size() + (byteCount * 4 + 2) / 3);
+    out += COMPACT_PREFIX;
+
+    uint32_t bits = 0;
+    int bitCount = 0;
+    auto pushByte = [&](uint8_t byte) {
+        bits = (bits << 8) | byte;
+        bitCount += 8;
+        while (bitCount >= 6) {
+            bitCount -= 6;
+            out += BASE64_ALPHABET[(bits >> bitCount) & 0x3F];
+        }
+    };
+
+    for (const auto& p : points) {
+        const uint16_t qx = quantize(p.x, minX);
+        const uint16_t qy = quantize(p.y, minY);
+        pushByte(qx & 0xFF);
+        pushByte(qx >> 8);
+        pushByte(qy & 0xFF);
+        pushByte(qy >> 8);
+    }
+
+    if (bitCount > 0) {
+        out += BASE64_ALPHABET[(bits << (6 - bitCount)) & 0x3F];
+    }
+
+    return out;
+}
+
+// Decode the compact format. `onPoint(x, y)` returns false to abort.
+// Returns false on malformed input or if aborted.
+template <typename OnPoint>
+bool decodeCompact(std::string_view data, OnPoint&& onPoint) {
+    if (!isCompact(data)) {
+        return false;
+    }
+    data.remove_prefix(COMPACT_PREFIX.size());
+
+    uint32_t bits = 0;
+    int bitCount = 0;
+    uint8_t pointBytes[4];
+    int pointByteCount = 0;
+
+    for (char c : data) {
+        const int value = base64Value(c);
+        if (value < 0) {
+            return false;
+        }
+
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        bitCount += 6;
+        if (bitCount < 8) {
+            continue;
+        }
+
+        bitCount -= 8;
+        pointBytes[pointByteCount++] = static_cast<uint8_t>(bits >> bitCount);
+        if (pointByteCount == 4) {
+            pointByteCount = 0;
+            const uint16_t qx = pointBytes[0] | (pointBytes[1] << 8);
+            const uint16_t qy = pointBytes[2] | (pointBytes[3] << 8);
+            if (!onPoint(qx / QUANT_MAX, qy / QUANT_MAX)) {
+                return false;
+            }
+        }
+    }
+
+    // Leftover bits are padding and must not complete another byte
+    return pointByteCount == 0 && bitCount < 6;
+}
+
+// Parse a number the way std::stod does for our inputs: leading
+// whitespace and a '+' sign are skipped, trailing characters ignored.
+inline bool parseLegacyNumber(std::string_view field, double& out) {
+    size_t i = 0;
+    while (i < field.size() &&
+           (field[i] == ' ' || field[i] == '\t' || field[i] == '\n' ||
+            field[i] == '\r' || field[i] == '\f' || field[i] == '\v')) {
+        i++;
+    }
+    const bool plus = i < field.size() && field[i] == '+';
+    if (plus) {
+        i++;
+    }
+
+    const char* first = field.data() + i;
+    const char* last = field.data() + field.size();
+    if (first == last || *first == '+' || (plus && *first == '-')) {
+        return false;
+    }
+
+    const auto result = std::from_chars(first, last, out);
+    return result.ec == std::errc{};
+}
+
+enum class LegacyResult {
+    Ok,        // Every complete "x,y;" pair was reported
+    Invalid,   // A field was not a number
+    Aborted    // onPoint returned false
+};
+
+// Decode "x,y;x,y;...". Parsing stops quietly at the first pair without
+// both separators, like it always did, so a final point without a
+// trailing ';' is ignored.
+template <typename OnPoint>
+LegacyResult decodeLegacy(std::string_view data, OnPoint&& onPoint) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+        const size_t comma = data.find(',', pos);
+        const size_t semi = data.find(';', pos);
+        if (comma == std::string_view::npos || semi == std::string_view::npos)
+            break;
+
+        if (comma <= pos || semi <= comma)
+            break;
+
+        double x = 0.0;
+        double y = 0.0;
+        if (!parseLegacyNumber(data.substr(pos, comma - pos), x) ||
+            !parseLegacyNumber(data.substr(comma + 1, semi - comma - 1), y)) {
+            return LegacyResult::Invalid;
+        }
+
+        if (!onPoint(x, y)) {
+            return LegacyResult::Aborted;
+        }
+
+        pos = semi + 1;
+    }
+    return LegacyResult::Ok;
+}
+
+} // namespace StrokeCodec
@@ -0,0 +1,214 @@
+#pragma once
+
+// Vectorized kernels for the stroke comparison DP.
+//
+// The inner loop of Stroke::step accumulates weighted squared angle
+// differences over a run of point pairs. Runs are gathered into
+// contiguous arrays and summed here with the widest instruction set the
+// CPU supports, picked once at load time.
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STROKE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Precision of the structure-of-arrays data used by the DP.
+// Build with -DSTROKE_FLOAT32 to halve the memory traffic of the kernel.
+#ifdef STROKE_FLOAT32
+using StrokeScalar = float;
+#else
+using StrokeScalar = double;
+#endif
+
+namespace StrokeKernel {
+
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Sum of w[i] * angleDifference(a[i], b[i])^2 over n elements
+using AngleCostFn = double (*)(const StrokeScalar* a, const StrokeScalar* b,
+                               const StrokeScalar* w, int n);
+
+// Angles are in [-1, 1] (normalized by PI), so the difference wraps once
+template <typename T>
+inline T wrapAngle(T d) {
+    if (d < T(-1.0))
+        d += T(2.0);
+    else if (d > T(1.0))
+        d -= T(2.0);
+    return d;
+}
+
+template <typename T>
+inline double angleCostScalar(const T* a, const T* b, const T* w, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        const T d = wrapAngle<T>(a[i] - b[i]);
+        sum += w[i] * (d * d);
+    }
+    return sum;
+}
+
+#ifdef STROKE_SIMD_X86
+
+__attribute__((target("sse2")))
+inline double angleCostSSE2(const double* a, const double* b, const double* w, int n) {
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d minusOne = _mm_set1_pd(-1.0);
+    const __m128d two = _mm_set1_pd(2.0);
+    __m128d acc = _mm_setzero_pd();
+
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d d = _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+        d = _mm_add_pd(d, _mm_and_pd(_mm_cmplt_pd(d, minusOne), two));
+        d = _mm_sub_pd(d, _mm_and_pd(_mm_cmpgt_pd(d, one), two));
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(w + i), _mm_mul_pd(d, d)));
+    }
+
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, acc);
+    return lanes[0] + lanes[1] + angleCostScalar(a + i, b + i, w + i, n - i);
+}
+
+__attribute__((target("sse2")))
+inline double angleCostSSE2(const float* a, const float* b, const float* w, int n) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    __m128 acc = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        d = _mm_add_ps(d, _mm_and_ps(_mm_cmplt_ps(d, minusOne), two));
+        d = _mm_sub_ps(d, _mm_and_ps(_mm_cmpgt_ps(d, one), two));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(w + i), _mm_mul_ps(d, d)));
+    }
+
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    double sum = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    return sum + angleCostScalar(a + i, b + i, w + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline double angleCostAVX2(const double* a, const double* b, const double* w, int n) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d minusOne = _mm256_set1_pd(-1.0);
+    const __m256d two = _mm256_set1_pd(2.0);
+    __m256d acc = _mm256_setzero_pd();
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d d = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        d = _mm256_add_pd(d, _mm256_and_pd(_mm256_cmp_pd(d, minusOne, _CMP_LT_OQ), two));
+        d = _mm256_sub_pd(d, _mm256_and_pd(_mm256_cmp_pd(d, one, _CMP_GT_OQ), two));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(w + i), _mm256_mul_pd(d, d)));
+    }
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    double sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return sum + angleCostScalar(a + i, b + i, w + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline double angleCostAVX2(const float* a, const float* b, const float* w, int n) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minusOne = _mm256_set1_ps(-1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    __m256 acc = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        d = _mm256_add_ps(d, _mm256_and_ps(_mm256_cmp_ps(d, minusOne, _CMP_LT_OQ), two));
+        d = _mm256_sub_ps(d, _mm256_and_ps(_mm256_cmp_ps(d, one, _CMP_GT_OQ), two));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(w + i), _mm256_mul_ps(d, d)));
+    }
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    double sum = 0.0;
+    for (float lane : lanes)
+        sum += lane;
+    return sum + angleCostScalar(a + i, b + i, w + i, n - i);
+}
+
+#endif // STROKE_SIMD_X86
+
+inline bool isSupported(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#ifdef STROKE_SIMD_X86
+        case Isa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+inline AngleCostFn kernelFor(Isa isa) {
+#ifdef STROKE_SIMD_X86
+    if (isa == Isa::AVX2)
+        return static_cast<AngleCostFn>(angleCostAVX2);
+    if (isa == Isa::SSE2)
+        return static_cast<AngleCostFn>(angleCostSSE2);
+#endif
+    return angleCostScalar<StrokeScalar>;
+}
+
+inline Isa detectIsa() {
+    if (isSupported(Isa::AVX2))
+        return Isa::AVX2;
+    if (isSupported(Isa::SSE2))
+        return Isa::SSE2;
+    return Isa::Scalar;
+}
+
+// Kernel selected at load time; tests and benchmarks may switch it
+inline Isa g_activeIsa = detectIsa();
+inline AngleCostFn g_angleCost = kernelFor(g_activeIsa);
+
+// Switch to a specific instruction set, returns false if unsupported
+inline bool useIsa(Isa isa) {
+    if (!isSupported(isa))
+        return false;
+    g_activeIsa = isa;
+    g_angleCost = kernelFor(isa);
+    return true;
+}
+
+inline Isa activeIsa() {
+    return g_activeIsa;
+}
+
+inline const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+// Runs shorter than this are summed inline, the call is not worth it
+constexpr int MIN_VECTOR_RUN = 4;
+
+inline double angleCost(const StrokeScalar* a, const StrokeScalar* b,
+                        const StrokeScalar* w, int n) {
+    if (n < MIN_VECTOR_RUN)
+        return angleCostScalar(a, b, w, n);
+    return g_angleCost(a, b, w, n);
+}
+
+} // namespace StrokeKernel
@@ -0,0 +1,72 @@
+#pragma once
+
+// Synthetic gesture corpora shared by the benchmarks. Everything is
+// seeded, so runs on different commits see the same strokes.
+
+#include "../stroke.hpp"
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace BenchCorpus {
+
+// Raw pointer positions of a smooth random walk, like a drawn gesture
+inline std::vector<std::pair<double, double>> randomWalkPath(std::mt19937& rng, int numPoints) {
+    std::uniform_real_distribution<double> turn(-0.4, 0.4);
+    std::vector<std::pair<double, double>> path;
+    path.reserve(numPoints);
+    double x = 0.0, y = 0.0, heading = turn(rng) * 8.0;
+    for (int i = 0; i < numPoints; i++) {
+        path.emplace_back(x, y);
+        heading += turn(rng);
+        x += 4.0 * std::cos(heading);
+        y += 4.0 * std::sin(heading);
+    }
+    return path;
+}
+
+inline Stroke strokeFromPath(const std::vector<std::pair<double, double>>& path,
+                             int resampleCount = 0) {
+    Stroke stroke;
+    for (const auto& [x, y] : path) {
+        stroke.addPoint(x, y);
+    }
+    stroke.finish(resampleCount);
+    return stroke;
+}
+
+inline Stroke randomWalkStroke(std::mt19937& rng, int numPoints) {
+    return strokeFromPath(randomWalkPath(rng, numPoints));
+}
+
+// Copy of a finished stroke scaled back to screen size with pixel jitter
+inline Stroke noisyCopy(std::mt19937& rng, const Stroke& stroke) {
+    Stroke noisy;
+    for (const auto& p : stroke.getPoints()) {
+        noisy.addPoint(p.x * 500.0 + (rng() % 4), p.y * 500.0 + (rng() % 4));
+    }
+    noisy.finish();
+    return noisy;
+}
+
+// A template library with inputs that are half noisy copies of
+// templates and half unrelated strokes
+struct Library {
+    std::vector<Stroke> templates;
+    std::vector<Stroke> inputs;
+
+    Library(int numPoints, int librarySize, int inputCount = 16) {
+        std::mt19937 rng(numPoints * 7919 + librarySize);
+        templates.reserve(librarySize);
+        for (int i = 0; i < librarySize; i++) {
+            templates.push_back(randomWalkStroke(rng, numPoints));
+        }
+        for (int i = 0; i < inputCount / 2; i++) {
+            inputs.push_back(noisyCopy(rng, templates[(i * 7) % librarySize]));
+            inputs.push_back(randomWalkStroke(rng, numPoints));
+        }
+    }
+};
+
+} // namespace BenchCorpus
@@ -0,0 +1,166 @@
+#include <benchmark/benchmark.h>
+#include "../../common/pixel_format.hpp"
+#include <random>
+#include <vector>
+
+// Compares the shared pixel format kernels with the per-pixel loops the
+// plugins used before, on a 4K frame. Each run first checks the kernel
+// against the old loop and fails the benchmark if they disagree.
+
+namespace {
+
+constexpr int WIDTH = 3840;
+constexpr int HEIGHT = 2160;
+
+std::vector<uint8_t> randomPixels(size_t size) {
+    std::mt19937 rng(42);
+    std::vector<uint8_t> bytes(size);
+    for (auto& byte : bytes) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+// The Cairo BGRA conversion from copy-indicator and no-mouse
+std::vector<uint8_t> legacyBGRAtoRGBA(const uint8_t* data, int stride, int width, int height) {
+    std::vector<uint8_t> pixelData(width * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const auto SRC = data + y * stride + x * 4;
+            auto dst = pixelData.data() + (y * width + x) * 4;
+            dst[0] = SRC[2];
+            dst[1] = SRC[1];
+            dst[2] = SRC[0];
+            dst[3] = SRC[3];
+        }
+    }
+    return pixelData;
+}
+
+// The gdk-pixbuf conversion from mouse-gestures and workspace-overview
+std::vector<uint8_t> legacyPixelDataToRGBA(const uint8_t* pixels, int width, int height,
+                                           int channels, int stride) {
+    std::vector<uint8_t> pixelData(width * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t* src = pixels + y * stride + x * channels;
+            uint8_t* dst = pixelData.data() + (y * width + x) * 4;
+            if (channels == 4) {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = src[3];
+            } else if (channels == 3) {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = 255;
+            }
+        }
+    }
+    return pixelData;
+}
+
+void BM_LegacyBGRAtoRGBA(benchmark::State& state) {
+    const auto src = randomPixels(static_cast<size_t>(WIDTH) * HEIGHT * 4);
+    for (auto _ : state) {
+        auto rgba = legacyBGRAtoRGBA(src.data(), WIDTH * 4, WIDTH, HEIGHT);
+        benchmark::DoNotOptimize(rgba.data());
+    }
+    state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+// In place, the way the plugins now convert Cairo surfaces
+void BM_SwapRedBlueInPlace(benchmark::State& state, PixelFormat::Isa isa) {
+    auto pixels = randomPixels(static_cast<size_t>(WIDTH) * HEIGHT * 4);
+    const auto expected = legacyBGRAtoRGBA(pixels.data(), WIDTH * 4, WIDTH, HEIGHT);
+
+    if (!PixelFormat::useIsa(isa)) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+    auto check = pixels;
+    PixelFormat::swapRedBlueInPlace(check.data(), WIDTH * 4, WIDTH, HEIGHT);
+    if (check != expected) {
+        state.SkipWithError("result differs from the old loop");
+        return;
+    }
+
+    for (auto _ : state) {
+        PixelFormat::swapRedBlueInPlace(pixels.data(), WIDTH * 4, WIDTH, HEIGHT);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * pixels.size());
+    PixelFormat::useIsa(PixelFormat::detectIsa());
+}
+
+void BM_LegacyRGBtoRGBA(benchmark::State& state) {
+    const auto src = randomPixels(static_cast<size_t>(WIDTH) * HEIGHT * 3);
+    for (auto _ : state) {
+        auto rgba = legacyPixelDataToRGBA(src.data(), WIDTH, HEIGHT, 3, WIDTH * 3);
+        benchmark::DoNotOptimize(rgba.data());
+    }
+    state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+// Into a preallocated buffer, the way the background loader decodes
+void BM_ExpandRgb(benchmark::State& state, PixelFormat::Isa isa) {
+    const auto src = randomPixels(static_cast<size_t>(WIDTH) * HEIGHT * 3);
+    const auto expected = legacyPixelDataToRGBA(src.data(), WIDTH, HEIGHT, 3, WIDTH * 3);
+    std::vector<uint8_t> dst(expected.size());
+
+    if (!PixelFormat::useIsa(isa)) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+    PixelFormat::toRGBA(src.data(), WIDTH * 3, 3, dst.data(), WIDTH * 4, WIDTH, HEIGHT);
+    if (dst != expected) {
+        state.SkipWithError("result differs from the old loop");
+        return;
+    }
+
+    for (auto _ : state) {
+        PixelFormat::toRGBA(src.data(), WIDTH * 3, 3, dst.data(), WIDTH * 4, WIDTH, HEIGHT);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * src.size());
+    PixelFormat::useIsa(PixelFormat::detectIsa());
+}
+
+void BM_Premultiply(benchmark::State& state, PixelFormat::Isa isa) {
+    const auto original = randomPixels(static_cast<size_t>(WIDTH) * HEIGHT * 4);
+    auto pixels = original;
+
+    if (!PixelFormat::useIsa(isa)) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        pixels = original;
+        state.ResumeTiming();
+        PixelFormat::premultiply(pixels.data(), WIDTH * 4, WIDTH, HEIGHT);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * pixels.size());
+    PixelFormat::useIsa(PixelFormat::detectIsa());
+}
+
+} // namespace
+
+BENCHMARK(BM_LegacyBGRAtoRGBA)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SwapRedBlueInPlace, scalar, PixelFormat::Isa::Scalar)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SwapRedBlueInPlace, sse2, PixelFormat::Isa::SSE2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SwapRedBlueInPlace, avx2, PixelFormat::Isa::AVX2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SwapRedBlueInPlace, neon, PixelFormat::Isa::NEON)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LegacyRGBtoRGBA)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ExpandRgb, scalar, PixelFormat::Isa::Scalar)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ExpandRgb, avx2, PixelFormat::Isa::AVX2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ExpandRgb, neon, PixelFormat::Isa::NEON)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_Premultiply, scalar, PixelFormat::Isa::Scalar)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Premultiply, sse2, PixelFormat::Isa::SSE2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Premultiply, avx2, PixelFormat::Isa::AVX2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Premultiply, neon, PixelFormat::Isa::NEON)->Unit(benchmark::kMillisecond);
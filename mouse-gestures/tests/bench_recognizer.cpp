@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include "../gesture_matcher.hpp"
+#include "../ascii_gesture.hpp"
+#include "bench_corpus.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+// Recognizer hot paths on synthetic corpora. The first argument is the
+// number of points per stroke, the second (where present) the size of
+// the template library. Use `make bench-json` to keep results around
+// for comparison across commits.
+
+namespace {
+
+const Stroke& identity(const Stroke& stroke) {
+    return stroke;
+}
+
+void BM_StrokeFinish(benchmark::State& state) {
+    const int numPoints = state.range(0);
+    const int resampleCount = state.range(1);
+    std::mt19937 rng(numPoints);
+    const auto path = BenchCorpus::randomWalkPath(rng, numPoints);
+
+    for (auto _ : state) {
+        Stroke stroke;
+        for (const auto& [x, y] : path) {
+            stroke.addPoint(x, y);
+        }
+        benchmark::DoNotOptimize(stroke.finish(resampleCount));
+    }
+    state.SetItemsProcessed(state.iterations() * numPoints);
+}
+
+void BM_StrokeCompare(benchmark::State& state) {
+    const int numPoints = state.range(0);
+    std::mt19937 rng(numPoints);
+    const Stroke a = BenchCorpus::randomWalkStroke(rng, numPoints);
+    const Stroke b = BenchCorpus::noisyCopy(rng, a);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.compare(b));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_LibraryMatch(benchmark::State& state) {
+    BenchCorpus::Library corpus(state.range(0), state.range(1));
+    GestureFeatureIndex index;
+    index.rebuild(corpus.templates, identity);
+
+    size_t evaluated = 0;
+    for (auto _ : state) {
+        for (const auto& input : corpus.inputs) {
+            auto match = findBestStrokeMatch(input, corpus.templates, index, 0.0, 0.15, identity);
+            evaluated += match.evaluated;
+            benchmark::DoNotOptimize(match);
+        }
+    }
+    state.counters["evaluated"] = benchmark::Counter(
+        static_cast<double>(evaluated) / corpus.inputs.size(), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * corpus.inputs.size());
+}
+
+void BM_StrokeSerialize(benchmark::State& state, bool compact) {
+    std::mt19937 rng(state.range(0));
+    const Stroke stroke = BenchCorpus::randomWalkStroke(rng, state.range(0));
+
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::string data = compact ? stroke.serializeCompact() : stroke.serialize();
+        bytes += data.size();
+        benchmark::DoNotOptimize(data);
+    }
+    state.SetBytesProcessed(bytes);
+}
+
+void BM_StrokeDeserialize(benchmark::State& state, bool compact) {
+    std::mt19937 rng(state.range(0));
+    const Stroke stroke = BenchCorpus::randomWalkStroke(rng, state.range(0));
+    const std::string data = compact ? stroke.serializeCompact() : stroke.serialize();
+
+    for (auto _ : state) {
+        Stroke parsed = Stroke::deserialize(data);
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_AsciiRender(benchmark::State& state) {
+    std::mt19937 rng(state.range(0));
+    const Stroke stroke = BenchCorpus::randomWalkStroke(rng, state.range(0));
+
+    for (auto _ : state) {
+        auto lines = AsciiGestureRenderer::render(stroke);
+        benchmark::DoNotOptimize(lines);
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_StrokeFinish)->ArgsProduct({{32, 256, 2048}, {0, 64}});
+BENCHMARK(BM_StrokeCompare)->Arg(32)->Arg(128)->Arg(512);
+BENCHMARK(BM_LibraryMatch)->ArgsProduct({{32, 128}, {16, 128, 1024}});
+BENCHMARK_CAPTURE(BM_StrokeSerialize, legacy, false)->Arg(64)->Arg(512);
+BENCHMARK_CAPTURE(BM_StrokeSerialize, compact, true)->Arg(64)->Arg(512);
+BENCHMARK_CAPTURE(BM_StrokeDeserialize, legacy, false)->Arg(64)->Arg(512);
+BENCHMARK_CAPTURE(BM_StrokeDeserialize, compact, true)->Arg(64)->Arg(512);
+BENCHMARK(BM_AsciiRender)->Arg(64)->Arg(512);
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include "../gesture_matcher.hpp"
+#include "bench_corpus.hpp"
+#include <random>
+#include <vector>
+
+// Compares the scalar and vectorized angle-cost kernels on whole-library
+// matching. Each run first checks that the kernel picks the same
+// templates as the scalar path and fails the benchmark otherwise.
+
+namespace {
+
+struct KernelCorpus {
+    std::vector<Stroke> library;
+    std::vector<Stroke> inputs;
+
+    explicit KernelCorpus(int numPoints) {
+        std::mt19937 rng(numPoints);
+        for (int i = 0; i < 64; i++) {
+            library.push_back(BenchCorpus::randomWalkStroke(rng, numPoints));
+        }
+        for (int i = 0; i < 8; i++) {
+            // Noisy copies of templates plus unrelated strokes
+            inputs.push_back(BenchCorpus::noisyCopy(rng, library[i * 7]));
+            inputs.push_back(BenchCorpus::randomWalkStroke(rng, numPoints));
+        }
+    }
+
+    std::vector<int> decisions() const {
+        std::vector<int> result;
+        for (const auto& input : inputs) {
+            result.push_back(findBestStrokeMatch(input, library, 0.15,
+                [](const Stroke& s) -> const Stroke& { return s; }).index);
+        }
+        return result;
+    }
+};
+
+void BM_LibraryMatchKernel(benchmark::State& state, StrokeKernel::Isa isa) {
+    const int numPoints = state.range(0);
+    KernelCorpus corpus(numPoints);
+
+    StrokeKernel::useIsa(StrokeKernel::Isa::Scalar);
+    const auto expected = corpus.decisions();
+
+    if (!StrokeKernel::useIsa(isa)) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+    if (corpus.decisions() != expected) {
+        state.SkipWithError("match decisions differ from the scalar path");
+        return;
+    }
+
+    for (auto _ : state) {
+        for (const auto& input : corpus.inputs) {
+            auto match = findBestStrokeMatch(input, corpus.library, 0.15,
+                [](const Stroke& s) -> const Stroke& { return s; });
+            benchmark::DoNotOptimize(match);
+        }
+    }
+
+    int matched = 0;
+    for (int index : expected) {
+        matched += index >= 0;
+    }
+    state.counters["matched"] = matched;
+    state.SetItemsProcessed(state.iterations() * corpus.inputs.size());
+    StrokeKernel::useIsa(StrokeKernel::detectIsa());
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_LibraryMatchKernel, scalar, StrokeKernel::Isa::Scalar)
+    ->Arg(32)->Arg(128)->Arg(512);
+BENCHMARK_CAPTURE(BM_LibraryMatchKernel, sse2, StrokeKernel::Isa::SSE2)
+    ->Arg(32)->Arg(128)->Arg(512);
+BENCHMARK_CAPTURE(BM_LibraryMatchKernel, avx2, StrokeKernel::Isa::AVX2)
+    ->Arg(32)->Arg(128)->Arg(512);
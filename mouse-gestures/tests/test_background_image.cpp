@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "../background_image.hpp"
+#include <atomic>
+#include <chrono>
+#include <poll.h>
+
+namespace {
+
+BackgroundImage solidImage(int width, int height, uint8_t value) {
+    BackgroundImage image;
+    image.width = width;
+    image.height = height;
+    image.rgba.assign(static_cast<size_t>(width) * height * 4, value);
+    return image;
+}
+
+// Wait for the loader to post and collect results until `count` arrived
+std::vector<BackgroundLoader::Result> waitForResults(BackgroundLoader& loader, size_t count) {
+    std::vector<BackgroundLoader::Result> all;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (all.size() < count && std::chrono::steady_clock::now() < deadline) {
+        pollfd pfd{loader.pollFd(), POLLIN, 0};
+        poll(&pfd, 1, 10);
+        for (auto& result : loader.takeResults()) {
+            all.push_back(std::move(result));
+        }
+    }
+    return all;
+}
+
+void waitIdle(BackgroundLoader& loader) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (loader.busy() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+// Wider images lose their sides, taller ones top and bottom
+TEST(BackgroundImageTest, CoverCrop) {
+    auto crop = backgroundCoverCrop(4000, 1000, {1920, 1080});
+    EXPECT_NEAR(crop.width, 1000 * 1920.0 / 1080, 1e-9);
+    EXPECT_DOUBLE_EQ(crop.height, 1000);
+    EXPECT_NEAR(crop.x, (4000 - crop.width) / 2, 1e-9);
+    EXPECT_DOUBLE_EQ(crop.y, 0);
+
+    crop = backgroundCoverCrop(1000, 4000, {1920, 1080});
+    EXPECT_DOUBLE_EQ(crop.width, 1000);
+    EXPECT_NEAR(crop.height, 1000 * 1080.0 / 1920, 1e-9);
+    EXPECT_DOUBLE_EQ(crop.x, 0);
+    EXPECT_NEAR(crop.y, (4000 - crop.height) / 2, 1e-9);
+}
+
+// Images are only ever scaled down; upscaling is left to the GPU
+TEST(BackgroundImageTest, VariantSize) {
+    EXPECT_EQ(backgroundVariantSize(7680, 4320, {1920, 1080}), (BackgroundSize{1920, 1080}));
+    EXPECT_EQ(backgroundVariantSize(7680, 4320, {1080, 1920}), (BackgroundSize{1080, 1920}));
+    EXPECT_EQ(backgroundVariantSize(800, 600, {1920, 1080}), (BackgroundSize{800, 450}));
+    EXPECT_EQ(backgroundVariantSize(1920, 1080, {1920, 1080}), (BackgroundSize{1920, 1080}));
+}
+
+TEST(BackgroundImageTest, BoxFilterAverages) {
+    // Columns alternate 0 and 200, halving averages each pair
+    BackgroundImage image;
+    image.width = 4;
+    image.height = 2;
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 4; x++) {
+            const uint8_t value = x % 2 ? 200 : 0;
+            image.rgba.insert(image.rgba.end(), {value, value, value, 255});
+        }
+    }
+
+    const auto scaled = scaleBackgroundToCover(image, {2, 1});
+    ASSERT_EQ(scaled.width, 2);
+    ASSERT_EQ(scaled.height, 1);
+    for (size_t i = 0; i < scaled.rgba.size(); i += 4) {
+        EXPECT_EQ(scaled.rgba[i], 100);
+        EXPECT_EQ(scaled.rgba[i + 3], 255);
+    }
+}
+
+// Only the covered middle of a wide image is sampled
+TEST(BackgroundImageTest, ScaleCropsToCover) {
+    BackgroundImage image = solidImage(30, 10, 0);
+    for (int y = 0; y < 10; y++) {
+        for (int x = 10; x < 20; x++) {
+            image.rgba[(y * 30 + x) * 4] = 255;
+        }
+    }
+
+    const auto scaled = scaleBackgroundToCover(image, {5, 5});
+    ASSERT_EQ(scaled.width, 5);
+    ASSERT_EQ(scaled.height, 5);
+    for (size_t i = 0; i < scaled.rgba.size(); i += 4) {
+        EXPECT_EQ(scaled.rgba[i], 255);
+    }
+}
+
+TEST(BackgroundLoaderTest, ProducesVariantPerOutput) {
+    std::atomic<int> decodes{0};
+    BackgroundLoader loader([&](const std::string& path) -> std::optional<BackgroundImage> {
+        decodes++;
+        return solidImage(64, 64, 7);
+    });
+    ASSERT_GE(loader.pollFd(), 0);
+
+    const uint64_t generation = loader.load("bg.png", {{32, 32}, {16, 8}, {32, 32}});
+    const auto results = waitForResults(loader, 2);
+    ASSERT_EQ(results.size(), 2u);
+    for (const auto& result : results) {
+        EXPECT_EQ(result.generation, generation);
+        EXPECT_FALSE(result.failed);
+        EXPECT_EQ(result.image.width, result.output.width);
+        EXPECT_EQ(result.image.height, result.output.height);
+        EXPECT_EQ(result.image.rgba[0], 7);
+    }
+
+    // Sizes already made aren't made again
+    loader.request({32, 32});
+    waitIdle(loader);
+    EXPECT_TRUE(loader.takeResults().empty());
+    EXPECT_EQ(decodes.load(), 1);
+
+    // A new size decodes the image again
+    loader.request({8, 8});
+    ASSERT_EQ(waitForResults(loader, 1).size(), 1u);
+    EXPECT_EQ(decodes.load(), 2);
+}
+
+TEST(BackgroundLoaderTest, ReportsFailure) {
+    BackgroundLoader loader([](const std::string&) -> std::optional<BackgroundImage> {
+        return std::nullopt;
+    });
+
+    loader.load("missing.png", {{32, 32}});
+    const auto results = waitForResults(loader, 1);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_TRUE(results[0].failed);
+}
+
+// Results of an image that was replaced in the meantime are dropped
+TEST(BackgroundLoaderTest, NewLoadDropsOldResults) {
+    std::atomic<bool> release{false};
+    BackgroundLoader loader([&](const std::string& path) -> std::optional<BackgroundImage> {
+        if (path == "old.png") {
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        return solidImage(8, 8, path == "old.png" ? 1 : 2);
+    });
+
+    loader.load("old.png", {{4, 4}});
+    while (!loader.busy()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const uint64_t generation = loader.load("new.png", {{4, 4}});
+    release = true;
+
+    const auto results = waitForResults(loader, 1);
+    waitIdle(loader);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].generation, generation);
+    EXPECT_EQ(results[0].image.rgba[0], 2);
+    EXPECT_TRUE(loader.takeResults().empty());
+}
+
+TEST(BackgroundLoaderTest, EmptyPathLoadsNothing) {
+    std::atomic<int> decodes{0};
+    BackgroundLoader loader([&](const std::string&) -> std::optional<BackgroundImage> {
+        decodes++;
+        return solidImage(8, 8, 0);
+    });
+
+    loader.load("", {{4, 4}});
+    loader.request({8, 8});
+    EXPECT_FALSE(loader.busy());
+    EXPECT_EQ(decodes.load(), 0);
+}
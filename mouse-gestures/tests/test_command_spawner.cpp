@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "../command_spawner.hpp"
+#include <poll.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Wait for children to exit and reap them until none are left
+void reapAll(CommandSpawner& spawner) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((spawner.running() > 0 || spawner.queuedCount() > 0) &&
+           std::chrono::steady_clock::now() < deadline) {
+        if (spawner.pollFd() >= 0) {
+            pollfd pfd{spawner.pollFd(), POLLIN, 0};
+            poll(&pfd, 1, 10);
+        }
+
+        // A pidfd can turn readable a moment before waitpid sees the
+        // child as exited
+        if (spawner.reap() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+std::string tempPath(const char* name) {
+    return std::string(testing::TempDir()) + "/command_spawner_" + name;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    std::string content;
+    std::getline(in, content);
+    return content;
+}
+
+} // namespace
+
+TEST(CommandSpawnerTest, RunsCommandThroughShell) {
+    const std::string path = tempPath("runs");
+    std::remove(path.c_str());
+
+    CommandSpawner spawner({.detach = false});
+    EXPECT_TRUE(spawner.submit("echo \"hello $((1 + 2))\" > '" + path + "'"));
+    reapAll(spawner);
+
+    EXPECT_EQ(readFile(path), "hello 3");
+    EXPECT_EQ(spawner.running(), 0u);
+
+    const auto& stats = spawner.getStats();
+    EXPECT_EQ(stats.submitted.load(), 1u);
+    EXPECT_EQ(stats.spawned.load(), 1u);
+    EXPECT_EQ(stats.spawn.snapshot().count, 1u);
+    EXPECT_EQ(stats.launch.snapshot().count, 1u);
+    std::remove(path.c_str());
+}
+
+TEST(CommandSpawnerTest, EmptyCommandIsIgnored) {
+    CommandSpawner spawner;
+    EXPECT_FALSE(spawner.submit(""));
+    EXPECT_EQ(spawner.getStats().submitted.load(), 0u);
+}
+
+// Commands beyond the running limit wait, beyond the queue they're dropped
+TEST(CommandSpawnerTest, BoundsRunningAndQueued) {
+    CommandSpawner spawner({.maxRunning = 2, .maxQueued = 2, .detach = false});
+
+    for (int i = 0; i < 2; i++) {
+        EXPECT_TRUE(spawner.submit("sleep 0.2"));
+    }
+    EXPECT_EQ(spawner.running(), 2u);
+
+    EXPECT_TRUE(spawner.submit("true"));
+    EXPECT_TRUE(spawner.submit("true"));
+    EXPECT_FALSE(spawner.submit("true"));
+    EXPECT_EQ(spawner.queuedCount(), 2u);
+
+    const auto& stats = spawner.getStats();
+    EXPECT_EQ(stats.queued.load(), 2u);
+    EXPECT_EQ(stats.dropped.load(), 1u);
+
+    // Queued commands start as slots free up
+    reapAll(spawner);
+    EXPECT_EQ(spawner.running(), 0u);
+    EXPECT_EQ(spawner.queuedCount(), 0u);
+    EXPECT_EQ(stats.spawned.load(), 4u);
+    EXPECT_EQ(stats.launch.snapshot().count, 4u);
+    EXPECT_EQ(stats.queueWait.snapshot().count, 4u);
+}
+
+// Detached commands free their slot once launched, not when they finish
+TEST(CommandSpawnerTest, DetachedCommandsFreeSlots) {
+    const std::string path = tempPath("detached");
+    std::remove(path.c_str());
+
+    CommandSpawner spawner({.maxRunning = 1});
+    EXPECT_TRUE(spawner.submit("sleep 1; echo done > '" + path + "'"));
+
+    // The slot frees up when the launcher exits, not the command
+    reapAll(spawner);
+    EXPECT_EQ(spawner.running(), 0u);
+    EXPECT_EQ(readFile(path), "");
+
+    for (int i = 0; i < 500 && readFile(path).empty(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(readFile(path), "done");
+    std::remove(path.c_str());
+}
+
+// Commands still queued when the spawner goes away are dropped, not
+// started in the slots the destructor reaps
+TEST(CommandSpawnerTest, DestructorDropsQueuedCommands) {
+    const std::string path = tempPath("dropped");
+    std::remove(path.c_str());
+
+    {
+        CommandSpawner spawner({.maxRunning = 1, .detach = false});
+        EXPECT_TRUE(spawner.submit("sleep 0.05"));
+        EXPECT_TRUE(spawner.submit("echo started > '" + path + "'"));
+        EXPECT_EQ(spawner.queuedCount(), 1u);
+
+        // Let the first command exit without reaping it
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(readFile(path), "");
+    std::remove(path.c_str());
+}
+
+TEST(CommandSpawnerTest, StatsJson) {
+    CommandSpawner spawner({.detach = false});
+    spawner.submit("true");
+    reapAll(spawner);
+
+    const std::string json = spawner.getStats().toJson();
+    EXPECT_NE(json.find("\"spawned\":1"), std::string::npos);
+    EXPECT_NE(json.find("\"launch\":{\"count\":1"), std::string::npos);
+
+    spawner.getStats().reset();
+    EXPECT_EQ(spawner.getStats().spawned.load(), 0u);
+    EXPECT_EQ(spawner.getStats().launch.snapshot().count, 0u);
+}
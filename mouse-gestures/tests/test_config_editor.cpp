@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include "../config_editor.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+std::vector<std::string> readLines(const std::string& path) {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+} // namespace
+
+TEST(ConfigEditorTest, GestureLineStroke) {
+    EXPECT_EQ(gestureLineStroke("    gesture_action = kitty|0.1,0.2;0.3,0.4"), "0.1,0.2;0.3,0.4");
+    EXPECT_EQ(gestureLineStroke("gesture_action=a|b|v1:XYZ \r"), "v1:XYZ");
+    EXPECT_FALSE(gestureLineStroke("# gesture_action = kitty|0.1,0.2").has_value());
+    EXPECT_FALSE(gestureLineStroke("    drag_button = 273").has_value());
+    EXPECT_FALSE(gestureLineStroke("    gesture_action = kitty").has_value());
+}
+
+// Deleted gestures take the comment lines above them along
+TEST(ConfigEditorTest, DeleteRemovesCommentsAbove) {
+    std::vector<std::string> lines = {
+        "plugin {",
+        "  mouse_gestures {",
+        "    drag_button = 273",
+        "    # ##",
+        "    # #.",
+        "    gesture_action = kitty|-0.000000,1.000000;1.0,0.0",
+        "    gesture_action = firefox|0.5,0.5;0.6,0.6",
+        "  }",
+        "}",
+    };
+
+    EXPECT_EQ(deleteGestureLines(lines, {"0.000000,1.000000;1.0,0.0"}), 1u);
+    EXPECT_EQ(lines, (std::vector<std::string>{
+        "plugin {",
+        "  mouse_gestures {",
+        "    drag_button = 273",
+        "    gesture_action = firefox|0.5,0.5;0.6,0.6",
+        "  }",
+        "}",
+    }));
+
+    EXPECT_EQ(deleteGestureLines(lines, {"9,9;8,8"}), 0u);
+    EXPECT_EQ(lines.size(), 6u);
+}
+
+TEST(ConfigEditorTest, FormatGestureLines) {
+    const auto lines = formatGestureLines(
+        {{"1,1;2,2", "kitty", {"# #"}}, {"3,3;4,4", std::nullopt, {}}}, "notify-send edit me");
+    EXPECT_EQ(lines, (std::vector<std::string>{
+        "    # #",
+        "    gesture_action = kitty|1,1;2,2",
+        "    gesture_action = notify-send edit me|3,3;4,4",
+    }));
+}
+
+TEST(ConfigEditorTest, SplitAndJoinLines) {
+    EXPECT_EQ(splitConfigLines("a\n\nb"), (std::vector<std::string>{"a", "", "b"}));
+    EXPECT_EQ(splitConfigLines("a\nb\n"), (std::vector<std::string>{"a", "b"}));
+    EXPECT_TRUE(splitConfigLines("").empty());
+    EXPECT_EQ(joinConfigLines({"a", "", "b"}), "a\n\nb\n");
+}
+
+TEST(ConfigEditorTest, AddedThenDeletedCancelsOut) {
+    GestureEditBatch batch;
+    batch.additions.push_back({"-0.000000,1;2,2", "kitty", {}});
+    batch.additions.push_back({"5,5;6,6", "firefox", {}});
+
+    GestureEditBatch later;
+    later.deletions = {"0.000000,1;2,2", "7,7;8,8"};
+    batch.merge(std::move(later));
+
+    ASSERT_EQ(batch.additions.size(), 1u);
+    EXPECT_EQ(batch.additions[0].strokeData, "5,5;6,6");
+    EXPECT_EQ(batch.deletions, (std::vector<std::string>{"7,7;8,8"}));
+    EXPECT_FALSE(batch.empty());
+}
+
+TEST(ConfigEditorTest, FsyncPolicyFromInt) {
+    EXPECT_EQ(configFsyncPolicyFromInt(-1), ConfigFsyncPolicy::None);
+    EXPECT_EQ(configFsyncPolicyFromInt(0), ConfigFsyncPolicy::None);
+    EXPECT_EQ(configFsyncPolicyFromInt(1), ConfigFsyncPolicy::File);
+    EXPECT_EQ(configFsyncPolicyFromInt(2), ConfigFsyncPolicy::Directory);
+}
+
+TEST(ConfigEditorTest, WriteAtomically) {
+    const std::string path = std::string(testing::TempDir()) + "/config_editor_write.conf";
+    {
+        std::ofstream out(path);
+        out << "old content\n";
+    }
+
+    for (auto policy : {ConfigFsyncPolicy::None, ConfigFsyncPolicy::File,
+                        ConfigFsyncPolicy::Directory}) {
+        const std::vector<std::string> lines = {"plugin {", "  mouse_gestures {", "  }", "}"};
+        ASSERT_TRUE(writeConfigAtomically(path, lines, policy));
+        EXPECT_EQ(readLines(path), lines);
+
+        std::ifstream temp(path + ".tmp");
+        EXPECT_FALSE(temp.good());
+    }
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(writeConfigAtomically("/nonexistent-dir/hyprland.conf", std::string_view("x\n"),
+                                       ConfigFsyncPolicy::None));
+}
+
+// Batches submitted while a write runs are merged into the next one
+TEST(ConfigWriteQueueTest, CoalescesWhileWriting) {
+    std::mutex appliedMutex;
+    std::vector<GestureEditBatch> applied;
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+
+    ConfigWriteQueue queue([&](const GestureEditBatch& batch) {
+        started = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard<std::mutex> lock(appliedMutex);
+        applied.push_back(batch);
+    });
+
+    GestureEditBatch first;
+    first.additions.push_back({"0,0;1,1", "a", {}});
+    queue.submit(first);
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (int i = 0; i < 50; i++) {
+        GestureEditBatch batch;
+        batch.additions.push_back({std::to_string(i) + ",0;1,1", "b", {}});
+        queue.submit(std::move(batch));
+    }
+    EXPECT_TRUE(queue.busy());
+
+    release = true;
+    queue.flush();
+
+    EXPECT_FALSE(queue.busy());
+    EXPECT_EQ(queue.writes(), 2u);
+    std::lock_guard<std::mutex> lock(appliedMutex);
+    ASSERT_EQ(applied.size(), 2u);
+    EXPECT_EQ(applied[0].additions.size(), 1u);
+    EXPECT_EQ(applied[1].additions.size(), 50u);
+}
+
+TEST(ConfigWriteQueueTest, CancelledEditsNeedNoWrite) {
+    std::atomic<int> calls{0};
+    ConfigWriteQueue queue([&](const GestureEditBatch&) { calls++; });
+
+    GestureEditBatch batch;
+    batch.additions.push_back({"1,1;2,2", "a", {}});
+    batch.deletions.push_back("1,1;2,2");
+    queue.submit(batch);
+    queue.flush();
+
+    EXPECT_EQ(calls.load(), 0);
+    EXPECT_FALSE(queue.busy());
+}
+
+// Shutdown writes what is still pending
+TEST(ConfigWriteQueueTest, ShutdownFlushesPending) {
+    std::atomic<size_t> written{0};
+    ConfigWriteQueue queue([&](const GestureEditBatch& batch) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        written += batch.additions.size();
+    });
+
+    for (int i = 0; i < 10; i++) {
+        GestureEditBatch batch;
+        batch.additions.push_back({std::to_string(i) + ",1", "a", {}});
+        queue.submit(std::move(batch));
+    }
+    queue.shutdown();
+
+    EXPECT_EQ(written.load(), 10u);
+
+    // Nothing is accepted after shutdown
+    GestureEditBatch late;
+    late.additions.push_back({"9,9", "a", {}});
+    queue.submit(late);
+    queue.flush();
+    EXPECT_EQ(written.load(), 10u);
+}
@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include "../config_index.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const std::string CONFIG =
+    "general {\n"                          // 0
+    "}\n"                                  // 10
+    "plugin {\n"                           // 12
+    "  mouse_gestures {\n"                 // 21
+    "    drag_button = 273\n"              // 40
+    "    # ##\n"                           // 62
+    "    gesture_action = kitty|1,1;2,2\n" // 71
+    "    gesture_action = foot|3,3;4,4\n"  // 106
+    "  }\n"                                // 140
+    "}\n";                                 // 144
+
+class ConfigIndexFileTest : public ::testing::Test {
+  protected:
+    std::string dir;
+    std::string path;
+
+    void SetUp() override {
+        dir = std::string(testing::TempDir()) + "/config_index_" +
+              ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        path = dir + "/hyprland.conf";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+    }
+
+    void writeFile(const std::string& content) {
+        std::ofstream out(path, std::ios::trunc);
+        out << content;
+    }
+};
+
+} // namespace
+
+TEST(ConfigIndexTest, IndexesSectionOffsets) {
+    const auto index = indexConfigText(CONFIG);
+
+    EXPECT_TRUE(index.exists);
+    EXPECT_EQ(index.size, CONFIG.size());
+    EXPECT_TRUE(index.mentionsGestures);
+    EXPECT_TRUE(index.hasGestureLines);
+    ASSERT_TRUE(index.hasSection());
+    EXPECT_EQ(index.bodyBegin, 40u);
+    EXPECT_EQ(index.bodyEnd, 140u);
+    EXPECT_EQ(index.pluginEnd, 144u);
+
+    // The comment above the first gesture line is part of the range
+    EXPECT_EQ(index.gestureLinesBegin, 62u);
+    EXPECT_EQ(index.gestureLinesEnd, 140u);
+}
+
+TEST(ConfigIndexTest, NoSection) {
+    auto index = indexConfigText("general {\n}\nplugin {\n  other {\n  }\n}\n");
+    EXPECT_FALSE(index.hasSection());
+    EXPECT_FALSE(index.mentionsGestures);
+    EXPECT_FALSE(index.hasGestureLines);
+    EXPECT_EQ(index.pluginEnd, 35u);
+
+    // plugin:mouse_gestures:... keywords don't open a block
+    index = indexConfigText("plugin:mouse_gestures:drag_button = 272\n");
+    EXPECT_TRUE(index.mentionsGestures);
+    EXPECT_FALSE(index.hasSection());
+    EXPECT_EQ(index.pluginEnd, ConfigSectionIndex::npos);
+}
+
+TEST(ConfigIndexTest, DeleteOnlyTouchesGestureLines) {
+    std::string content = CONFIG;
+    auto index = indexConfigText(content);
+
+    EXPECT_EQ(deleteIndexedGestures(content, index, {"1,1;2,2"}), 1u);
+    EXPECT_EQ(content,
+              "general {\n}\nplugin {\n  mouse_gestures {\n    drag_button = 273\n"
+              "    gesture_action = foot|3,3;4,4\n  }\n}\n");
+
+    // The offsets were moved instead of rescanned and still match
+    const auto fresh = indexConfigText(content);
+    EXPECT_EQ(index.bodyBegin, fresh.bodyBegin);
+    EXPECT_EQ(index.bodyEnd, fresh.bodyEnd);
+    EXPECT_EQ(index.pluginEnd, fresh.pluginEnd);
+    EXPECT_EQ(index.size, content.size());
+
+    EXPECT_EQ(deleteIndexedGestures(content, index, {"9,9"}), 0u);
+}
+
+TEST(ConfigIndexTest, InsertIntoSection) {
+    std::string content = CONFIG;
+    insertIndexedGestures(content, indexConfigText(content), {"    gesture_action = a|5,5"});
+    EXPECT_EQ(content.substr(106),
+              "    gesture_action = foot|3,3;4,4\n    gesture_action = a|5,5\n  }\n}\n");
+}
+
+TEST(ConfigIndexTest, InsertNewSectionAndPluginBlock) {
+    std::string content = "plugin {\n  other {\n  }\n}\n";
+    insertIndexedGestures(content, indexConfigText(content), {"    gesture_action = a|1,1"});
+    EXPECT_EQ(content,
+              "plugin {\n  other {\n  }\n\n  mouse_gestures {\n    gesture_action = a|1,1\n  }\n}\n");
+
+    content = "general {\n}";
+    insertIndexedGestures(content, indexConfigText(content), {"    gesture_action = a|1,1"});
+    EXPECT_EQ(content,
+              "general {\n}\n\nplugin {\n  mouse_gestures {\n    gesture_action = a|1,1\n  }\n}\n");
+}
+
+// A same-size edit the cached index missed: offsets from the old text
+// point into the middle of lines of the new one
+TEST(ConfigIndexTest, SameSizeEditNeedsFreshIndex) {
+    std::string edited = CONFIG;
+    edited.insert(0, "# x\n");
+    edited.replace(edited.find("kitty"), 5, "k");
+    ASSERT_EQ(edited.size(), CONFIG.size());
+
+    const auto stale = indexConfigText(CONFIG);
+    auto fresh = indexConfigText(edited);
+    EXPECT_NE(fresh.gestureLinesBegin, stale.gestureLinesBegin);
+    EXPECT_EQ(fresh.gestureLinesEnd, stale.gestureLinesEnd);
+
+    EXPECT_EQ(deleteIndexedGestures(edited, fresh, {"3,3;4,4"}), 1u);
+    insertIndexedGestures(edited, fresh, {"    gesture_action = x|9,9"});
+    EXPECT_EQ(edited,
+              "# x\ngeneral {\n}\nplugin {\n  mouse_gestures {\n    drag_button = 273\n"
+              "    # ##\n    gesture_action = k|1,1;2,2\n    gesture_action = x|9,9\n  }\n}\n");
+}
+
+// An unchanged file is read once, however often it is looked up
+TEST_F(ConfigIndexFileTest, IndexesOnce) {
+    writeFile(CONFIG);
+    ConfigFileIndex index({path});
+
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(index.get(0).hasSection());
+    }
+    EXPECT_EQ(index.reindexCount(), 1u);
+}
+
+TEST_F(ConfigIndexFileTest, ReindexesAfterChange) {
+    writeFile(CONFIG);
+    ConfigFileIndex index({path});
+    ASSERT_TRUE(index.watching());
+    EXPECT_TRUE(index.get(0).hasSection());
+
+    writeFile("general {\n}\n");
+    EXPECT_FALSE(index.get(0).hasSection());
+    EXPECT_EQ(index.reindexCount(), 2u);
+
+    // Replaced by a rename, like the config writer and most editors do
+    {
+        std::ofstream out(path + ".new");
+        out << CONFIG;
+    }
+    std::rename((path + ".new").c_str(), path.c_str());
+    EXPECT_TRUE(index.get(0).hasSection());
+    EXPECT_EQ(index.reindexCount(), 3u);
+
+    std::remove(path.c_str());
+    EXPECT_FALSE(index.get(0).exists);
+}
+
+// A change event for a file whose contents are the same doesn't re-read it
+TEST_F(ConfigIndexFileTest, IgnoresTouchWithoutChange) {
+    writeFile(CONFIG);
+    ConfigFileIndex index({path, dir + "/other.conf"});
+    index.get(0);
+
+    std::ofstream(dir + "/other.conf") << "x\n";
+    index.get(0);
+    EXPECT_EQ(index.reindexCount(), 1u);
+}
+
+TEST_F(ConfigIndexFileTest, UpdateAfterOwnWrite) {
+    writeFile(CONFIG);
+    ConfigFileIndex index({path});
+    index.get(0);
+
+    std::string content = CONFIG;
+    auto sectionIndex = index.get(0);
+    deleteIndexedGestures(content, sectionIndex, {"3,3;4,4"});
+    ASSERT_TRUE(writeConfigAtomically(path, content, ConfigFsyncPolicy::None));
+    index.update(0, content);
+
+    EXPECT_EQ(index.get(0).bodyEnd, indexConfigText(content).bodyEnd);
+    EXPECT_EQ(index.reindexCount(), 1u);
+}
+
+TEST_F(ConfigIndexFileTest, MissingFile) {
+    ConfigFileIndex index({path, dir + "/missing/plugins.conf"});
+    EXPECT_FALSE(index.get(0).exists);
+    EXPECT_FALSE(index.get(1).exists);
+
+    // Created later, picked up through the directory watch
+    writeFile(CONFIG);
+    EXPECT_TRUE(index.get(0).hasSection());
+}
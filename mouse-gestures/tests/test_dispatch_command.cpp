@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "../dispatch_command.hpp"
+
+TEST(DispatchCommandTest, PlainDispatch) {
+    auto result = parseDispatchCommand("hyprctl dispatch workspace e+1");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->dispatcher, "workspace");
+    EXPECT_EQ(result->arg, "e+1");
+
+    result = parseDispatchCommand("  hyprctl   dispatch\tkillactive  ");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->dispatcher, "killactive");
+    EXPECT_EQ(result->arg, "");
+
+    result = parseDispatchCommand("/usr/bin/hyprctl dispatch togglefloating");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->dispatcher, "togglefloating");
+}
+
+// Remaining words are joined with single spaces, quotes are removed
+TEST(DispatchCommandTest, ArgumentsAndQuoting) {
+    auto result = parseDispatchCommand("hyprctl dispatch movewindow   mon:DP-1");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->arg, "mon:DP-1");
+
+    result = parseDispatchCommand("hyprctl dispatch exec \"kitty --class float\"");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->dispatcher, "exec");
+    EXPECT_EQ(result->arg, "kitty --class float");
+
+    result = parseDispatchCommand("hyprctl dispatch exec 'notify-send \"a b\"' now");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->arg, "notify-send \"a b\" now");
+
+    result = parseDispatchCommand("hyprctl dispatch resizeactive 10 -10");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->arg, "10 -10");
+}
+
+// Anything the shell would do more with stays a shell command
+TEST(DispatchCommandTest, RejectsShellFeatures) {
+    for (const char* command : {
+             "hyprctl dispatch workspace $WS",
+             "hyprctl dispatch exec \"$TERMINAL\"",
+             "hyprctl dispatch exec `which kitty`",
+             "hyprctl dispatch workspace 1; notify-send done",
+             "hyprctl dispatch workspace 1 && true",
+             "hyprctl dispatch workspace 1 | cat",
+             "hyprctl dispatch workspace 1 > /dev/null",
+             "hyprctl dispatch exec kitty &",
+             "hyprctl dispatch exec ~/bin/script",
+             "hyprctl dispatch exec ls *",
+             "hyprctl dispatch exec a\\ b",
+             "hyprctl dispatch exec \"unterminated",
+             "hyprctl dispatch workspace 1 # comment",
+             "hyprctl dispatch exec (subshell)",
+         }) {
+        EXPECT_FALSE(parseDispatchCommand(command).has_value()) << command;
+    }
+}
+
+TEST(DispatchCommandTest, RejectsOtherCommands) {
+    for (const char* command : {
+             "",
+             "hyprctl",
+             "hyprctl dispatch",
+             "hyprctl -j dispatch workspace 1",
+             "hyprctl dispatch -- workspace 1",
+             "hyprctl keyword general:gaps_in 5",
+             "hyprctl notify -1 2000 \"rgb(ff0000)\" hi",
+             "notify-send hyprctl dispatch",
+             "myhyprctl dispatch workspace 1",
+             "kitty",
+         }) {
+        EXPECT_FALSE(parseDispatchCommand(command).has_value()) << command;
+    }
+}
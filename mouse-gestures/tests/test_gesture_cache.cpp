@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include "../gesture_cache.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+class GestureCacheTest : public ::testing::Test {
+protected:
+    std::string testDir;
+    std::string cachePath;
+
+    void SetUp() override {
+        testDir = fs::temp_directory_path() / "gesture_cache_test";
+        fs::remove_all(testDir);
+        cachePath = testDir + "/nested/dir/mouse-gestures.cache";
+    }
+
+    void TearDown() override {
+        if (fs::exists(testDir)) {
+            fs::remove_all(testDir);
+        }
+    }
+
+    static std::string makeStrokeData(int variant, int numPoints = 30) {
+        Stroke stroke;
+        for (int i = 0; i < numPoints; i++) {
+            stroke.addPoint(10.0 * i, std::sin(0.3 * i + variant) * 40.0 + variant * i);
+        }
+        stroke.finish();
+        return stroke.serialize();
+    }
+
+    static void expectSameStroke(const Stroke& a, const Stroke& b) {
+        ASSERT_EQ(a.size(), b.size());
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_EQ(a.getPoints()[i].x, b.getPoints()[i].x);
+            EXPECT_EQ(a.getPoints()[i].y, b.getPoints()[i].y);
+            EXPECT_EQ(a.getPoints()[i].t, b.getPoints()[i].t);
+            EXPECT_EQ(a.getPoints()[i].alpha, b.getPoints()[i].alpha);
+        }
+        EXPECT_EQ(a.getFeatures().turns, b.getFeatures().turns);
+        EXPECT_EQ(a.getFeatures().startDir, b.getFeatures().startDir);
+        EXPECT_EQ(a.getFeatures().histogram, b.getFeatures().histogram);
+        EXPECT_EQ(a.compare(b), 0.0);
+    }
+};
+
+// Cached strokes come back exactly as they were finished
+TEST_F(GestureCacheTest, RoundTrip) {
+    std::vector<std::string> data = {makeStrokeData(0), makeStrokeData(1), makeStrokeData(2)};
+    std::vector<Stroke> patterns;
+    for (const auto& d : data) {
+        patterns.push_back(Stroke::deserialize(d));
+    }
+    Stroke resampled = Stroke::deserialize(data[0], 16);
+
+    std::vector<GestureCache::Record> records;
+    for (size_t i = 0; i < data.size(); i++) {
+        records.push_back({data[i], 0, &patterns[i]});
+    }
+    records.push_back({data[0], 16, &resampled});
+    ASSERT_TRUE(GestureCache::write(cachePath, records));
+
+    GestureCache cache;
+    ASSERT_TRUE(cache.open(cachePath));
+    EXPECT_EQ(cache.size(), 4u);
+
+    for (size_t i = 0; i < data.size(); i++) {
+        Stroke restored;
+        ASSERT_TRUE(cache.lookup(data[i], 0, restored));
+        ASSERT_TRUE(restored.isFinished());
+        expectSameStroke(restored, patterns[i]);
+    }
+
+    Stroke restored;
+    ASSERT_TRUE(cache.lookup(data[0], 16, restored));
+    expectSameStroke(restored, resampled);
+}
+
+// Padding in the table entries and features is written as zeros, not
+// whatever the stack held
+TEST_F(GestureCacheTest, PaddingIsZeroed) {
+    const std::string data = makeStrokeData(3);
+    Stroke pattern = Stroke::deserialize(data);
+    ASSERT_TRUE(GestureCache::write(cachePath, {{data, 0, &pattern}}));
+
+    std::ifstream in(cachePath, std::ios::binary);
+    const std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(in)),
+                                           std::istreambuf_iterator<char>());
+
+    // Header (32 bytes), then hash, length, resampleCount, pointCount,
+    // reserved, offset
+    ASSERT_GE(bytes.size(), 64u);
+    for (size_t i = 52; i < 56; i++) {
+        EXPECT_EQ(bytes[i], 0) << "entry byte " << i - 32;
+    }
+
+    uint64_t offset = 0;
+    std::memcpy(&offset, bytes.data() + 56, sizeof(offset));
+    constexpr size_t FIELDS_END = offsetof(StrokeFeatures, turns) + sizeof(int);
+    ASSERT_GE(bytes.size(), offset + sizeof(StrokeFeatures));
+    for (size_t i = FIELDS_END; i < sizeof(StrokeFeatures); i++) {
+        EXPECT_EQ(bytes[offset + i], 0) << "features byte " << i;
+    }
+}
+
+// Changed strokes and other resample counts miss
+TEST_F(GestureCacheTest, MissesOnDifferentKey) {
+    std::string data = makeStrokeData(0);
+    Stroke pattern = Stroke::deserialize(data);
+    ASSERT_TRUE(GestureCache::write(cachePath, {{data, 0, &pattern}}));
+
+    GestureCache cache;
+    ASSERT_TRUE(cache.open(cachePath));
+
+    Stroke out;
+    EXPECT_FALSE(cache.lookup(data, 32, out));
+    EXPECT_FALSE(cache.lookup(makeStrokeData(1), 0, out));
+    EXPECT_FALSE(cache.lookup(data.substr(1), 0, out));
+    EXPECT_FALSE(out.isFinished());
+}
+
+// Unfinished strokes are skipped and duplicates stored once
+TEST_F(GestureCacheTest, SkipsUnfinishedAndDuplicates) {
+    std::string data = makeStrokeData(0);
+    Stroke pattern = Stroke::deserialize(data);
+    Stroke unfinished;
+
+    ASSERT_TRUE(GestureCache::write(cachePath, {
+        {data, 0, &pattern}, {data, 0, &pattern}, {"garbage", 0, &unfinished}}));
+
+    GestureCache cache;
+    ASSERT_TRUE(cache.open(cachePath));
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+// An empty library still produces a valid cache
+TEST_F(GestureCacheTest, EmptyCache) {
+    ASSERT_TRUE(GestureCache::write(cachePath, {}));
+
+    GestureCache cache;
+    ASSERT_TRUE(cache.open(cachePath));
+    EXPECT_EQ(cache.size(), 0u);
+
+    Stroke out;
+    EXPECT_FALSE(cache.lookup(makeStrokeData(0), 0, out));
+}
+
+// Missing, truncated and foreign files are rejected
+TEST_F(GestureCacheTest, RejectsInvalidFiles) {
+    GestureCache cache;
+    EXPECT_FALSE(cache.open(cachePath));
+    EXPECT_FALSE(cache.isOpen());
+
+    std::string data = makeStrokeData(0);
+    Stroke pattern = Stroke::deserialize(data);
+    ASSERT_TRUE(GestureCache::write(cachePath, {{data, 0, &pattern}}));
+
+    const auto fullSize = fs::file_size(cachePath);
+    fs::resize_file(cachePath, fullSize - 8);
+    EXPECT_FALSE(cache.open(cachePath));
+
+    std::ofstream(cachePath, std::ios::trunc) << "gesture_action = cmd|0,0;1,1;";
+    EXPECT_FALSE(cache.open(cachePath));
+
+    Stroke out;
+    EXPECT_FALSE(cache.lookup(data, 0, out));
+}
+
+// Files written with another format version are ignored
+TEST_F(GestureCacheTest, RejectsOtherVersion) {
+    std::string data = makeStrokeData(0);
+    Stroke pattern = Stroke::deserialize(data);
+    ASSERT_TRUE(GestureCache::write(cachePath, {{data, 0, &pattern}}));
+
+    std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(4);
+    const uint32_t otherVersion = GestureCache::VERSION + 1;
+    file.write(reinterpret_cast<const char*>(&otherVersion), sizeof(otherVersion));
+    file.close();
+
+    GestureCache cache;
+    EXPECT_FALSE(cache.open(cachePath));
+}
+
+// Rewriting the file leaves an existing mapping intact
+TEST_F(GestureCacheTest, MappingSurvivesRewrite) {
+    std::string first = makeStrokeData(0);
+    Stroke firstPattern = Stroke::deserialize(first);
+    ASSERT_TRUE(GestureCache::write(cachePath, {{first, 0, &firstPattern}}));
+
+    GestureCache cache;
+    ASSERT_TRUE(cache.open(cachePath));
+
+    std::string second = makeStrokeData(1);
+    Stroke secondPattern = Stroke::deserialize(second);
+    ASSERT_TRUE(GestureCache::write(cachePath, {{second, 0, &secondPattern}}));
+    EXPECT_FALSE(fs::exists(cachePath + ".tmp"));
+
+    Stroke out;
+    EXPECT_TRUE(cache.lookup(first, 0, out));
+    EXPECT_FALSE(cache.lookup(second, 0, out));
+
+    ASSERT_TRUE(cache.open(cachePath));
+    EXPECT_FALSE(cache.lookup(first, 0, out));
+    EXPECT_TRUE(cache.lookup(second, 0, out));
+}
+
+// The cache lives under XDG_CACHE_HOME, or ~/.cache without it
+TEST_F(GestureCacheTest, DefaultPath) {
+    const char* oldXdg = std::getenv("XDG_CACHE_HOME");
+    const std::string savedXdg = oldXdg ? oldXdg : "";
+
+    setenv("XDG_CACHE_HOME", "/tmp/xdg-cache", 1);
+    EXPECT_EQ(GestureCache::defaultPath(), "/tmp/xdg-cache/hyprland-plugins/mouse-gestures.cache");
+
+    unsetenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (home) {
+        EXPECT_EQ(GestureCache::defaultPath(),
+                  std::string(home) + "/.cache/hyprland-plugins/mouse-gestures.cache");
+    }
+
+    if (oldXdg) {
+        setenv("XDG_CACHE_HOME", savedXdg.c_str(), 1);
+    }
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "../gesture_match_pool.hpp"
+#include <cmath>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class GestureMatchPoolTest : public ::testing::Test {
+protected:
+    struct Library {
+        std::vector<Stroke> strokes;
+        GestureFeatureIndex index;
+    };
+
+    static Stroke makeStroke(const std::vector<std::pair<double, double>>& corners,
+                             int samplesPerSegment = 8) {
+        Stroke stroke;
+        for (size_t i = 0; i + 1 < corners.size(); i++) {
+            for (int s = 0; s < samplesPerSegment; s++) {
+                double t = static_cast<double>(s) / samplesPerSegment;
+                stroke.addPoint(corners[i].first + (corners[i + 1].first - corners[i].first) * t,
+                                corners[i].second + (corners[i + 1].second - corners[i].second) * t);
+            }
+        }
+        stroke.addPoint(corners.back().first, corners.back().second);
+        stroke.finish();
+        return stroke;
+    }
+
+    static Stroke makeArc(double startAngle, double sweep, int numPoints = 30) {
+        Stroke stroke;
+        for (int i = 0; i < numPoints; i++) {
+            double angle = startAngle + sweep * i / (numPoints - 1);
+            stroke.addPoint(100.0 + 50.0 * std::cos(angle), 100.0 + 50.0 * std::sin(angle));
+        }
+        stroke.finish();
+        return stroke;
+    }
+
+    static const Stroke& identity(const Stroke& stroke) { return stroke; }
+
+    static std::shared_ptr<Library> buildLibrary() {
+        auto library = std::make_shared<Library>();
+        library->strokes.push_back(makeStroke({{0, 0}, {100, 0}}));
+        library->strokes.push_back(makeStroke({{100, 0}, {0, 0}}));
+        library->strokes.push_back(makeStroke({{0, 0}, {0, 100}}));
+        library->strokes.push_back(makeStroke({{0, 0}, {0, 100}, {100, 100}}));
+        library->strokes.push_back(makeStroke({{0, 100}, {50, 0}, {100, 100}}));
+        library->strokes.push_back(makeArc(0.0, M_PI));
+        library->strokes.push_back(makeArc(0.0, 2.0 * M_PI));
+        library->strokes.push_back(makeStroke({{0, 0}, {100, 100}}));
+        library->strokes.push_back(makeStroke({{0, 0}, {100, 0}, {100, 100}, {0, 100}}));
+        library->index.rebuild(library->strokes, identity);
+        return library;
+    }
+
+    // Submit a match and block until the pool reports back
+    static GestureMatch matchOnPool(GestureMatchPool& pool, const std::shared_ptr<Library>& library,
+                                    const Stroke& input, double maxFeatureDistance = 0.0,
+                                    double threshold = 0.2) {
+        std::promise<GestureMatch> result;
+        auto future = result.get_future();
+        const Library* raw = library.get();
+
+        bool submitted = pool.submit(
+            library, input, raw->index,
+            [raw](int index) -> const Stroke& { return raw->strokes[index]; },
+            maxFeatureDistance, threshold,
+            [&result](const GestureMatch& match) { result.set_value(match); });
+        EXPECT_TRUE(submitted);
+
+        return future.get();
+    }
+};
+
+// The pool must pick the same template as the serial matcher
+TEST_F(GestureMatchPoolTest, AgreesWithSerialMatcher) {
+    auto library = buildLibrary();
+    GestureMatchPool pool(3);
+
+    std::vector<Stroke> inputs = {
+        makeStroke({{0, 0}, {0, 110}, {95, 105}}),
+        makeStroke({{5, 100}, {55, 5}, {100, 95}}),
+        makeArc(0.1, M_PI * 0.95),
+        makeStroke({{0, 0}, {120, 3}}),
+        makeStroke({{0, 0}, {90, 110}}),
+    };
+
+    for (const auto& input : inputs) {
+        auto expected = findBestStrokeMatch(input, library->strokes, library->index,
+                                            0.0, 0.2, identity);
+        auto match = matchOnPool(pool, library, input);
+
+        EXPECT_EQ(match.index, expected.index);
+        EXPECT_DOUBLE_EQ(match.cost, expected.cost);
+        EXPECT_EQ(match.evaluated, library->strokes.size());
+        EXPECT_EQ(match.filtered, 0u);
+    }
+}
+
+// Prefilter counts are reported like the serial matcher does
+TEST_F(GestureMatchPoolTest, ReportsPrefilteredTemplates) {
+    auto library = buildLibrary();
+    GestureMatchPool pool(2);
+
+    Stroke input = makeStroke({{0, 0}, {0, 110}, {95, 105}});
+    auto expected = findBestStrokeMatch(input, library->strokes, library->index,
+                                        0.15, 0.2, identity);
+    auto match = matchOnPool(pool, library, input, 0.15);
+
+    EXPECT_EQ(match.index, expected.index);
+    EXPECT_EQ(match.filtered, expected.filtered);
+    EXPECT_EQ(match.evaluated + match.filtered, library->strokes.size());
+}
+
+// Nothing below the threshold reports no match
+TEST_F(GestureMatchPoolTest, NoMatchBelowThreshold) {
+    auto library = buildLibrary();
+    GestureMatchPool pool(2);
+
+    auto match = matchOnPool(pool, library, makeArc(0.0, M_PI), 0.0, 0.0);
+    EXPECT_EQ(match.index, -1);
+    EXPECT_EQ(match.cost, STROKE_INFINITY);
+}
+
+// An empty library still completes the request
+TEST_F(GestureMatchPoolTest, EmptyLibraryCompletes) {
+    auto library = std::make_shared<Library>();
+    library->index.rebuild(library->strokes, identity);
+    GestureMatchPool pool(4);
+
+    auto match = matchOnPool(pool, library, makeStroke({{0, 0}, {100, 0}}));
+    EXPECT_EQ(match.index, -1);
+    EXPECT_EQ(match.evaluated, 0u);
+}
+
+// Concurrent requests each get their own result
+TEST_F(GestureMatchPoolTest, ConcurrentRequests) {
+    auto library = buildLibrary();
+    GestureMatchPool pool(3);
+
+    std::vector<Stroke> inputs;
+    for (int i = 0; i < 16; i++) {
+        inputs.push_back(i % 2 ? makeArc(0.05 * i, M_PI) : makeStroke({{0, 0}, {100.0 + i, 2.0}}));
+    }
+
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<int> results(inputs.size(), -2);
+    size_t completed = 0;
+
+    const Library* raw = library.get();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        pool.submit(library, inputs[i], raw->index,
+                    [raw](int index) -> const Stroke& { return raw->strokes[index]; },
+                    0.0, 0.2,
+                    [&, i](const GestureMatch& match) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        results[i] = match.index;
+                        completed++;
+                        done.notify_one();
+                    });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return completed == inputs.size(); });
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        auto expected = findBestStrokeMatch(inputs[i], library->strokes, 0.2, identity);
+        EXPECT_EQ(results[i], expected.index);
+    }
+}
+
+// The library snapshot stays alive until the request completes
+TEST_F(GestureMatchPoolTest, KeepsLibraryAlive) {
+    GestureMatchPool pool(2);
+    std::weak_ptr<Library> weak;
+    GestureMatch match;
+
+    {
+        auto library = buildLibrary();
+        weak = library;
+        match = matchOnPool(pool, library, makeStroke({{0, 0}, {100, 0}}));
+    }
+
+    EXPECT_EQ(match.index, 0);
+    pool.shutdown();
+    EXPECT_TRUE(weak.expired());
+}
+
+// Submitting after shutdown is rejected without calling back
+TEST_F(GestureMatchPoolTest, RejectsAfterShutdown) {
+    auto library = buildLibrary();
+    GestureMatchPool pool(2);
+    pool.shutdown();
+    pool.shutdown();
+
+    bool called = false;
+    bool submitted = pool.submit(library, makeStroke({{0, 0}, {100, 0}}), library->index,
+                                 [&library](int index) -> const Stroke& {
+                                     return library->strokes[index];
+                                 },
+                                 0.0, 0.2, [&called](const GestureMatch&) { called = true; });
+
+    EXPECT_FALSE(submitted);
+    EXPECT_FALSE(called);
+}
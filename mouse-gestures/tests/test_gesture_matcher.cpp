@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include "../gesture_matcher.hpp"
+#include <cmath>
+#include <vector>
+
+class GestureMatcherTest : public ::testing::Test {
+protected:
+    // Build a finished stroke from a polyline sampled along `corners`
+    static Stroke makeStroke(const std::vector<std::pair<double, double>>& corners,
+                             int samplesPerSegment = 8) {
+        Stroke stroke;
+        for (size_t i = 0; i + 1 < corners.size(); i++) {
+            for (int s = 0; s < samplesPerSegment; s++) {
+                double t = static_cast<double>(s) / samplesPerSegment;
+                stroke.addPoint(corners[i].first + (corners[i + 1].first - corners[i].first) * t,
+                                corners[i].second + (corners[i + 1].second - corners[i].second) * t);
+            }
+        }
+        stroke.addPoint(corners.back().first, corners.back().second);
+        stroke.finish();
+        return stroke;
+    }
+
+    static Stroke makeArc(double startAngle, double sweep, int numPoints = 30) {
+        Stroke stroke;
+        for (int i = 0; i < numPoints; i++) {
+            double angle = startAngle + sweep * i / (numPoints - 1);
+            stroke.addPoint(100.0 + 50.0 * std::cos(angle), 100.0 + 50.0 * std::sin(angle));
+        }
+        stroke.finish();
+        return stroke;
+    }
+
+    std::vector<Stroke> buildLibrary() {
+        std::vector<Stroke> library;
+        library.push_back(makeStroke({{0, 0}, {100, 0}}));               // Right
+        library.push_back(makeStroke({{100, 0}, {0, 0}}));               // Left
+        library.push_back(makeStroke({{0, 0}, {0, 100}}));               // Down
+        library.push_back(makeStroke({{0, 0}, {0, 100}, {100, 100}}));   // L-shape
+        library.push_back(makeStroke({{0, 100}, {50, 0}, {100, 100}}));  // Caret
+        library.push_back(makeArc(0.0, M_PI));                           // Half circle
+        library.push_back(makeArc(0.0, 2.0 * M_PI));                     // Full circle
+        return library;
+    }
+
+    static const Stroke& identity(const Stroke& stroke) { return stroke; }
+};
+
+// The bounded matcher must pick the same template as an exhaustive scan
+TEST_F(GestureMatcherTest, MatchesExhaustiveScan) {
+    auto library = buildLibrary();
+
+    std::vector<Stroke> inputs = {
+        makeStroke({{0, 0}, {0, 110}, {95, 105}}),
+        makeStroke({{5, 100}, {55, 5}, {100, 95}}),
+        makeArc(0.1, M_PI * 0.95),
+        makeStroke({{0, 0}, {120, 3}}),
+    };
+
+    for (const auto& input : inputs) {
+        int expectedIndex = -1;
+        double expectedCost = 0.2;
+        for (size_t i = 0; i < library.size(); i++) {
+            double cost = input.compare(library[i]);
+            if (cost < expectedCost) {
+                expectedCost = cost;
+                expectedIndex = static_cast<int>(i);
+            }
+        }
+
+        auto match = findBestStrokeMatch(input, library, 0.2, identity);
+        EXPECT_EQ(match.index, expectedIndex);
+        if (expectedIndex >= 0) {
+            EXPECT_DOUBLE_EQ(match.cost, expectedCost);
+        }
+        EXPECT_EQ(match.evaluated, library.size());
+    }
+}
+
+// No template below the threshold yields no match
+TEST_F(GestureMatcherTest, NoMatchAboveThreshold) {
+    auto library = buildLibrary();
+    Stroke input = makeStroke({{0, 0}, {100, 0}});
+
+    auto match = findBestStrokeMatch(input, library, 0.0, identity);
+    EXPECT_EQ(match.index, -1);
+    EXPECT_EQ(match.cost, STROKE_INFINITY);
+}
+
+// Unfinished templates are skipped and not counted as evaluated
+TEST_F(GestureMatcherTest, SkipsUnfinishedTemplates) {
+    std::vector<Stroke> library(2);
+    library[0].addPoint(0, 0);
+    library[1] = makeStroke({{0, 0}, {100, 0}});
+
+    Stroke input = makeStroke({{0, 0}, {100, 0}});
+    auto match = findBestStrokeMatch(input, library, 0.2, identity);
+    EXPECT_EQ(match.index, 1);
+    EXPECT_EQ(match.evaluated, 1u);
+}
+
+// Unfinished input never matches
+TEST_F(GestureMatcherTest, UnfinishedInput) {
+    auto library = buildLibrary();
+    Stroke input;
+    input.addPoint(0, 0);
+
+    auto match = findBestStrokeMatch(input, library, 0.2, identity);
+    EXPECT_EQ(match.index, -1);
+    EXPECT_EQ(match.evaluated, 0u);
+}
+
+// Without a distance cut the indexed matcher agrees with the linear scan
+TEST_F(GestureMatcherTest, IndexedMatchesLinearScan) {
+    auto library = buildLibrary();
+    GestureFeatureIndex index;
+    index.rebuild(library, identity);
+    EXPECT_TRUE(index.isValidFor(library.size()));
+
+    std::vector<Stroke> inputs = {
+        makeStroke({{0, 0}, {0, 110}, {95, 105}}),
+        makeStroke({{5, 100}, {55, 5}, {100, 95}}),
+        makeArc(0.1, M_PI * 0.95),
+        makeStroke({{0, 0}, {120, 3}}),
+    };
+
+    for (const auto& input : inputs) {
+        auto linear = findBestStrokeMatch(input, library, 0.2, identity);
+        auto indexed = findBestStrokeMatch(input, library, index, 0.0, 0.2, identity);
+        EXPECT_EQ(indexed.index, linear.index);
+        EXPECT_DOUBLE_EQ(indexed.cost, linear.cost);
+        EXPECT_EQ(indexed.filtered, 0u);
+    }
+}
+
+// A distance cut keeps distant templates away from the DP
+TEST_F(GestureMatcherTest, PrefilterSkipsDistantTemplates) {
+    auto library = buildLibrary();
+    GestureFeatureIndex index;
+    index.rebuild(library, identity);
+
+    Stroke input = makeStroke({{0, 0}, {0, 110}, {95, 105}});
+    auto match = findBestStrokeMatch(input, library, index, 0.3, 0.2, identity);
+
+    EXPECT_EQ(match.index, 3);  // L-shape
+    EXPECT_GT(match.filtered, 0u);
+    EXPECT_EQ(match.evaluated + match.filtered, library.size());
+}
+
+// Invalidation is tracked per library size and explicit calls
+TEST_F(GestureMatcherTest, IndexInvalidation) {
+    auto library = buildLibrary();
+    GestureFeatureIndex index;
+    EXPECT_FALSE(index.isValidFor(library.size()));
+
+    index.rebuild(library, identity);
+    EXPECT_TRUE(index.isValidFor(library.size()));
+    EXPECT_FALSE(index.isValidFor(library.size() + 1));
+
+    index.invalidate();
+    EXPECT_FALSE(index.isValidFor(library.size()));
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "../gesture_predictor.hpp"
+#include <cmath>
+#include <vector>
+
+class GesturePredictorTest : public ::testing::Test {
+protected:
+    static GestureMatch makeMatch(int index, double cost) {
+        GestureMatch match;
+        match.index = index;
+        match.cost = cost;
+        return match;
+    }
+
+    static Stroke makeLine(double dx, double dy, int numPoints = 20) {
+        Stroke stroke;
+        for (int i = 0; i < numPoints; i++) {
+            stroke.addPoint(dx * i, dy * i);
+        }
+        stroke.finish();
+        return stroke;
+    }
+
+    static const Stroke& identity(const Stroke& stroke) { return stroke; }
+
+    int libraryTag = 0;
+    int otherLibraryTag = 0;
+};
+
+// Speculation starts once enough new points arrived
+TEST_F(GesturePredictorTest, SpeculatesEveryInterval) {
+    GesturePredictor predictor(4);
+    predictor.begin();
+
+    EXPECT_FALSE(predictor.shouldSpeculate(1));
+    EXPECT_FALSE(predictor.shouldSpeculate(3));
+    EXPECT_TRUE(predictor.shouldSpeculate(4));
+
+    predictor.submitted(4);
+    EXPECT_FALSE(predictor.shouldSpeculate(20));  // Still in flight
+
+    predictor.complete(predictor.currentSequence(), 4, makeMatch(1, 0.1), &libraryTag);
+    EXPECT_FALSE(predictor.shouldSpeculate(7));
+    EXPECT_TRUE(predictor.shouldSpeculate(8));
+}
+
+// A failed submission does not block later speculation
+TEST_F(GesturePredictorTest, CancelledAllowsRetry) {
+    GesturePredictor predictor(4);
+    predictor.begin();
+
+    predictor.submitted(4);
+    predictor.cancelled();
+    EXPECT_TRUE(predictor.shouldSpeculate(8));
+}
+
+// Results of a previous stroke are ignored
+TEST_F(GesturePredictorTest, DropsStaleResults) {
+    GesturePredictor predictor;
+    predictor.begin();
+    const uint64_t oldSequence = predictor.currentSequence();
+    predictor.begin();
+
+    EXPECT_FALSE(predictor.complete(oldSequence, 10, makeMatch(2, 0.1), &libraryTag));
+    EXPECT_EQ(predictor.candidate().index, -1);
+    EXPECT_EQ(predictor.candidateSize(), 0u);
+}
+
+// An older result never replaces a newer candidate
+TEST_F(GesturePredictorTest, KeepsNewestCandidate) {
+    GesturePredictor predictor;
+    predictor.begin();
+    const uint64_t sequence = predictor.currentSequence();
+
+    EXPECT_TRUE(predictor.complete(sequence, 16, makeMatch(3, 0.1), &libraryTag));
+    EXPECT_TRUE(predictor.complete(sequence, 8, makeMatch(1, 0.05), &libraryTag));
+
+    EXPECT_EQ(predictor.candidate().index, 3);
+    EXPECT_EQ(predictor.candidateSize(), 16u);
+}
+
+// Only a prediction of the complete stroke against the same library is final
+TEST_F(GesturePredictorTest, CoversStrokeOnlyWhenComplete) {
+    GesturePredictor predictor;
+    predictor.begin();
+    predictor.complete(predictor.currentSequence(), 16, makeMatch(3, 0.1), &libraryTag);
+
+    EXPECT_TRUE(predictor.coversStroke(16, &libraryTag));
+    EXPECT_FALSE(predictor.coversStroke(17, &libraryTag));
+    EXPECT_FALSE(predictor.coversStroke(16, &otherLibraryTag));
+
+    EXPECT_EQ(predictor.hint(&libraryTag), 3);
+    EXPECT_EQ(predictor.hint(&otherLibraryTag), -1);
+}
+
+// A new stroke starts without a candidate
+TEST_F(GesturePredictorTest, BeginClearsCandidate) {
+    GesturePredictor predictor;
+    predictor.begin();
+    predictor.complete(predictor.currentSequence(), 16, makeMatch(3, 0.1), &libraryTag);
+    predictor.begin();
+
+    EXPECT_EQ(predictor.candidate().index, -1);
+    EXPECT_FALSE(predictor.coversStroke(16, &libraryTag));
+    EXPECT_EQ(predictor.hint(&libraryTag), -1);
+    EXPECT_TRUE(predictor.shouldSpeculate(GesturePredictor::DEFAULT_INTERVAL));
+}
+
+// The hinted template is evaluated first without changing the winner
+TEST_F(GesturePredictorTest, HintDoesNotChangeResult) {
+    std::vector<Stroke> library = {
+        makeLine(1, 0), makeLine(0, 1), makeLine(-1, 0), makeLine(1, 1),
+    };
+    GestureFeatureIndex index;
+    index.rebuild(library, identity);
+
+    Stroke input = makeLine(1, 0.95);
+    auto plain = findBestStrokeMatch(input, library, index, 0.0, 0.5, identity);
+    ASSERT_EQ(plain.index, 3);
+
+    for (int hint = -1; hint < static_cast<int>(library.size()); hint++) {
+        auto hinted = findBestStrokeMatch(input, library, index, 0.0, 0.5, identity, hint);
+        EXPECT_EQ(hinted.index, plain.index);
+        EXPECT_DOUBLE_EQ(hinted.cost, plain.cost);
+    }
+}
+
+// Promoting moves exactly one candidate to the front
+TEST_F(GesturePredictorTest, PromoteCandidate) {
+    std::vector<std::pair<double, int>> candidates = {{0.1, 4}, {0.2, 2}, {0.3, 7}};
+
+    promoteCandidate(candidates, 7);
+    EXPECT_EQ(candidates[0].second, 7);
+    EXPECT_EQ(candidates[1].second, 4);
+    EXPECT_EQ(candidates[2].second, 2);
+
+    promoteCandidate(candidates, 99);
+    promoteCandidate(candidates, -1);
+    EXPECT_EQ(candidates[0].second, 7);
+    EXPECT_EQ(candidates.size(), 3u);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "../gesture_stats.hpp"
+#include <thread>
+#include <vector>
+
+// Every value lands in a bucket that contains it
+TEST(StatsHistogramTest, BucketsContainTheirValues) {
+    for (uint64_t value : {0ULL, 1ULL, 3ULL, 4ULL, 5ULL, 7ULL, 8ULL, 100ULL, 1023ULL, 1024ULL,
+                           123456ULL, (1ULL << 31) + 17}) {
+        const int bucket = StatsHistogram::bucketFor(value);
+        ASSERT_GE(bucket, 0);
+        ASSERT_LT(bucket, StatsHistogram::BUCKETS);
+        EXPECT_LE(StatsHistogram::bucketLower(bucket), value) << value;
+        EXPECT_GT(StatsHistogram::bucketUpper(bucket), value) << value;
+    }
+}
+
+// Buckets tile the value range without gaps
+TEST(StatsHistogramTest, BucketsAreContiguous) {
+    for (int i = 0; i + 1 < StatsHistogram::BUCKETS; i++) {
+        EXPECT_EQ(StatsHistogram::bucketUpper(i), StatsHistogram::bucketLower(i + 1)) << i;
+    }
+}
+
+// Values beyond the covered range are clamped into the last bucket
+TEST(StatsHistogramTest, HugeValuesUseLastBucket) {
+    EXPECT_EQ(StatsHistogram::bucketFor(~0ULL), StatsHistogram::BUCKETS - 1);
+    EXPECT_EQ(StatsHistogram::bucketFor(1ULL << 40), StatsHistogram::BUCKETS - 1);
+}
+
+TEST(StatsHistogramTest, EmptySnapshot) {
+    StatsHistogram histogram;
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 0u);
+    EXPECT_EQ(snapshot.mean(), 0.0);
+    EXPECT_EQ(snapshot.percentile(0.99), 0.0);
+}
+
+// Percentiles are within the bucket resolution of the true value
+TEST(StatsHistogramTest, PercentilesApproximateTrueValues) {
+    StatsHistogram histogram;
+    for (uint64_t v = 1; v <= 10000; v++) {
+        histogram.record(v);
+    }
+
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 10000u);
+    EXPECT_EQ(snapshot.max, 10000u);
+    EXPECT_DOUBLE_EQ(snapshot.mean(), 5000.5);
+    EXPECT_NEAR(snapshot.percentile(0.50), 5000.0, 5000.0 * 0.25);
+    EXPECT_NEAR(snapshot.percentile(0.99), 9900.0, 9900.0 * 0.25);
+    EXPECT_LE(snapshot.percentile(1.0), 10001.0);
+}
+
+// A single repeated value reports that value at every quantile
+TEST(StatsHistogramTest, SingleValue) {
+    StatsHistogram histogram;
+    for (int i = 0; i < 50; i++) {
+        histogram.record(2);
+    }
+
+    auto snapshot = histogram.snapshot();
+    EXPECT_GE(snapshot.percentile(0.01), 2.0);
+    EXPECT_LE(snapshot.percentile(0.99), 3.0);
+}
+
+// Concurrent writers lose no samples
+TEST(StatsHistogramTest, ConcurrentRecording) {
+    StatsHistogram histogram;
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 20000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&histogram, t]() {
+            for (int i = 0; i < PER_THREAD; i++) {
+                histogram.record(static_cast<uint64_t>(t * PER_THREAD + i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto snapshot = histogram.snapshot();
+    uint64_t bucketTotal = 0;
+    for (uint64_t b : snapshot.buckets) {
+        bucketTotal += b;
+    }
+    EXPECT_EQ(snapshot.count, static_cast<uint64_t>(THREADS * PER_THREAD));
+    EXPECT_EQ(bucketTotal, snapshot.count);
+    EXPECT_EQ(snapshot.max, static_cast<uint64_t>(THREADS * PER_THREAD - 1));
+}
+
+TEST(StatsHistogramTest, Reset) {
+    StatsHistogram histogram;
+    histogram.record(42);
+    histogram.reset();
+
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 0u);
+    EXPECT_EQ(snapshot.max, 0u);
+    EXPECT_EQ(snapshot.sum, 0u);
+}
+
+// Decisions update counters and the per-decision histograms
+TEST(GestureStatsTest, RecordDecision) {
+    GestureStats stats;
+    const auto now = std::chrono::steady_clock::now();
+    stats.recordDecision(now, true, 12, 3);
+    stats.recordDecision(now, false, 20, 0);
+
+    EXPECT_EQ(stats.gestures.load(), 2u);
+    EXPECT_EQ(stats.matched.load(), 1u);
+    EXPECT_EQ(stats.unmatched.load(), 1u);
+    EXPECT_EQ(stats.releaseToDecision.snapshot().count, 2u);
+    EXPECT_EQ(stats.templatesEvaluated.snapshot().sum, 32u);
+    EXPECT_EQ(stats.templatesFiltered.snapshot().sum, 3u);
+
+    stats.reset();
+    EXPECT_EQ(stats.gestures.load(), 0u);
+    EXPECT_EQ(stats.templatesEvaluated.snapshot().count, 0u);
+}
+
+TEST(GestureStatsTest, JsonContainsAllSections) {
+    GestureStats stats;
+    stats.strokeBuild.record(150);
+    stats.releaseToDispatch.record(900);
+
+    const std::string json = stats.toJson("[{\"index\":0}]");
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    for (const char* key : {"\"gestures\":0", "\"direct_dispatches\":0", "\"latency_us\":",
+                            "\"stroke_build\":{\"count\":1",
+                            "\"release_to_dispatch\":{\"count\":1", "\"templates_evaluated\":",
+                            "\"per_gesture\":[{\"index\":0}]", "\"commands\":{}",
+                            "\"max\":900"}) {
+        EXPECT_NE(json.find(key), std::string::npos) << key;
+    }
+}
+
+TEST(GestureStatsTest, JsonStringEscaping) {
+    std::string out;
+    GestureStats::appendJsonString(out, "say \"hi\"\\\n\x01");
+    EXPECT_EQ(out, "\"say \\\"hi\\\"\\\\\\n\\u0001\"");
+}
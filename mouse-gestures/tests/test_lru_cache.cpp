@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "../lru_cache.hpp"
+#include <memory>
+#include <string>
+
+TEST(LruCacheTest, InsertAndFind) {
+    LruCache<std::string, int> cache(4);
+    EXPECT_EQ(cache.find("a"), nullptr);
+
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+    ASSERT_NE(cache.find("a"), nullptr);
+    EXPECT_EQ(*cache.find("a"), 1);
+    EXPECT_EQ(*cache.find("b"), 2);
+    EXPECT_EQ(cache.size(), 2u);
+
+    // Replacing keeps a single entry
+    cache.insert("a", 10);
+    EXPECT_EQ(*cache.find("a"), 10);
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsed) {
+    LruCache<int, int> cache(3);
+    cache.insert(1, 1);
+    cache.insert(2, 2);
+    cache.insert(3, 3);
+
+    // Using 1 makes 2 the oldest
+    EXPECT_NE(cache.find(1), nullptr);
+    cache.insert(4, 4);
+
+    EXPECT_EQ(cache.size(), 3u);
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_TRUE(cache.contains(4));
+
+    // Replacing counts as a use too
+    cache.insert(3, 30);
+    cache.insert(5, 5);
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_EQ(*cache.find(3), 30);
+}
+
+// Evicted values are destroyed, which is what frees cached textures
+TEST(LruCacheTest, EvictionReleasesValues) {
+    auto value = std::make_shared<int>(7);
+    LruCache<int, std::shared_ptr<int>> cache(1);
+
+    cache.insert(1, value);
+    EXPECT_EQ(value.use_count(), 2);
+
+    cache.insert(2, std::make_shared<int>(8));
+    EXPECT_EQ(value.use_count(), 1);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.find(2), nullptr);
+}
+
+TEST(LruCacheTest, ZeroCapacityHoldsOne) {
+    LruCache<int, int> cache(0);
+    EXPECT_EQ(cache.maxSize(), 1u);
+    cache.insert(1, 1);
+    cache.insert(2, 2);
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_TRUE(cache.contains(2));
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "../motion_buffer.hpp"
+#include <vector>
+
+namespace {
+
+struct Sample {
+    double x;
+    double y;
+};
+
+} // namespace
+
+// Only the first sample after a flush asks for a frame
+TEST(MotionBufferTest, FirstSampleRequestsFrame) {
+    MotionBuffer<Sample> buffer;
+
+    EXPECT_TRUE(buffer.push({1, 1}));
+    for (int i = 0; i < 100; i++) {
+        EXPECT_FALSE(buffer.push({static_cast<double>(i), 0}));
+    }
+    EXPECT_EQ(buffer.size(), 101u);
+
+    buffer.flush([](const Sample&) {});
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_TRUE(buffer.push({2, 2}));
+}
+
+// Samples are delivered once, in arrival order
+TEST(MotionBufferTest, FlushDeliversInOrder) {
+    MotionBuffer<Sample> buffer;
+    for (int i = 0; i < 10; i++) {
+        buffer.push({static_cast<double>(i), static_cast<double>(-i)});
+    }
+
+    std::vector<double> seen;
+    EXPECT_EQ(buffer.flush([&seen](const Sample& s) { seen.push_back(s.x); }), 10u);
+    ASSERT_EQ(seen.size(), 10u);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(seen[i], i);
+    }
+
+    EXPECT_EQ(buffer.flush([&seen](const Sample& s) { seen.push_back(s.x); }), 0u);
+    EXPECT_EQ(seen.size(), 10u);
+}
+
+// A frame without motion re-arms the frame request
+TEST(MotionBufferTest, EmptyFlushRearms) {
+    MotionBuffer<Sample> buffer;
+    EXPECT_TRUE(buffer.push({0, 0}));
+    buffer.clear();
+    EXPECT_TRUE(buffer.push({0, 0}));
+
+    buffer.flush([](const Sample&) {});
+    EXPECT_EQ(buffer.flush([](const Sample&) {}), 0u);
+    EXPECT_TRUE(buffer.push({0, 0}));
+}
+
+// Samples pushed while flushing wait for the next frame
+TEST(MotionBufferTest, PushDuringFlush) {
+    MotionBuffer<Sample> buffer;
+    buffer.push({1, 0});
+    buffer.push({2, 0});
+
+    bool requested = false;
+    size_t processed = buffer.flush([&](const Sample& s) {
+        if (s.x == 2) {
+            requested = buffer.push({3, 0});
+        }
+    });
+
+    EXPECT_EQ(processed, 2u);
+    EXPECT_TRUE(requested);
+    EXPECT_EQ(buffer.size(), 1u);
+
+    std::vector<double> seen;
+    buffer.flush([&seen](const Sample& s) { seen.push_back(s.x); });
+    EXPECT_EQ(seen, std::vector<double>{3});
+}
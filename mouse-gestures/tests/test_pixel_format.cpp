@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "../../common/pixel_format.hpp"
+#include <random>
+#include <vector>
+
+namespace {
+
+using PixelFormat::Isa;
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (auto& byte : bytes) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+// Every instruction set this CPU has, restoring the detected one afterwards
+class PixelFormatTest : public ::testing::TestWithParam<Isa> {
+  protected:
+    void SetUp() override {
+        if (!PixelFormat::useIsa(GetParam())) {
+            GTEST_SKIP() << PixelFormat::isaName(GetParam()) << " not supported";
+        }
+    }
+
+    void TearDown() override {
+        PixelFormat::useIsa(PixelFormat::detectIsa());
+    }
+};
+
+// Counts around the vector widths and their tails
+const size_t COUNTS[] = {0, 1, 3, 4, 7, 8, 10, 11, 15, 16, 17, 31, 33, 64, 1000};
+
+} // namespace
+
+TEST(PixelFormatScalarTest, MulDiv255IsExact) {
+    for (uint32_t x = 0; x < 256; x++) {
+        for (uint32_t a = 0; a < 256; a++) {
+            const uint32_t expected = (x * a * 2 + 255) / 510;  // round(x * a / 255)
+            ASSERT_EQ(PixelFormat::mulDiv255(x, a), expected) << x << " * " << a;
+        }
+    }
+}
+
+TEST_P(PixelFormatTest, SwapRedBlueMatchesScalar) {
+    for (size_t count : COUNTS) {
+        const auto src = randomBytes(count * 4, static_cast<uint32_t>(count));
+        std::vector<uint8_t> dst(count * 4);
+        PixelFormat::g_kernels.swapRedBlue(src.data(), dst.data(), count);
+
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(dst[i * 4 + 0], src[i * 4 + 2]) << count << " pixel " << i;
+            ASSERT_EQ(dst[i * 4 + 1], src[i * 4 + 1]);
+            ASSERT_EQ(dst[i * 4 + 2], src[i * 4 + 0]);
+            ASSERT_EQ(dst[i * 4 + 3], src[i * 4 + 3]);
+        }
+
+        // In place, and swapping twice gives the original back
+        PixelFormat::g_kernels.swapRedBlue(dst.data(), dst.data(), count);
+        ASSERT_EQ(dst, src) << count;
+    }
+}
+
+TEST_P(PixelFormatTest, ExpandRgbMatchesScalar) {
+    for (size_t count : COUNTS) {
+        const auto src = randomBytes(count * 3, static_cast<uint32_t>(count) + 1);
+        std::vector<uint8_t> dst(count * 4, 0);
+        PixelFormat::g_kernels.expandRgb(src.data(), dst.data(), count);
+
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(dst[i * 4 + 0], src[i * 3 + 0]) << count << " pixel " << i;
+            ASSERT_EQ(dst[i * 4 + 1], src[i * 3 + 1]);
+            ASSERT_EQ(dst[i * 4 + 2], src[i * 3 + 2]);
+            ASSERT_EQ(dst[i * 4 + 3], 255);
+        }
+    }
+}
+
+TEST_P(PixelFormatTest, PremultiplyMatchesScalar) {
+    for (size_t count : COUNTS) {
+        auto pixels = randomBytes(count * 4, static_cast<uint32_t>(count) + 2);
+        auto expected = pixels;
+        PixelFormat::premultiplyScalar(expected.data(), count);
+
+        PixelFormat::g_kernels.premultiply(pixels.data(), count);
+        ASSERT_EQ(pixels, expected) << count;
+    }
+}
+
+TEST_P(PixelFormatTest, ImagesWithStride) {
+    const int width = 13;
+    const int height = 5;
+    const size_t srcStride = width * 3 + 5;  // Padded like gdk-pixbuf rows
+    const size_t dstStride = width * 4 + 12;
+
+    const auto src = randomBytes(srcStride * height, 7);
+    std::vector<uint8_t> dst(dstStride * height, 0xAB);
+    ASSERT_TRUE(PixelFormat::toRGBA(src.data(), srcStride, 3, dst.data(), dstStride, width, height));
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t* s = src.data() + y * srcStride + x * 3;
+            const uint8_t* d = dst.data() + y * dstStride + x * 4;
+            ASSERT_EQ(d[0], s[0]);
+            ASSERT_EQ(d[1], s[1]);
+            ASSERT_EQ(d[2], s[2]);
+            ASSERT_EQ(d[3], 255);
+        }
+        // Row padding is left alone
+        for (size_t i = width * 4; i < dstStride; i++) {
+            ASSERT_EQ(dst[y * dstStride + i], 0xAB);
+        }
+    }
+
+    // BGRA in place keeps the padding too
+    auto rgba = dst;
+    PixelFormat::swapRedBlueInPlace(rgba.data(), dstStride, width, height);
+    EXPECT_EQ(rgba[0], dst[2]);
+    EXPECT_EQ(rgba[2], dst[0]);
+    EXPECT_EQ(rgba[dstStride - 1], 0xAB);
+    PixelFormat::swapRedBlueInPlace(rgba.data(), dstStride, width, height);
+    EXPECT_EQ(rgba, dst);
+}
+
+TEST_P(PixelFormatTest, ToRGBACopiesFourChannels) {
+    const auto src = randomBytes(6 * 4 * 3, 11);
+    std::vector<uint8_t> dst(src.size());
+    ASSERT_TRUE(PixelFormat::toRGBA(src.data(), 6 * 4, 4, dst.data(), 6 * 4, 6, 3));
+    EXPECT_EQ(dst, src);
+
+    EXPECT_FALSE(PixelFormat::toRGBA(src.data(), 6 * 2, 2, dst.data(), 6 * 4, 6, 3));
+}
+
+INSTANTIATE_TEST_SUITE_P(AllIsas, PixelFormatTest,
+                         ::testing::Values(Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::NEON),
+                         [](const auto& info) { return std::string(PixelFormat::isaName(info.param)); });
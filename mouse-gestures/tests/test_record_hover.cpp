@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "../record_hover.hpp"
+
+TEST(RecordHoverMapTest, HitTest) {
+    RecordHoverMap hover;
+    hover.beginFrame();
+    hover.add(0, 10, 10, 100, 100);
+    hover.add(1, 10, 120, 100, 100);
+
+    EXPECT_EQ(hover.hitTest(50, 50), 0);
+    EXPECT_EQ(hover.hitTest(50, 150), 1);
+    EXPECT_EQ(hover.hitTest(50, 115), RecordHoverMap::NONE);
+    EXPECT_EQ(hover.hitTest(500, 50), RecordHoverMap::NONE);
+
+    // Edges are inclusive
+    EXPECT_EQ(hover.hitTest(10, 10), 0);
+    EXPECT_EQ(hover.hitTest(110, 110), 0);
+}
+
+// Moving within the drawn target or over empty space needs no redraw
+TEST(RecordHoverMapTest, OnlyTargetChangesNeedRedraw) {
+    RecordHoverMap hover;
+    hover.beginFrame();
+    hover.add(0, 0, 0, 100, 100);
+    hover.add(1, 0, 200, 100, 100);
+
+    EXPECT_FALSE(hover.hoverChanged(500, 500));
+    EXPECT_TRUE(hover.hoverChanged(50, 50));
+
+    hover.setHovered(0);
+    EXPECT_FALSE(hover.hoverChanged(50, 50));
+    EXPECT_FALSE(hover.hoverChanged(90, 10));
+    EXPECT_TRUE(hover.hoverChanged(50, 250));
+    EXPECT_TRUE(hover.hoverChanged(500, 500));
+}
+
+// A new frame forgets the old layout and hover
+TEST(RecordHoverMapTest, BeginFrameResets) {
+    RecordHoverMap hover;
+    hover.beginFrame();
+    hover.add(3, 0, 0, 10, 10);
+    hover.setHovered(3);
+    hover.setHovered(4);
+    EXPECT_EQ(hover.renderedHover(), 3);
+
+    hover.beginFrame();
+    EXPECT_EQ(hover.renderedHover(), RecordHoverMap::NONE);
+    EXPECT_EQ(hover.hitTest(5, 5), RecordHoverMap::NONE);
+}
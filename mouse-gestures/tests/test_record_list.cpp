@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "../record_list.hpp"
+#include <vector>
+
+namespace {
+
+// The per-gesture loops the record mode UI used before
+std::vector<size_t> visibleByScan(const RecordListLayout& layout, size_t count, float scrollOffset) {
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < count; ++i) {
+        const float yPos = RecordListLayout::PADDING + i * (layout.gestureRectSize +
+                           RecordListLayout::GAP_WIDTH) - scrollOffset;
+        if (yPos + layout.gestureRectSize < 0 || yPos > layout.viewportHeight)
+            continue;
+        rows.push_back(i);
+    }
+    return rows;
+}
+
+int deleteButtonByScan(const RecordListLayout& layout, float x, float y, size_t count,
+                       float scrollOffset) {
+    for (size_t i : visibleByScan(layout, count, scrollOffset)) {
+        const float buttonX = layout.horizontalMargin + layout.gestureRectSize - 36.0f - 4.0f;
+        const float buttonY = layout.rowY(i, scrollOffset) + 4.0f;
+        if (x >= buttonX && x <= buttonX + 36.0f && y >= buttonY && y <= buttonY + 36.0f) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+TEST(RecordListTest, LayoutMatchesOverlay) {
+    const auto layout = RecordListLayout::forMonitor(1920.0f, 1080.0f);
+
+    // Three squares fit the height, the record square the rest
+    const float baseHeight = (1080.0f - 40.0f - 20.0f) / 3.0f;
+    EXPECT_FLOAT_EQ(layout.gestureRectSize, baseHeight * 0.9f);
+    EXPECT_FLOAT_EQ(layout.horizontalMargin, (1920.0f - layout.gestureRectSize - 940.0f) / 3.0f);
+    EXPECT_FLOAT_EQ(layout.rowY(2, 15.0f), 20.0f + 2 * layout.rowPitch() - 15.0f);
+
+    // Record square right of the list, below the header text
+    EXPECT_FLOAT_EQ(layout.recordSquareSize, 940.0f);
+    EXPECT_FLOAT_EQ(layout.recordSquareX(), 2 * layout.horizontalMargin + layout.gestureRectSize);
+    EXPECT_FLOAT_EQ(layout.recordSquareY(), 120.0f);
+    EXPECT_FLOAT_EQ(layout.recordSquareX() + layout.recordSquareSize + layout.horizontalMargin, 1920.0f);
+
+    EXPECT_EQ(layout.maxScrollOffset(3), 0.0f);
+    EXPECT_FLOAT_EQ(layout.maxScrollOffset(10), 10 * layout.rowPitch() - 1040.0f);
+}
+
+TEST(RecordListTest, VisibleRangeMatchesScan) {
+    for (float height : {720.0f, 1080.0f, 1440.0f, 2160.0f}) {
+        const auto layout = RecordListLayout::forMonitor(height * 16.0f / 9.0f, height);
+        for (size_t count : {0u, 1u, 3u, 4u, 50u}) {
+            for (float scroll = -50.0f; scroll <= layout.maxScrollOffset(count) + 50.0f; scroll += 0.75f) {
+                const auto range = layout.visibleRange(count, scroll);
+                std::vector<size_t> rows;
+                for (size_t i = range.begin; i < range.end; i++) {
+                    rows.push_back(i);
+                }
+                ASSERT_EQ(rows, visibleByScan(layout, count, scroll))
+                    << height << "p, " << count << " gestures, scroll " << scroll;
+            }
+        }
+    }
+}
+
+// Scrolled right onto the edges of a square
+TEST(RecordListTest, VisibleRangeAtEdges) {
+    const auto layout = RecordListLayout::forMonitor(1920.0f, 1080.0f);
+    const float pitch = layout.rowPitch();
+
+    for (size_t row = 0; row < 40; row++) {
+        for (float scroll : {row * pitch, row * pitch + 20.0f + layout.gestureRectSize,
+                             row * pitch - 1080.0f + 20.0f, row * pitch + 20.0f}) {
+            const auto range = layout.visibleRange(40, scroll);
+            const auto rows = visibleByScan(layout, 40, scroll);
+            ASSERT_FALSE(rows.empty());
+            EXPECT_EQ(range.begin, rows.front()) << scroll;
+            EXPECT_EQ(range.end, rows.back() + 1) << scroll;
+        }
+    }
+}
+
+// However long the list, only the few rows on screen are drawn
+TEST(RecordListTest, VisibleRangeIndependentOfCount) {
+    const auto layout = RecordListLayout::forMonitor(1920.0f, 1080.0f);
+    const float scroll = 200.0f * layout.rowPitch() + 20.0f;
+
+    const auto range = layout.visibleRange(500, scroll);
+    EXPECT_LE(range.size(), static_cast<size_t>(RecordListLayout::VISIBLE_GESTURES + 2));
+    EXPECT_EQ(range.begin, 200u);
+
+    EXPECT_EQ(layout.visibleRange(150, scroll).size(), 0u);
+}
+
+TEST(RecordListTest, DeleteButtonMatchesScan) {
+    const auto layout = RecordListLayout::forMonitor(2560.0f, 1440.0f);
+    const float buttonX = layout.horizontalMargin + layout.gestureRectSize - 40.0f;
+    const size_t count = 30;
+
+    for (float scroll : {0.0f, 123.5f, 1000.0f, layout.maxScrollOffset(count)}) {
+        for (float y = -10.0f; y <= 1450.0f; y += 0.5f) {
+            for (float x : {buttonX - 1.0f, buttonX, buttonX + 18.0f, buttonX + 36.0f, buttonX + 37.0f}) {
+                ASSERT_EQ(layout.deleteButtonAt(x, y, count, scroll),
+                          deleteButtonByScan(layout, x, y, count, scroll))
+                    << x << "," << y << " scroll " << scroll;
+            }
+        }
+    }
+}
+
+TEST(RecordListTest, DeleteButtonHit) {
+    const auto layout = RecordListLayout::forMonitor(1920.0f, 1080.0f);
+    const float x = layout.horizontalMargin + layout.gestureRectSize - 22.0f;
+    const float scroll = 2.0f * layout.rowPitch();
+
+    EXPECT_EQ(layout.deleteButtonAt(x, layout.rowY(3, scroll) + 10.0f, 500, scroll), 3);
+    EXPECT_EQ(layout.deleteButtonAt(x, layout.rowY(3, scroll) + 60.0f, 500, scroll), -1);
+    EXPECT_EQ(layout.deleteButtonAt(x, layout.rowY(3, scroll) + 10.0f, 3, scroll), -1);
+    EXPECT_EQ(layout.deleteButtonAt(x, 30.0f, 0, 0.0f), -1);
+}
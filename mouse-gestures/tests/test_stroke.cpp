@@ -291,3 +291,264 @@ TEST_F(StrokeTest, DeserializationWithTrailingSemicolon) {
     EXPECT_TRUE(stroke2.isFinished());
     EXPECT_EQ(stroke2.size(), 2);
 }
+
+// Test that a bounded comparison is exact below the bound
+TEST_F(StrokeTest, BoundedCompareMatchesUnbounded) {
+    Stroke stroke1;
+    stroke1.addPoint(100.0, 200.0);
+    stroke1.addPoint(150.0, 250.0);
+    stroke1.addPoint(200.0, 300.0);
+    stroke1.finish();
+
+    Stroke stroke2;
+    stroke2.addPoint(100.0, 200.0);
+    stroke2.addPoint(160.0, 250.0);
+    stroke2.addPoint(200.0, 300.0);
+    stroke2.finish();
+
+    double cost = stroke1.compare(stroke2);
+    EXPECT_DOUBLE_EQ(stroke1.compare(stroke2, cost + 0.01), cost);
+}
+
+// Test that a bounded comparison gives up when the bound cannot be beaten
+TEST_F(StrokeTest, BoundedCompareAbandonsAboveBound) {
+    Stroke stroke1;
+    stroke1.addPoint(0.0, 50.0);
+    stroke1.addPoint(100.0, 50.0);
+    stroke1.finish();
+
+    Stroke stroke2;
+    stroke2.addPoint(50.0, 0.0);
+    stroke2.addPoint(50.0, 100.0);
+    stroke2.finish();
+
+    EXPECT_GE(stroke1.compare(stroke2, 0.05), 0.05);
+    EXPECT_EQ(stroke1.compare(stroke2, 0.0), 0.0);
+}
+
+// Test that a workspace keeps its buffers across comparisons
+TEST_F(StrokeTest, CompareWorkspaceReusesBuffers) {
+    Stroke big;
+    Stroke small;
+    for (int i = 0; i < 40; i++) {
+        big.addPoint(i * 10.0, std::sin(i * 0.3) * 50.0);
+    }
+    for (int i = 0; i < 10; i++) {
+        small.addPoint(i * 10.0, i * 5.0);
+    }
+    big.finish();
+    small.finish();
+
+    StrokeCompareWorkspace workspace;
+    double expected = big.compare(big);
+    EXPECT_DOUBLE_EQ(big.compare(big, STROKE_INFINITY, workspace), expected);
+
+    const size_t capacity = workspace.capacity();
+    EXPECT_GE(capacity, big.size() * big.size());
+
+    // Smaller comparisons must not shrink or reallocate the buffers
+    EXPECT_DOUBLE_EQ(small.compare(big, STROKE_INFINITY, workspace), small.compare(big));
+    EXPECT_EQ(workspace.capacity(), capacity);
+    EXPECT_DOUBLE_EQ(big.compare(big, STROKE_INFINITY, workspace), expected);
+    EXPECT_EQ(workspace.capacity(), capacity);
+}
+
+// Test that backtrace mode records a path back to the origin
+TEST_F(StrokeTest, CompareWorkspaceBacktrace) {
+    Stroke stroke1;
+    Stroke stroke2;
+    for (int i = 0; i < 12; i++) {
+        stroke1.addPoint(i * 10.0, i * i * 1.0);
+        stroke2.addPoint(i * 10.0, i * i * 1.2);
+    }
+    stroke1.finish();
+    stroke2.finish();
+
+    StrokeCompareWorkspace workspace;
+    workspace.backtrace = true;
+    double cost = stroke1.compare(stroke2, STROKE_INFINITY, workspace);
+    ASSERT_LT(cost, STROKE_INFINITY);
+    EXPECT_DOUBLE_EQ(cost, stroke1.compare(stroke2));
+
+    // Follow predecessors from the final cell back to (0, 0)
+    const int N = stroke2.size();
+    int x = stroke1.size() - 1;
+    int y = N - 1;
+    int steps = 0;
+    while ((x != 0 || y != 0) && steps < 100) {
+        int px = workspace.getPrevX()[x * N + y];
+        int py = workspace.getPrevY()[x * N + y];
+        EXPECT_LT(px, x);
+        x = px;
+        y = py;
+        steps++;
+    }
+    EXPECT_EQ(x, 0);
+    EXPECT_EQ(y, 0);
+}
+
+// Test resampling to a fixed number of points during finish
+TEST_F(StrokeTest, FinishResamplesToFixedCount) {
+    // Straight line with uneven spacing, dense at the start
+    Stroke stroke;
+    for (int i = 0; i <= 1000; i++) {
+        double f = i / 1000.0;
+        stroke.addPoint(100.0 * f * f, 50.0 * f * f);
+    }
+    EXPECT_TRUE(stroke.finish(32));
+    ASSERT_EQ(stroke.size(), 32);
+
+    // Points are evenly spaced by arc length
+    const auto& points = stroke.getPoints();
+    for (size_t i = 1; i < points.size(); i++) {
+        EXPECT_NEAR(points[i].t - points[i - 1].t, 1.0 / 31.0, 1e-9);
+    }
+    EXPECT_DOUBLE_EQ(points.back().t, 1.0);
+}
+
+// Test that resampled strokes still match their dense originals
+TEST_F(StrokeTest, ResampledStrokeMatchesOriginal) {
+    Stroke dense;
+    for (int i = 0; i < 2000; i++) {
+        double angle = M_PI * i / 1999.0;
+        dense.addPoint(100.0 * std::cos(angle), 100.0 * std::sin(angle));
+    }
+    Stroke sparse = dense;
+    dense.finish();
+    sparse.finish(48);
+
+    EXPECT_EQ(sparse.size(), 48);
+    EXPECT_LT(sparse.compare(dense), 0.01);
+
+    Stroke resampled = dense.resampled(48);
+    EXPECT_TRUE(resampled.isFinished());
+    EXPECT_EQ(resampled.size(), 48);
+    EXPECT_LT(resampled.compare(sparse), 0.001);
+}
+
+// Test that deserialization can resample templates
+TEST_F(StrokeTest, DeserializeWithResampling) {
+    Stroke stroke = Stroke::deserialize("0.0,0.0;0.5,0.0;1.0,0.0;1.0,0.5;1.0,1.0;", 16);
+    EXPECT_TRUE(stroke.isFinished());
+    EXPECT_EQ(stroke.size(), 16);
+}
+
+// Test that a zero-length stroke is left alone by resampling
+TEST_F(StrokeTest, ResampleDegenerateStroke) {
+    Stroke stroke;
+    stroke.addPoint(10.0, 10.0);
+    stroke.addPoint(10.0, 10.0);
+    stroke.addPoint(10.0, 10.0);
+    stroke.finish(8);
+    EXPECT_EQ(stroke.size(), 3);
+}
+
+// Test feature signature of simple shapes
+TEST_F(StrokeTest, FeatureSignature) {
+    Stroke line;
+    line.addPoint(0.0, 0.0);
+    line.addPoint(100.0, 0.0);
+    line.finish();
+
+    const auto& lineFeatures = line.getFeatures();
+    EXPECT_NEAR(lineFeatures.startDir, 0.0, 1e-9);
+    EXPECT_NEAR(lineFeatures.endDir, 0.0, 1e-9);
+    EXPECT_NEAR(lineFeatures.aspect, 0.0, 1e-9);
+    EXPECT_EQ(lineFeatures.turns, 0);
+
+    float total = 0.0f;
+    for (float bin : lineFeatures.histogram) {
+        total += bin;
+    }
+    EXPECT_NEAR(total, 1.0f, 1e-5);
+
+    Stroke corner;
+    corner.addPoint(0.0, 0.0);
+    corner.addPoint(0.0, 100.0);
+    corner.addPoint(100.0, 100.0);
+    corner.finish();
+
+    const auto& cornerFeatures = corner.getFeatures();
+    EXPECT_NEAR(cornerFeatures.startDir, 0.5, 1e-9);
+    EXPECT_NEAR(cornerFeatures.endDir, 0.0, 1e-9);
+    EXPECT_NEAR(cornerFeatures.aspect, 1.0, 1e-9);
+    EXPECT_EQ(cornerFeatures.turns, 1);
+}
+
+// Test that feature distance separates shapes but not sampling density
+TEST_F(StrokeTest, FeatureDistance) {
+    Stroke sparse;
+    sparse.addPoint(0.0, 0.0);
+    sparse.addPoint(0.0, 100.0);
+    sparse.addPoint(100.0, 100.0);
+    sparse.finish();
+
+    Stroke dense;
+    for (int i = 0; i <= 50; i++) {
+        dense.addPoint(0.0, i * 2.0);
+    }
+    for (int i = 1; i <= 50; i++) {
+        dense.addPoint(i * 2.0, 100.0);
+    }
+    dense.finish();
+
+    Stroke line;
+    line.addPoint(100.0, 0.0);
+    line.addPoint(0.0, 0.0);
+    line.finish();
+
+    const double same = StrokeFeatures::distance(sparse.getFeatures(), dense.getFeatures());
+    const double different = StrokeFeatures::distance(sparse.getFeatures(), line.getFeatures());
+    EXPECT_LT(same, 0.05);
+    EXPECT_GT(different, 0.5);
+    EXPECT_LE(different, 1.0);
+    EXPECT_DOUBLE_EQ(StrokeFeatures::distance(line.getFeatures(), line.getFeatures()), 0.0);
+}
+
+// Cardinal directions sit at histogram bin centres, so a stroke drawn a
+// degree off doesn't move its weight into another bin
+TEST_F(StrokeTest, FeatureDistanceStableUnderSmallTilt) {
+    using Shape = std::vector<std::pair<double, double>>;
+    const std::vector<Shape> shapes = {
+        {{0, 0}, {200, 0}},                          // Right
+        {{0, 0}, {-200, 0}},                         // Left
+        {{0, 0}, {0, 200}},                          // Down
+        {{0, 0}, {0, -200}},                         // Up
+        {{0, 0}, {0, 200}, {200, 200}},              // L
+        {{0, 0}, {0, 200}, {200, 200}, {200, 0}},    // U
+    };
+
+    auto build = [](const Shape& shape, double degrees) {
+        const double angle = degrees * M_PI / 180.0;
+        Stroke stroke;
+        for (size_t i = 0; i + 1 < shape.size(); i++) {
+            for (int step = 0; step < 20; step++) {
+                const double f = step / 20.0;
+                const double x = shape[i].first + (shape[i + 1].first - shape[i].first) * f;
+                const double y = shape[i].second + (shape[i + 1].second - shape[i].second) * f;
+                stroke.addPoint(x * std::cos(angle) - y * std::sin(angle),
+                                x * std::sin(angle) + y * std::cos(angle));
+            }
+        }
+        const auto& last = shape.back();
+        stroke.addPoint(last.first * std::cos(angle) - last.second * std::sin(angle),
+                        last.first * std::sin(angle) + last.second * std::cos(angle));
+        stroke.finish();
+        return stroke;
+    };
+
+    for (const auto& shape : shapes) {
+        const Stroke straight = build(shape, 0.0);
+        for (double tilt : {-1.0, -0.25, 0.25, 1.0}) {
+            const Stroke tilted = build(shape, tilt);
+            EXPECT_LT(StrokeFeatures::distance(straight.getFeatures(), tilted.getFeatures()), 0.02)
+                << shape.size() << " point shape tilted by " << tilt;
+        }
+
+        // Tilted both ways, e.g. +-3px over 200px
+        const Stroke left = build(shape, -0.86);
+        const Stroke right = build(shape, 0.86);
+        EXPECT_LT(StrokeFeatures::distance(left.getFeatures(), right.getFeatures()), 0.02)
+            << shape.size() << " point shape";
+    }
+}
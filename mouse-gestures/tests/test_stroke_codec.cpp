@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "../stroke.hpp"
+#include <cmath>
+#include <string>
+#include <vector>
+
+class StrokeCodecTest : public ::testing::Test {
+protected:
+    static Stroke makeZigzag(int numPoints = 40) {
+        Stroke stroke;
+        for (int i = 0; i < numPoints; i++) {
+            stroke.addPoint(10.0 * i, (i % 10 < 5) ? 3.0 * (i % 5) : 15.0 - 3.0 * (i % 5));
+        }
+        stroke.finish();
+        return stroke;
+    }
+
+    // The parser this codec replaced, kept to check compatibility
+    static std::vector<std::pair<double, double>> parseWithStod(const std::string& data, bool& ok) {
+        std::vector<std::pair<double, double>> out;
+        ok = true;
+        try {
+            size_t pos = 0;
+            while (pos < data.size()) {
+                size_t comma = data.find(',', pos);
+                size_t semi = data.find(';', pos);
+                if (comma == std::string::npos || semi == std::string::npos)
+                    break;
+                if (comma <= pos || semi <= comma)
+                    break;
+                double x = std::stod(data.substr(pos, comma - pos));
+                double y = std::stod(data.substr(comma + 1, semi - comma - 1));
+                out.emplace_back(x, y);
+                pos = semi + 1;
+            }
+        } catch (const std::exception&) {
+            ok = false;
+        }
+        return out;
+    }
+};
+
+// Compact strokes decode to the same shape
+TEST_F(StrokeCodecTest, CompactRoundTrip) {
+    Stroke original = makeZigzag();
+    std::string encoded = original.serializeCompact();
+
+    EXPECT_EQ(encoded.rfind("v1:", 0), 0u);
+    EXPECT_EQ(encoded.find_first_of("+/=#|;, "), std::string::npos);
+
+    Stroke decoded = Stroke::deserialize(encoded);
+    ASSERT_TRUE(decoded.isFinished());
+    ASSERT_EQ(decoded.size(), original.size());
+
+    for (size_t i = 0; i < original.size(); i++) {
+        EXPECT_NEAR(decoded.getPoints()[i].x, original.getPoints()[i].x, 1e-4);
+        EXPECT_NEAR(decoded.getPoints()[i].y, original.getPoints()[i].y, 1e-4);
+    }
+    EXPECT_LT(original.compare(decoded), 1e-6);
+}
+
+// The compact format is a fraction of the legacy size
+TEST_F(StrokeCodecTest, CompactIsSmaller) {
+    Stroke stroke = makeZigzag(200);
+    EXPECT_LT(stroke.serializeCompact().size() * 3, stroke.serialize().size());
+}
+
+// Re-encoding a decoded stroke is stable
+TEST_F(StrokeCodecTest, CompactReencodeIsStable) {
+    Stroke stroke = makeZigzag();
+    std::string encoded = stroke.serializeCompact();
+    EXPECT_EQ(Stroke::deserialize(encoded).serializeCompact(), encoded);
+}
+
+// Each point count leaves a different number of padding bits
+TEST_F(StrokeCodecTest, CompactAnyPointCount) {
+    for (int count = 2; count <= 7; count++) {
+        Stroke stroke = makeZigzag(count);
+        Stroke decoded = Stroke::deserialize(stroke.serializeCompact());
+        ASSERT_TRUE(decoded.isFinished()) << count;
+        EXPECT_EQ(decoded.size(), static_cast<size_t>(count));
+    }
+}
+
+// Malformed compact payloads are rejected
+TEST_F(StrokeCodecTest, CompactRejectsMalformed) {
+    std::string encoded = makeZigzag().serializeCompact();
+
+    EXPECT_FALSE(Stroke::deserialize(encoded + "A").isFinished());
+    EXPECT_FALSE(Stroke::deserialize(encoded.substr(0, encoded.size() - 3)).isFinished());
+    EXPECT_FALSE(Stroke::deserialize("v1:").isFinished());
+
+    std::string corrupted = encoded;
+    corrupted[5] = '*';
+    EXPECT_FALSE(Stroke::deserialize(corrupted).isFinished());
+}
+
+// The legacy parser reads exactly what the stod version did
+TEST_F(StrokeCodecTest, LegacyMatchesStodParser) {
+    const std::vector<std::string> inputs = {
+        "0.5,0.3;0.6,0.4;0.7,0.5;",
+        "0.5,0.3;0.6,0.4;0.7,0.5",        // Last point without ';' is ignored
+        " 0.5, 0.3; +0.6,+0.4;",          // Whitespace and '+' like stod
+        "-0.000000,1e-3;2E2,-5.25;",
+        "0.5abc,0.3;0.6,0.4;",            // Trailing characters ignored
+        "abc,def;ghi,jkl;",
+        "0.5,;0.6,0.4;",
+        "+-1,0;0,0;",
+        "1;2,3;4,5;",
+        ",1;2,3;",
+        "",
+    };
+
+    for (const auto& input : inputs) {
+        bool expectedOk = false;
+        auto expected = parseWithStod(input, expectedOk);
+
+        std::vector<std::pair<double, double>> actual;
+        auto result = StrokeCodec::decodeLegacy(input, [&actual](double x, double y) {
+            actual.emplace_back(x, y);
+            return true;
+        });
+
+        EXPECT_EQ(result == StrokeCodec::LegacyResult::Ok, expectedOk) << input;
+        if (expectedOk) {
+            EXPECT_EQ(actual, expected) << input;
+        }
+    }
+}
+
+// Legacy configs keep loading exactly as before
+TEST_F(StrokeCodecTest, LegacyRoundTrip) {
+    Stroke original = makeZigzag();
+    std::string serialized = original.serialize();
+
+    Stroke decoded = Stroke::deserialize(serialized);
+    ASSERT_TRUE(decoded.isFinished());
+    EXPECT_EQ(decoded.serialize(), serialized);
+}
+
+// Non-finite coordinates make the stroke invalid in both formats
+TEST_F(StrokeCodecTest, RejectsNonFinite) {
+    EXPECT_FALSE(Stroke::deserialize("0.5,inf;0.6,0.4;").isFinished());
+    EXPECT_FALSE(Stroke::deserialize("nan,0.3;0.6,0.4;").isFinished());
+}
+
+// Resampling applies to compact strokes too
+TEST_F(StrokeCodecTest, CompactWithResampling) {
+    Stroke decoded = Stroke::deserialize(makeZigzag().serializeCompact(), 16);
+    ASSERT_TRUE(decoded.isFinished());
+    EXPECT_EQ(decoded.size(), 16u);
+}
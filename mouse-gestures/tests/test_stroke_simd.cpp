@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "../gesture_matcher.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+class StrokeSimdTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        // Restore the load-time kernel for other tests
+        StrokeKernel::useIsa(StrokeKernel::detectIsa());
+    }
+
+    template <typename T>
+    static void randomRun(std::mt19937& rng, int n, std::vector<T>& a,
+                          std::vector<T>& b, std::vector<T>& w) {
+        std::uniform_real_distribution<double> angle(-1.0, 1.0);
+        std::uniform_real_distribution<double> weight(0.0, 0.2);
+        a.resize(n);
+        b.resize(n);
+        w.resize(n);
+        for (int i = 0; i < n; i++) {
+            a[i] = static_cast<T>(angle(rng));
+            b[i] = static_cast<T>(angle(rng));
+            w[i] = static_cast<T>(weight(rng));
+        }
+    }
+
+    static Stroke randomStroke(std::mt19937& rng, int numPoints) {
+        std::uniform_real_distribution<double> turn(-0.6, 0.6);
+        Stroke stroke;
+        double x = 0.0, y = 0.0, heading = turn(rng) * 5.0;
+        for (int i = 0; i < numPoints; i++) {
+            stroke.addPoint(x, y);
+            heading += turn(rng);
+            x += 10.0 * std::cos(heading);
+            y += 10.0 * std::sin(heading);
+        }
+        stroke.finish();
+        return stroke;
+    }
+
+    static const Stroke& identity(const Stroke& stroke) { return stroke; }
+};
+
+// The wrapped angle difference stays within [-1, 1]
+TEST_F(StrokeSimdTest, WrapAngle) {
+    EXPECT_DOUBLE_EQ(StrokeKernel::wrapAngle(1.5), -0.5);
+    EXPECT_DOUBLE_EQ(StrokeKernel::wrapAngle(-1.5), 0.5);
+    EXPECT_DOUBLE_EQ(StrokeKernel::wrapAngle(0.25), 0.25);
+    EXPECT_DOUBLE_EQ(StrokeKernel::wrapAngle(2.0), 0.0);
+    EXPECT_DOUBLE_EQ(StrokeKernel::wrapAngle(-2.0), 0.0);
+}
+
+#ifdef STROKE_SIMD_X86
+// Vector kernels agree with the scalar kernel in double precision
+TEST_F(StrokeSimdTest, DoubleKernelsMatchScalar) {
+    std::mt19937 rng(42);
+    std::vector<double> a, b, w;
+    for (int n : {0, 1, 3, 4, 5, 8, 17, 64, 333}) {
+        randomRun(rng, n, a, b, w);
+        double expected = StrokeKernel::angleCostScalar(a.data(), b.data(), w.data(), n);
+        EXPECT_NEAR(StrokeKernel::angleCostSSE2(a.data(), b.data(), w.data(), n), expected, 1e-12);
+        if (StrokeKernel::isSupported(StrokeKernel::Isa::AVX2)) {
+            EXPECT_NEAR(StrokeKernel::angleCostAVX2(a.data(), b.data(), w.data(), n), expected, 1e-12);
+        }
+    }
+}
+
+// Vector kernels agree with the scalar kernel in single precision
+TEST_F(StrokeSimdTest, FloatKernelsMatchScalar) {
+    std::mt19937 rng(7);
+    std::vector<float> a, b, w;
+    for (int n : {0, 1, 3, 4, 7, 8, 9, 64, 333}) {
+        randomRun(rng, n, a, b, w);
+        double expected = StrokeKernel::angleCostScalar(a.data(), b.data(), w.data(), n);
+        EXPECT_NEAR(StrokeKernel::angleCostSSE2(a.data(), b.data(), w.data(), n), expected, 1e-4);
+        if (StrokeKernel::isSupported(StrokeKernel::Isa::AVX2)) {
+            EXPECT_NEAR(StrokeKernel::angleCostAVX2(a.data(), b.data(), w.data(), n), expected, 1e-4);
+        }
+    }
+}
+#endif
+
+// Every supported kernel produces the same match decisions
+TEST_F(StrokeSimdTest, SameMatchDecisionsAcrossKernels) {
+    std::mt19937 rng(1234);
+    std::vector<Stroke> library;
+    for (int i = 0; i < 40; i++) {
+        library.push_back(randomStroke(rng, 20 + i % 30));
+    }
+    std::vector<Stroke> inputs;
+    for (int i = 0; i < 20; i++) {
+        inputs.push_back(randomStroke(rng, 15 + i * 3));
+    }
+    // Perturbed copies of templates so that some inputs do match
+    for (int i = 0; i < 10; i++) {
+        Stroke noisy;
+        for (const auto& p : library[i * 3].getPoints()) {
+            noisy.addPoint(p.x * 100.0 + (rng() % 3), p.y * 100.0 + (rng() % 3));
+        }
+        noisy.finish();
+        inputs.push_back(noisy);
+    }
+
+    ASSERT_TRUE(StrokeKernel::useIsa(StrokeKernel::Isa::Scalar));
+    std::vector<GestureMatch> expected;
+    for (const auto& input : inputs) {
+        expected.push_back(findBestStrokeMatch(input, library, 0.15, identity));
+    }
+
+    int matched = 0;
+    for (auto isa : {StrokeKernel::Isa::SSE2, StrokeKernel::Isa::AVX2}) {
+        if (!StrokeKernel::useIsa(isa)) {
+            continue;
+        }
+        for (size_t i = 0; i < inputs.size(); i++) {
+            auto match = findBestStrokeMatch(inputs[i], library, 0.15, identity);
+            EXPECT_EQ(match.index, expected[i].index) << StrokeKernel::isaName(isa);
+            EXPECT_NEAR(match.cost, expected[i].cost, 1e-9);
+            if (match.index >= 0) {
+                matched++;
+            }
+        }
+    }
+    if (StrokeKernel::isSupported(StrokeKernel::Isa::SSE2)) {
+        EXPECT_GT(matched, 0);
+    }
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "../trail_batch.hpp"
+#include <chrono>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+struct Vec {
+    double x;
+    double y;
+};
+
+struct TrailPoint {
+    Vec position;
+    Clock::time_point timestamp;
+};
+
+const BatchColor START = {1.0f, 0.0f, 0.0f, 0.5f};
+const BatchColor END = {0.0f, 0.0f, 1.0f, 1.0f};
+
+Vec positionOf(const TrailPoint& point) {
+    return point.position;
+}
+
+} // namespace
+
+TEST(TrailBatchTest, LerpMatchesEndpoints) {
+    const BatchColor mid = lerpBatchColor(START, END, 0.5f);
+    EXPECT_FLOAT_EQ(mid.r, 0.5f);
+    EXPECT_FLOAT_EQ(mid.b, 0.5f);
+    EXPECT_FLOAT_EQ(mid.a, 0.75f);
+
+    const BatchColor atEnd = lerpBatchColor(START, END, 1.0f);
+    EXPECT_FLOAT_EQ(atEnd.r, END.r);
+    EXPECT_FLOAT_EQ(atEnd.b, END.b);
+}
+
+// Expired points are skipped, the rest fade with age along the gradient
+TEST(TrailBatchTest, TrailFadeAndGradient) {
+    const auto now = Clock::now();
+    std::vector<TrailPoint> trail = {
+        {{0, 0}, now - milliseconds(400)},   // Expired
+        {{10, 0}, now - milliseconds(150)},
+        {{20, 0}, now - milliseconds(75)},
+        {{30, 0}, now},
+    };
+
+    std::vector<CircleInstance> out;
+    buildTrailInstances(out, trail, 0, trail.size(), now, 300, 4.0f, START, END, positionOf);
+
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_FLOAT_EQ(out[0].x, 10.0f);
+    EXPECT_FLOAT_EQ(out[0].radius, 4.0f);
+    EXPECT_NEAR(out[0].a, 0.5f, 1e-6);
+    EXPECT_NEAR(out[1].a, 0.75f, 1e-6);
+    EXPECT_NEAR(out[2].a, 1.0f, 1e-6);
+
+    // Gradient position 1/3 for the second of four points
+    EXPECT_NEAR(out[0].r, 1.0f - 1.0f / 3.0f, 1e-6);
+    EXPECT_NEAR(out[2].b, 1.0f, 1e-6);
+}
+
+// Gradient positions include points already dropped from the buffer
+TEST(TrailBatchTest, GradientCountsDroppedPoints) {
+    const auto now = Clock::now();
+    std::vector<TrailPoint> trail = {{{0, 0}, now}, {{1, 0}, now}};
+
+    std::vector<CircleInstance> out;
+    buildTrailInstances(out, trail, 8, 10, now, 300, 1.0f, START, END, positionOf);
+
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_NEAR(out[0].b, 8.0f / 9.0f, 1e-6);
+    EXPECT_NEAR(out[1].b, 1.0f, 1e-6);
+}
+
+TEST(TrailBatchTest, ZeroFadeDrawsNothing) {
+    const auto now = Clock::now();
+    std::vector<TrailPoint> trail = {{{0, 0}, now}};
+
+    std::vector<CircleInstance> out;
+    buildTrailInstances(out, trail, 0, 1, now, 0, 1.0f, START, END, positionOf);
+    EXPECT_TRUE(out.empty());
+}
+
+// Thumbnails map normalized points into the padded square, fully opaque
+TEST(TrailBatchTest, PatternInstances) {
+    std::vector<Vec> points = {{0.0, 0.0}, {0.5, 1.0}, {1.0, 0.5}};
+
+    std::vector<CircleInstance> out;
+    buildPatternInstances(out, points, 100.0f, 200.0f, 120.0f, 10.0f, 3.0f, START, END);
+
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_FLOAT_EQ(out[0].x, 110.0f);
+    EXPECT_FLOAT_EQ(out[0].y, 210.0f);
+    EXPECT_FLOAT_EQ(out[1].x, 160.0f);
+    EXPECT_FLOAT_EQ(out[1].y, 310.0f);
+    EXPECT_FLOAT_EQ(out[2].x, 210.0f);
+
+    for (const auto& circle : out) {
+        EXPECT_FLOAT_EQ(circle.a, 1.0f);
+        EXPECT_FLOAT_EQ(circle.radius, 3.0f);
+    }
+    EXPECT_FLOAT_EQ(out[0].r, 1.0f);
+    EXPECT_FLOAT_EQ(out[2].b, 1.0f);
+}
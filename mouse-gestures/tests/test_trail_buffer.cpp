@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "../trail_buffer.hpp"
+#include <chrono>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+struct TrailPoint {
+    int id = 0;
+    Clock::time_point timestamp;
+};
+
+} // namespace
+
+TEST(TrailBufferTest, PushAndIndex) {
+    TrailBuffer<TrailPoint> trail(8);
+    const auto start = Clock::now();
+    for (int i = 0; i < 5; i++) {
+        trail.push_back({i, start + milliseconds(i)});
+    }
+
+    ASSERT_EQ(trail.size(), 5u);
+    EXPECT_EQ(trail.front().id, 0);
+    EXPECT_EQ(trail.back().id, 4);
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(trail[i].id, i);
+    }
+    EXPECT_EQ(trail.firstIndex(), 0u);
+    EXPECT_EQ(trail.totalPushed(), 5u);
+}
+
+// A full buffer overwrites its oldest points, memory stays at capacity
+TEST(TrailBufferTest, OverwritesOldestWhenFull) {
+    TrailBuffer<TrailPoint> trail(4);
+    const auto start = Clock::now();
+    for (int i = 0; i < 10; i++) {
+        trail.push_back({i, start + milliseconds(i)});
+    }
+
+    ASSERT_EQ(trail.size(), 4u);
+    EXPECT_EQ(trail.capacity(), 4u);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(trail[i].id, 6 + i);
+    }
+    EXPECT_EQ(trail.firstIndex(), 6u);
+    EXPECT_EQ(trail.totalPushed(), 10u);
+}
+
+// Expiry drops exactly the points older than the cutoff
+TEST(TrailBufferTest, ExpireDropsHead) {
+    TrailBuffer<TrailPoint> trail(16);
+    const auto start = Clock::now();
+    for (int i = 0; i < 10; i++) {
+        trail.push_back({i, start + milliseconds(10 * i)});
+    }
+
+    trail.expireBefore(start + milliseconds(35));
+    ASSERT_EQ(trail.size(), 6u);
+    EXPECT_EQ(trail.front().id, 4);
+    EXPECT_EQ(trail.firstIndex(), 4u);
+    EXPECT_EQ(trail.totalPushed(), 10u);
+
+    // Wrapping around after expiry keeps the order
+    for (int i = 10; i < 20; i++) {
+        trail.push_back({i, start + milliseconds(10 * i)});
+    }
+    ASSERT_EQ(trail.size(), 16u);
+    for (size_t i = 0; i < trail.size(); i++) {
+        EXPECT_EQ(trail[i].id, static_cast<int>(4 + i));
+    }
+
+    trail.expireBefore(start + milliseconds(1000));
+    EXPECT_TRUE(trail.empty());
+    EXPECT_EQ(trail.totalPushed(), 20u);
+}
+
+TEST(TrailBufferTest, ClearResetsCounters) {
+    TrailBuffer<TrailPoint> trail(2);
+    const auto start = Clock::now();
+    for (int i = 0; i < 5; i++) {
+        trail.push_back({i, start});
+    }
+
+    trail.clear();
+    EXPECT_TRUE(trail.empty());
+    EXPECT_EQ(trail.firstIndex(), 0u);
+    EXPECT_EQ(trail.totalPushed(), 0u);
+
+    trail.push_back({7, start});
+    EXPECT_EQ(trail.front().id, 7);
+    EXPECT_EQ(trail.back().id, 7);
+}
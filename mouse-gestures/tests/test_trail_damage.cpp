@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "../trail_damage.hpp"
+#include <vector>
+
+namespace {
+
+struct Pos {
+    double x;
+    double y;
+};
+
+Pos identity(const Pos& p) {
+    return p;
+}
+
+bool contains(const DamageRect& rect, double x, double y) {
+    return rect.valid && x >= rect.x1 && x <= rect.x2 && y >= rect.y1 && y <= rect.y2;
+}
+
+std::vector<DamageRect> collectDamage(const TrailDamage& damage) {
+    std::vector<DamageRect> rects;
+    damage.forEachDamage([&rects](const DamageRect& rect) { rects.push_back(rect); });
+    return rects;
+}
+
+} // namespace
+
+TEST(DamageRectTest, IncludeAndMerge) {
+    DamageRect rect;
+    EXPECT_FALSE(rect.valid);
+    EXPECT_EQ(rect.width(), 0.0);
+
+    rect.include(10, 20, 5);
+    EXPECT_TRUE(rect.valid);
+    EXPECT_DOUBLE_EQ(rect.x1, 5);
+    EXPECT_DOUBLE_EQ(rect.y2, 25);
+
+    rect.include(30, 0, 5);
+    EXPECT_DOUBLE_EQ(rect.width(), 30);
+    EXPECT_DOUBLE_EQ(rect.height(), 30);
+
+    DamageRect other;
+    other.include(100, 100, 1);
+    rect.merge(other);
+    EXPECT_DOUBLE_EQ(rect.x2, 101);
+
+    // Merging an empty rect changes nothing
+    rect.merge(DamageRect{});
+    EXPECT_DOUBLE_EQ(rect.x2, 101);
+}
+
+// Every trail circle is covered by one of the current rects
+TEST(TrailDamageTest, CoversEveryPoint) {
+    std::vector<Pos> trail;
+    for (int i = 0; i < 200; i++) {
+        trail.push_back({i * 10.0, i * 5.0});
+    }
+
+    TrailDamage damage;
+    damage.update(trail, 4.0, identity);
+
+    const auto& rects = damage.currentRects();
+    EXPECT_EQ(rects.size(), (trail.size() + TrailDamage::POINTS_PER_RECT - 1) /
+                                TrailDamage::POINTS_PER_RECT);
+
+    for (const auto& p : trail) {
+        bool covered = false;
+        for (const auto& rect : rects) {
+            covered = covered || (contains(rect, p.x - 4, p.y - 4) && contains(rect, p.x + 4, p.y + 4));
+        }
+        EXPECT_TRUE(covered) << p.x << "," << p.y;
+    }
+
+    const DamageRect& bounds = damage.currentBounds();
+    EXPECT_DOUBLE_EQ(bounds.x1, -4);
+    EXPECT_DOUBLE_EQ(bounds.x2, 1994);
+}
+
+// A diagonal stroke is covered by far less area than its bounding box
+TEST(TrailDamageTest, DiagonalStaysTight) {
+    std::vector<Pos> trail;
+    for (int i = 0; i < 1024; i++) {
+        trail.push_back({i * 3.0, i * 2.0});
+    }
+
+    TrailDamage damage;
+    damage.update(trail, 8.0, identity);
+
+    double area = 0.0;
+    for (const auto& rect : damage.currentRects()) {
+        area += rect.width() * rect.height();
+    }
+    const DamageRect& bounds = damage.currentBounds();
+    EXPECT_LT(area, bounds.width() * bounds.height() * 0.1);
+}
+
+// The area of the previous update is damaged once more, then dropped
+TEST(TrailDamageTest, VacatedAreaIsDamagedOnce) {
+    TrailDamage damage;
+    std::vector<Pos> trail = {{0, 0}, {10, 0}};
+    damage.update(trail, 2.0, identity);
+    EXPECT_EQ(collectDamage(damage).size(), 1u);
+
+    // Trail cleared: the old area still needs a repaint
+    trail.clear();
+    damage.update(trail, 2.0, identity);
+    auto rects = collectDamage(damage);
+    ASSERT_EQ(rects.size(), 1u);
+    EXPECT_TRUE(contains(rects[0], 10, 0));
+    EXPECT_FALSE(damage.currentBounds().valid);
+    EXPECT_TRUE(damage.hasDamage());
+
+    // Nothing left after that
+    damage.update(trail, 2.0, identity);
+    EXPECT_TRUE(collectDamage(damage).empty());
+    EXPECT_FALSE(damage.hasDamage());
+}
+
+// Extra rects count towards damage and bounds
+TEST(TrailDamageTest, AddRect) {
+    TrailDamage damage;
+    std::vector<Pos> trail = {{0, 0}};
+    damage.update(trail, 1.0, identity);
+
+    DamageRect preview;
+    preview.include(500, 500, 100);
+    damage.addRect(preview);
+
+    EXPECT_EQ(damage.currentRects().size(), 2u);
+    EXPECT_DOUBLE_EQ(damage.currentBounds().x2, 600);
+
+    damage.clear();
+    EXPECT_FALSE(damage.hasDamage());
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+// Instance data for drawing trails and gesture thumbnails as batches of
+// antialiased circles. Building the instances is independent of GL so the
+// gradient and fade math can be tested on its own; TrailBatchRenderer
+// submits them in one instanced draw.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct BatchColor {
+    float r = 0.0f;
+    float g = 0.0f;
+    float b = 0.0f;
+    float a = 0.0f;
+};
+
+// One circle; layout matches the instance attributes of the batch shader
+struct CircleInstance {
+    float x;
+    float y;
+    float radius;
+    float r;
+    float g;
+    float b;
+    float a;
+};
+
+static_assert(sizeof(CircleInstance) == 7 * sizeof(float));
+
+// Linear blend between the gradient start and end colors
+inline BatchColor lerpBatchColor(const BatchColor& start, const BatchColor& end, float t) {
+    return {start.r + (end.r - start.r) * t,
+            start.g + (end.g - start.g) * t,
+            start.b + (end.b - start.b) * t,
+            start.a + (end.a - start.a) * t};
+}
+
+// Append the visible points of a fading trail (indexable, oldest first).
+// The gradient runs over all `totalPoints` pushed since the press, of
+// which the first held point is number `firstIndex`; alpha fades with
+// age. `position(point)` returns the circle center in render coordinates.
+template <typename Trail, typename Position>
+void buildTrailInstances(std::vector<CircleInstance>& out, const Trail& trail,
+                         uint64_t firstIndex, uint64_t totalPoints,
+                         std::chrono::steady_clock::time_point now, int fadeDurationMs,
+                         float radius, const BatchColor& start, const BatchColor& end,
+                         Position&& position) {
+    if (fadeDurationMs <= 0) {
+        return;
+    }
+
+    const size_t numPoints = trail.size();
+
+    // Points are ordered by time: skip the expired head, the rest is visible
+    size_t first = 0;
+    while (first < numPoints &&
+           std::chrono::duration_cast<std::chrono::milliseconds>(
+               now - trail[first].timestamp).count() > fadeDurationMs)
+        ++first;
+
+    out.reserve(out.size() + (numPoints - first));
+    for (size_t i = first; i < numPoints; ++i) {
+        const auto& point = trail[i];
+        const auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - point.timestamp).count();
+
+        // Position along the path, 0.0 at start and 1.0 at end
+        const float pathPosition = (totalPoints > 1) ?
+            static_cast<float>(firstIndex + i) / static_cast<float>(totalPoints - 1) : 0.0f;
+
+        const BatchColor color = lerpBatchColor(start, end, pathPosition);
+        const float alpha = 1.0f - (static_cast<float>(age) / fadeDurationMs);
+
+        const auto center = position(point);
+        out.push_back({static_cast<float>(center.x), static_cast<float>(center.y), radius,
+                       color.r, color.g, color.b, alpha});
+    }
+}
+
+// Append the points of a normalized gesture pattern drawn into the square
+// at (x, y) of `size`, inset by `padding`. Thumbnails are fully opaque.
+template <typename Points>
+void buildPatternInstances(std::vector<CircleInstance>& out, const Points& points,
+                           float x, float y, float size, float padding, float radius,
+                           const BatchColor& start, const BatchColor& end) {
+    const float drawWidth = size - 2 * padding;
+    const float drawHeight = size - 2 * padding;
+    const size_t numPoints = points.size();
+
+    out.reserve(out.size() + numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        const auto& point = points[i];
+        const float px = x + padding + static_cast<float>(point.x) * drawWidth;
+        const float py = y + padding + static_cast<float>(point.y) * drawHeight;
+
+        const float pathPosition = (numPoints > 1) ?
+            static_cast<float>(i) / static_cast<float>(numPoints - 1) : 0.0f;
+
+        const BatchColor color = lerpBatchColor(start, end, pathPosition);
+        out.push_back({px, py, radius, color.r, color.g, color.b, 1.0f});
+    }
+}
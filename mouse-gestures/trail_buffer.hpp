@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fixed-capacity ring buffer of timestamped trail points.
+//
+// Points are appended in timestamp order, so expired points are always at
+// the head and are dropped in O(1) each, and whether anything is still
+// visible only depends on the newest point. When full, the oldest point is
+// overwritten; memory is allocated once and stays flat.
+//
+// Indices count from the oldest point still held. firstIndex() is the
+// position of that point among everything pushed since the last clear(),
+// so the trail gradient doesn't shift as the tail expires.
+template <typename T>
+class TrailBuffer {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // 4 seconds of trail at 1000 Hz
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    explicit TrailBuffer(size_t capacity = DEFAULT_CAPACITY)
+        : storage(std::make_unique<T[]>(capacity ? capacity : 1)), cap(capacity ? capacity : 1) {}
+
+    TrailBuffer(const TrailBuffer&) = delete;
+    TrailBuffer& operator=(const TrailBuffer&) = delete;
+
+    void push_back(const T& point) {
+        if (count == cap) {
+            // Full: the oldest point gives way
+            head = (head + 1) % cap;
+            count--;
+            dropped++;
+        }
+        storage[(head + count) % cap] = point;
+        count++;
+    }
+
+    // Drop points with a timestamp before `cutoff`
+    void expireBefore(Clock::time_point cutoff) {
+        while (count > 0 && storage[head].timestamp < cutoff) {
+            head = (head + 1) % cap;
+            count--;
+            dropped++;
+        }
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+        dropped = 0;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    size_t capacity() const {
+        return cap;
+    }
+
+    // Position of front() among all points pushed since clear()
+    uint64_t firstIndex() const {
+        return dropped;
+    }
+
+    // Number of points pushed since clear(), including dropped ones
+    uint64_t totalPushed() const {
+        return dropped + count;
+    }
+
+    const T& operator[](size_t i) const {
+        return storage[(head + i) % cap];
+    }
+
+    const T& front() const {
+        return storage[head];
+    }
+
+    const T& back() const {
+        return storage[(head + count - 1) % cap];
+    }
+
+  private:
+    std::unique_ptr<T[]> storage;
+    size_t cap;
+    size_t head = 0;
+    size_t count = 0;
+    uint64_t dropped = 0;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Axis-aligned rectangle in global layout coordinates
+struct DamageRect {
+    double x1 = 0.0;
+    double y1 = 0.0;
+    double x2 = 0.0;
+    double y2 = 0.0;
+    bool valid = false;
+
+    // Grow to contain a circle of `radius` around (x, y)
+    void include(double x, double y, double radius) {
+        if (!valid) {
+            *this = {x - radius, y - radius, x + radius, y + radius, true};
+            return;
+        }
+        x1 = std::min(x1, x - radius);
+        y1 = std::min(y1, y - radius);
+        x2 = std::max(x2, x + radius);
+        y2 = std::max(y2, y + radius);
+    }
+
+    void merge(const DamageRect& other) {
+        if (!other.valid) {
+            return;
+        }
+        if (!valid) {
+            *this = other;
+            return;
+        }
+        x1 = std::min(x1, other.x1);
+        y1 = std::min(y1, other.y1);
+        x2 = std::max(x2, other.x2);
+        y2 = std::max(y2, other.y2);
+    }
+
+    double width() const {
+        return valid ? x2 - x1 : 0.0;
+    }
+
+    double height() const {
+        return valid ? y2 - y1 : 0.0;
+    }
+};
+
+// Screen area covered by the gesture trail, for damage tracking.
+//
+// The trail is covered by one rectangle per run of consecutive points.
+// Consecutive points are close together, so this stays tight for
+// diagonal or curved strokes where a single bounding box would span whole
+// monitors. The rectangles of the previous update are kept, so the area
+// vacated by expired or cleared points is repainted once more.
+class TrailDamage {
+  public:
+    static constexpr size_t POINTS_PER_RECT = 32;
+
+    // Recompute the covered area from `trail` (indexable, oldest first),
+    // `position(point)` returning something with x and y
+    template <typename Trail, typename Position>
+    void update(const Trail& trail, double radius, Position&& position) {
+        previous.swap(current);
+        current.clear();
+        bounds = DamageRect{};
+
+        DamageRect rect;
+        for (size_t i = 0; i < trail.size(); i++) {
+            const auto pos = position(trail[i]);
+            rect.include(pos.x, pos.y, radius);
+            if ((i + 1) % POINTS_PER_RECT == 0) {
+                add(rect);
+                rect = DamageRect{};
+            }
+        }
+        add(rect);
+    }
+
+    // Extra area drawn along with the trail, e.g. the live prediction
+    void addRect(const DamageRect& rect) {
+        add(rect);
+    }
+
+    // Rectangles to repaint on the next frame: what is covered now and
+    // what was covered at the previous update
+    template <typename OnRect>
+    void forEachDamage(OnRect&& onRect) const {
+        for (const auto& rect : previous) {
+            onRect(rect);
+        }
+        for (const auto& rect : current) {
+            onRect(rect);
+        }
+    }
+
+    bool hasDamage() const {
+        return !previous.empty() || !current.empty();
+    }
+
+    // Bounding box of everything covered now
+    const DamageRect& currentBounds() const {
+        return bounds;
+    }
+
+    const std::vector<DamageRect>& currentRects() const {
+        return current;
+    }
+
+    void clear() {
+        previous.clear();
+        current.clear();
+        bounds = DamageRect{};
+    }
+
+  private:
+    std::vector<DamageRect> current;
+    std::vector<DamageRect> previous;
+    DamageRect bounds;
+
+    void add(const DamageRect& rect) {
+        if (!rect.valid) {
+            return;
+        }
+        current.push_back(rect);
+        bounds.merge(rect);
+    }
+};
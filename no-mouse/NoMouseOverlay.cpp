@@ -15,6 +15,7 @@ using Render::GL::g_pHyprOpenGL;
 #include <pango/pangocairo.h>
 #include <fstream>
 #include <unordered_map>
+#include "../common/pixel_format.hpp"
 
 // Debug logging
 static void debugLog(const std::string& msg) {
@@ -29,30 +30,19 @@ static std::unordered_map<std::string, SP<Render::ITexture>> g_labelTextureCache
 
 CNoMouseOverlay::CNoMouseOverlay(PHLMONITOR monitor) : m_pMonitor(monitor) {}
 
-// Helper function to create a texture from Cairo surface
+// Helper function to create a texture from Cairo surface. The surface is
+// converted from Cairo's BGRA to RGBA in place and uploaded from there.
 static SP<Render::ITexture> createTextureFromCairoSurface(cairo_surface_t* surface, int width, int height) {
+    cairo_surface_flush(surface);
     const auto DATA = cairo_image_surface_get_data(surface);
     const auto STRIDE = cairo_image_surface_get_stride(surface);
 
-    std::vector<uint8_t> pixelData(width * height * 4);
-
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            const auto SRC = DATA + y * STRIDE + x * 4;
-            auto dst = pixelData.data() + (y * width + x) * 4;
-
-            // Cairo uses BGRA, convert to RGBA
-            dst[0] = SRC[2]; // R
-            dst[1] = SRC[1]; // G
-            dst[2] = SRC[0]; // B
-            dst[3] = SRC[3]; // A
-        }
-    }
+    PixelFormat::swapRedBlueInPlace(DATA, STRIDE, width, height);
+    cairo_surface_mark_dirty(surface);
 
     const uint32_t drmFormat = DRM_FORMAT_ABGR8888;
-    const uint32_t textureStride = width * 4;
 
-    return makeShared<Render::GL::CGLTexture>(drmFormat, pixelData.data(), textureStride,
+    return makeShared<Render::GL::CGLTexture>(drmFormat, DATA, STRIDE,
                                               Vector2D{(double)width, (double)height}, true);
 }
 
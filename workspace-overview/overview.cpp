@@ -25,6 +25,7 @@
 #undef private
 #undef protected
 #include "OverviewPassElement.hpp"
+#include "../common/pixel_format.hpp"
 
 using Render::GL::g_pHyprOpenGL;
 
@@ -2480,29 +2481,9 @@ void COverview::moveWindowToWorkspace(PHLWINDOW window, int targetWorkspaceIndex
 
 std::vector<uint8_t> convertPixelDataToRGBA(const guchar* pixels, int width, int height,
                                              int channels, int stride) {
-    std::vector<uint8_t> pixelData(width * height * 4);
-
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            const guchar* src = pixels + y * stride + x * channels;
-            uint8_t* dst = pixelData.data() + (y * width + x) * 4;
-
-            if (channels == 4) {
-                // RGBA format
-                dst[0] = src[0];  // R
-                dst[1] = src[1];  // G
-                dst[2] = src[2];  // B
-                dst[3] = src[3];  // A
-            } else if (channels == 3) {
-                // RGB format - add alpha channel
-                dst[0] = src[0];  // R
-                dst[1] = src[1];  // G
-                dst[2] = src[2];  // B
-                dst[3] = 255;     // A (fully opaque)
-            }
-        }
-    }
-
+    std::vector<uint8_t> pixelData(static_cast<size_t>(width) * height * 4);
+    PixelFormat::toRGBA(pixels, stride, channels, pixelData.data(), static_cast<size_t>(width) * 4,
+                        width, height);
     return pixelData;
 }
 